@@ -0,0 +1,122 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "bench/bench_odes.hpp"
+#include "bench/benchmark.hpp"
+#include "include/sam/analysis/adjoint.hpp"
+#include "include/sam/analysis/continuation.hpp"
+#include "include/sam/analysis/henon.hpp"
+#include "include/sam/analysis/isochrons.hpp"
+#include "include/sam/analysis/period.hpp"
+#include "include/sam/analysis/phase.hpp"
+#include "include/sam/analysis/savitzky_golay.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+int main(int argc, char** argv) {
+  typedef sam::RK4System<bench::StuartLandauODE> system_type;
+  bench::Suite suite("analysis", bench::ParseOptions(argc, argv, 10));
+  const double omega = 1.;
+  const double period = 2.*M_PI/omega;
+  const double dt = 0.01;
+  auto upper_half = [](const std::vector<double>& x) { return x[1] > 0; };
+
+  // the limit cycle just behind the crossing of y = 0
+  system_type system(1, 2, omega);
+  system.SetPosition({std::cos(0.005), std::sin(0.005)});
+  sam::CrossingParameters crossing;
+  crossing.dimension = 1;
+  suite.Run("HenonTrick", [&]() {
+      std::pair<double, std::vector<double>> result = sam::HenonTrick(
+          system, crossing);
+      bench::DoNotOptimize(result);
+    });
+
+  sam::PeriodParameters period_parameters;
+  period_parameters.dimension = 1;
+  suite.Run("CalculatePeriod dt=0.01", [&]() {
+      system_type copy = system;
+      double T = sam::CalculatePeriod(copy, dt, upper_half,
+                                      period_parameters);
+      bench::DoNotOptimize(T);
+    });
+
+  sam::PeriodEstimateParameters estimate_parameters;
+  estimate_parameters.dimension = 1;
+  suite.Run("EstimatePeriod dt=0.01", [&]() {
+      system_type copy = system;
+      sam::PeriodEstimate estimate = sam::EstimatePeriod(
+          copy, dt, upper_half, estimate_parameters);
+      bench::DoNotOptimize(estimate);
+    });
+
+  sam::PhaseParameters phase_parameters;
+  phase_parameters.dimension = 1;
+  for (double radius : {1., 0.5}) {
+    std::vector<double> position({radius*std::cos(1.), radius*std::sin(1.)});
+    suite.Run("FindPhase r=" + std::to_string(radius).substr(0, 3), [&]() {
+        double phase = sam::FindPhase(position, period, system, upper_half,
+                                      phase_parameters);
+        bench::DoNotOptimize(phase);
+      });
+  }
+
+  // the whole iPRC of the limit cycle
+  system_type on_cycle(1, 2, omega);
+  on_cycle.SetPosition({1., 0.});
+  sam::AdjointParameters adjoint_parameters;
+  suite.Run("CalculateAdjoint 1000 steps", [&]() {
+      sam::AdjointSolution<std::vector<double>> solution =
+          sam::CalculateAdjoint(on_cycle, period, adjoint_parameters);
+      bench::DoNotOptimize(solution);
+    }, adjoint_parameters.steps_per_period);
+
+  // isochrons on a 32x32 grid around the limit cycle
+  sam::IsochronGrid<std::vector<double>> grid({0., 0.}, {0, 1}, {-1.5, -1.5},
+                                              {1.5, 1.5}, {32, 32});
+  std::vector<std::vector<double>> points(grid.size());
+  for (size_t i = 0; i < grid.size(); ++i) grid.GetPoint(i, points[i]);
+  sam::ThreadPool pool(1);
+  suite.Run("FindPhases 32x32 1 thread", [&]() {
+      std::vector<double> phases = sam::FindPhases(points, period, system,
+                                                   upper_half,
+                                                   phase_parameters, pool);
+      bench::DoNotOptimize(phases);
+    }, grid.size());
+  suite.Run("CalculateIsochrons 32x32 1 thread", [&]() {
+      std::vector<double> phases = sam::CalculateIsochrons(
+          grid, period, system, upper_half, phase_parameters, pool);
+      bench::DoNotOptimize(phases);
+    }, grid.size());
+
+  // a period curve of 16 frequencies, warm-started on one thread
+  std::vector<double> frequencies;
+  for (unsigned int k = 0; k < 16; ++k) frequencies.push_back(1. + 0.05*k);
+  auto set_frequency = [](system_type& system, double omega) {
+    system.SetParameters(omega);
+  };
+  sam::ContinuationParameters continuation_parameters;
+  continuation_parameters.dimension = 1;
+  suite.Run("ContinuePeriod 16 points 1 thread", [&]() {
+      auto points = sam::ContinuePeriod(system, frequencies, set_frequency,
+                                        dt, upper_half,
+                                        continuation_parameters, pool);
+      bench::DoNotOptimize(points);
+    }, frequencies.size());
+
+  const size_t number_points = 100000;
+  std::vector<double> signal(number_points);
+  for (size_t i = 0; i < number_points; ++i) {
+    signal[i] = std::sin(dt*static_cast<double>(i));
+  }
+  for (unsigned int window : {5, 21}) {
+    suite.Run("SavitzkyGolayFilter window=" + std::to_string(window), [&]() {
+        std::vector<std::vector<double>> filtered = sam::SavitzkyGolayFilter(
+            dt, signal, window, 3);
+        bench::DoNotOptimize(filtered);
+      }, number_points);
+  }
+  return suite.Finish();
+}
@@ -0,0 +1,58 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench/benchmark.hpp"
+#include "include/sam/helper/coordinate_helper.hpp"
+#include "include/sam/helper/fast_math.hpp"
+
+int main(int argc, char** argv) {
+  const size_t N = 1000000;
+  bench::Suite suite("fast_math", bench::ParseOptions(argc, argv));
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(0., 2.*M_PI);
+  std::vector<double> phases(N);
+  for (auto& phase : phases) phase = distribution(generator);
+  std::vector<double> sin(N), cos(N), cartesian(2*N), polar(2*N);
+  for (size_t i = 0; i < N; ++i) {
+    cartesian[2*i] = std::cos(phases[i]);
+    cartesian[2*i + 1] = std::sin(phases[i]);
+  }
+
+  struct Level {
+    const char* name;
+    sam::MathAccuracy accuracy;
+  };
+  const Level levels[] = {{"standard", sam::MathAccuracy::kStandard},
+                          {"high", sam::MathAccuracy::kHigh},
+                          {"low", sam::MathAccuracy::kLow}};
+
+  std::cout << "1e6 phases, min and median" << std::endl;
+  for (const Level& level : levels) {
+    suite.Run(std::string("SinCos ") + level.name, [&]() {
+        sam::SinCos(phases.data(), sin.data(), cos.data(), N,
+                    level.accuracy);
+        bench::DoNotOptimize(sin);
+        bench::DoNotOptimize(cos);
+      }, N);
+  }
+  for (const Level& level : levels) {
+    suite.Run(std::string("OrderParameter ") + level.name, [&]() {
+        std::complex<double> order = sam::OrderParameter(
+            phases.begin(), phases.end(), level.accuracy);
+        bench::DoNotOptimize(order);
+      }, N);
+  }
+  for (const Level& level : levels) {
+    suite.Run(std::string("CartesianToPolar ") + level.name, [&]() {
+        sam::CartesianToPolar(cartesian.data(), polar.data(), N,
+                              level.accuracy);
+        bench::DoNotOptimize(polar);
+      }, N);
+  }
+  return suite.Finish();
+}
@@ -0,0 +1,81 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef BENCH_BENCH_ODES_HPP_
+#define BENCH_BENCH_ODES_HPP_
+
+#include <cstddef>
+
+namespace bench {
+
+/*!
+ * \brief Linear oscillators of any dimension d, every coordinate is driven by
+ * the next one of the same oscillator,
+ * \f[ \dot{x}_{i,k} = -\gamma x_{i,k} + \omega x_{i,(k+1) \bmod d}. \f]
+ */
+class CyclicODE {
+ public:
+  CyclicODE(unsigned int dimension, double omega, double damping)
+      : dimension_(dimension), omega_(omega), damping_(damping) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    const size_t d = dimension_;
+    for (size_t i = 0; i < static_cast<size_t>(x.size()); i += d) {
+      for (size_t k = 0; k < d; ++k) {
+        dx[i + k] = -damping_*x[i + k] + omega_*x[i + (k + 1)%d];
+      }
+    }
+  }
+
+ private:
+  unsigned int dimension_;
+  double omega_;
+  double damping_;
+};
+
+/*!
+ * \brief Stuart-Landau oscillator with a stable limit cycle of radius 1 and
+ * period 2 pi/omega.
+ */
+class StuartLandauODE {
+ public:
+  explicit StuartLandauODE(double omega) : omega_(omega) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    const double R2 = x[0]*x[0] + x[1]*x[1];
+    dx[0] = (1. - R2)*x[0] - omega_*x[1];
+    dx[1] = (1. - R2)*x[1] + omega_*x[0];
+  }
+
+ private:
+  double omega_;
+};
+
+/*!
+ * \brief Stuart-Landau oscillator with a variable radius sqrt(mu) of the limit
+ * cycle, the parameters can be packs for BatchRK4System.
+ */
+template<typename value_type>
+class EnsembleStuartLandauODE {
+ public:
+  EnsembleStuartLandauODE(value_type mu, value_type omega)
+      : mu_(mu), omega_(omega) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    for (size_t i = 0; i < static_cast<size_t>(x.size()); i += 2) {
+      const auto R2 = x[i]*x[i] + x[i + 1]*x[i + 1];
+      dx[i] = (mu_ - R2)*x[i] - omega_*x[i + 1];
+      dx[i + 1] = (mu_ - R2)*x[i + 1] + omega_*x[i];
+    }
+  }
+
+ private:
+  value_type mu_;
+  value_type omega_;
+};
+
+}  // namespace bench
+
+#endif  // BENCH_BENCH_ODES_HPP_
@@ -0,0 +1,167 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "bench/bench_odes.hpp"
+#include "bench/benchmark.hpp"
+#include "include/sam/helper/ragged_array.hpp"
+#include "include/sam/system/batch_rk4_system.hpp"
+#include "include/sam/system/euler_system.hpp"
+#include "include/sam/system/kuramoto_ode.hpp"
+#include "include/sam/system/rk4_network.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+namespace {
+
+// Every call integrates about this many coordinates times steps.
+const double kWork = 1e6;
+
+std::vector<double> InitialState(size_t size) {
+  std::vector<double> x(size);
+  for (size_t i = 0; i < size; ++i) {
+    x[i] = std::sin(0.37*static_cast<double>(i));
+  }
+  return x;
+}
+
+template<typename system_type>
+void BenchmarkSteps(bench::Suite& suite, const std::string& name,
+                    unsigned int N, unsigned int d) {
+  system_type system(N, d, d, 1., 0.1);
+  system.SetPosition(InitialState(N*d));
+  const unsigned int steps = std::max(1., kWork/(N*d));
+  suite.Run(name + " N=" + std::to_string(N) + " d=" + std::to_string(d),
+            [&]() {
+      system.Integrate(0.01, steps);
+      bench::DoNotOptimize(system);
+    }, steps);
+}
+
+// An ensemble of Stuart-Landau oscillators, that differ in mu and omega,
+// once as separate RK4Systems and once in SIMD batches.
+void BenchmarkEnsemble(bench::Suite& suite, unsigned int members) {
+  typedef sam::NativePack<double> pack_type;
+  const unsigned int steps = 1000;
+  std::vector<std::tuple<double, double>> parameters;
+  for (unsigned int i = 0; i < members; ++i) {
+    parameters.push_back(std::make_tuple(0.5 + 0.001*i, 1. + 0.002*i));
+  }
+  const std::string suffix = " members=" + std::to_string(members);
+
+  std::vector<sam::RK4System<bench::EnsembleStuartLandauODE<double>>>
+      systems;
+  for (const std::tuple<double, double>& p : parameters) {
+    systems.emplace_back(1, 2, std::get<0>(p), std::get<1>(p));
+    systems.back().SetPosition({0.1, 0.});
+  }
+  suite.Run("RK4System ensemble" + suffix, [&]() {
+      for (auto& system : systems) {
+        system.Integrate(0.01, steps);
+      }
+      bench::DoNotOptimize(systems);
+    }, static_cast<double>(steps)*members);
+
+  sam::BatchRK4System<bench::EnsembleStuartLandauODE<pack_type>, pack_type>
+      batch(1, 2, parameters);
+  batch.SetPosition({0.1, 0.});
+  suite.Run("BatchRK4System " + std::to_string(pack_type::size())
+            + " lanes" + suffix, [&]() {
+      batch.Integrate(0.01, steps);
+      bench::DoNotOptimize(batch);
+    }, static_cast<double>(steps)*members);
+}
+
+std::string LayoutName(const std::vector<unsigned int>& node_sizes) {
+  return std::to_string(node_sizes.size()) + "x"
+         + std::to_string(node_sizes.front());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::Suite suite("systems", bench::ParseOptions(argc, argv, 10));
+  const unsigned int sizes[] = {10, 1000, 100000};
+  const unsigned int dimensions[] = {1, 2, 3};
+
+  std::cout << "throughput in integration steps per second" << std::endl;
+  for (unsigned int N : sizes) {
+    for (unsigned int d : dimensions) {
+      BenchmarkSteps<sam::RK4System<bench::CyclicODE>>(suite, "RK4System", N,
+                                                       d);
+      BenchmarkSteps<sam::EulerSystem<bench::CyclicODE>>(suite,
+                                                         "EulerSystem", N, d);
+    }
+  }
+
+  std::cout << "ensembles, throughput in member steps per second"
+            << std::endl;
+  for (unsigned int members : {64, 1024}) {
+    BenchmarkEnsemble(suite, members);
+  }
+
+  // the same number of phases in different numbers of populations
+  const unsigned int number_phases = 10000;
+  const unsigned int steps = 100;
+  std::cout << "networks of " << number_phases << " phases, " << steps
+            << " steps" << std::endl;
+  for (unsigned int P : {1, 10, 100, 1000}) {
+    std::vector<unsigned int> node_sizes(P, number_phases/P);
+    std::vector<double> frequencies(number_phases);
+    for (size_t i = 0; i < number_phases; ++i) {
+      frequencies[i] = 1. + 0.1*std::sin(static_cast<double>(i));
+    }
+    sam::PopulationKuramotoODE::matrix_type coupling(
+        P, std::vector<double>(P, 1./P));
+    sam::RK4Network<sam::PopulationKuramotoODE> network(
+        node_sizes, 1, node_sizes, frequencies, coupling);
+    network.SetPosition(InitialState(number_phases));
+    suite.Run("RK4Network " + LayoutName(node_sizes), [&]() {
+        network.Integrate(0.01, steps);
+        bench::DoNotOptimize(network);
+      }, steps);
+    sam::RK4Network<sam::PopulationKuramotoODE>::ragged_type nodes;
+    suite.Run("NodesMeanFieldSpherical " + LayoutName(node_sizes), [&]() {
+        network.CalculateNodesMeanFieldSpherical(nodes);
+        bench::DoNotOptimize(nodes);
+      }, number_phases);
+  }
+
+  // mean fields and spherical coordinates of 1e6 coordinates
+  std::cout << "transforms of 1e6 coordinates" << std::endl;
+  for (unsigned int d : dimensions) {
+    const unsigned int N = 1000000/d;
+    sam::RK4System<bench::CyclicODE> system(N, d, d, 1., 0.1);
+    system.SetPosition(InitialState(N*d));
+    const std::string suffix = " d=" + std::to_string(d);
+    suite.Run("CalculateMeanField" + suffix, [&]() {
+        std::vector<double> mean_field = system.CalculateMeanField();
+        bench::DoNotOptimize(mean_field);
+      }, N);
+    suite.Run("CalculateMeanFieldSpherical" + suffix, [&]() {
+        std::vector<double> mean_field = system.CalculateMeanFieldSpherical();
+        bench::DoNotOptimize(mean_field);
+      }, N);
+    suite.Run("GetPositionSpherical" + suffix, [&]() {
+        std::vector<double> spherical = system.GetPositionSpherical();
+        bench::DoNotOptimize(spherical);
+      }, N);
+
+    std::vector<unsigned int> node_sizes(100, N/100);
+    sam::RK4Network<bench::CyclicODE> network(node_sizes, d, d, 1., 0.1);
+    network.SetPosition(InitialState(100*(N/100)*d));
+    sam::RK4Network<bench::CyclicODE>::ragged_type nodes;
+    suite.Run("GetNodesSpherical 100 nodes" + suffix, [&]() {
+        network.GetNodesSpherical(nodes);
+        bench::DoNotOptimize(nodes);
+      }, N);
+    suite.Run("CalculateNodesMeanField 100 nodes" + suffix, [&]() {
+        network.CalculateNodesMeanField(nodes);
+        bench::DoNotOptimize(nodes);
+      }, N);
+  }
+  return suite.Finish();
+}
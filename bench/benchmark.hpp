@@ -0,0 +1,237 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef BENCH_BENCHMARK_HPP_
+#define BENCH_BENCHMARK_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/*!
+ * \brief Result of a benchmark, the times are in seconds.
+ */
+struct Result {
+  std::string name;
+  double min;
+  double median;
+  //! Number of processed items per call, e.g. integration steps, 0 if the
+  //! throughput is not reported.
+  double items = 0.;
+  unsigned int repetitions = 0;
+};
+
+/*!
+ * \brief Command line options of a benchmark executable.
+ *
+ * --repetitions=N sets the number of timed calls, --filter=TEXT only runs the
+ * benchmarks whose name contains TEXT and --json=FILE writes the results to
+ * FILE.
+ */
+struct Options {
+  unsigned int repetitions = 20;
+  std::string filter;
+  std::string json;
+};
+
+/*!
+ * \brief Prevent the compiler from removing a computation, whose result is
+ * never used.
+ */
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/*!
+ * \brief Time a function.
+ *
+ * The function is called once to warm up the caches and then repetitions
+ * times. The minimum and median of the times are returned and printed, if
+ * items is larger than 0 also the number of items per second of the median.
+ */
+template<typename function_type>
+Result Run(const std::string& name, unsigned int repetitions,
+           function_type function, double items = 0.);
+
+/*!
+ * \brief Parse the options, unknown arguments throw std::invalid_argument.
+ */
+inline Options ParseOptions(int argc, char** argv,
+                            unsigned int default_repetitions = 20);
+
+/*!
+ * \brief Write the results as JSON, one object per result with the name, the
+ * number of repetitions, min and median in seconds and the items per second.
+ *
+ * The compiler, the build type and the flags of the build are recorded, so
+ * results of different builds are not mixed up. They are set by
+ * bench/CMakeLists.txt.
+ */
+inline void WriteJson(std::ostream& out, const std::string& suite,
+                      const std::vector<Result>& results);
+
+/*!
+ * \brief A collection of benchmarks of one executable.
+ *
+ * The results are collected, so they can be written as JSON at the end for
+ * tracking the performance over time.
+ */
+class Suite {
+ public:
+  Suite(const std::string& name, const Options& options);
+
+  /*!
+   * \brief Time the function with Run, if the name matches the filter.
+   */
+  template<typename function_type>
+  void Run(const std::string& name, function_type function,
+           double items = 0.);
+
+  const std::vector<Result>& GetResults() const;
+
+  /*!
+   * \brief Write the JSON file, if it was requested. Returns the exit code
+   * for main.
+   */
+  int Finish() const;
+
+ private:
+  std::string name_;
+  Options options_;
+  std::vector<Result> results_;
+};
+
+// Implementation
+
+#ifndef SAM_BENCH_COMPILER
+#define SAM_BENCH_COMPILER "unknown"
+#endif
+#ifndef SAM_BENCH_BUILD_TYPE
+#define SAM_BENCH_BUILD_TYPE "unknown"
+#endif
+#ifndef SAM_BENCH_FLAGS
+#define SAM_BENCH_FLAGS "unknown"
+#endif
+
+template<typename function_type>
+Result Run(const std::string& name, unsigned int repetitions,
+           function_type function, double items) {
+  function();
+  std::vector<double> times;
+  for (unsigned int i = 0; i < repetitions; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double>(end - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  Result result = {name, times.front(), times[times.size()/2], items,
+                   repetitions};
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::scientific << std::setprecision(3)
+            << result.min << " s" << std::setw(12) << result.median << " s";
+  if (items > 0.) {
+    std::cout << std::setw(12) << items/result.median << " /s";
+  }
+  std::cout << std::endl;
+  return result;
+}
+
+inline Options ParseOptions(int argc, char** argv,
+                            unsigned int default_repetitions) {
+  Options options;
+  options.repetitions = default_repetitions;
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument(argv[i]);
+    const size_t equal = argument.find('=');
+    const std::string key = argument.substr(0, equal);
+    const std::string value = equal == std::string::npos ? ""
+        : argument.substr(equal + 1);
+    if (key == "--repetitions" && std::atoi(value.c_str()) > 0) {
+      options.repetitions = std::atoi(value.c_str());
+    } else if (key == "--filter") {
+      options.filter = value;
+    } else if (key == "--json" && !value.empty()) {
+      options.json = value;
+    } else {
+      throw std::invalid_argument("Unknown argument " + argument + ", use "
+          "--repetitions=N, --filter=TEXT or --json=FILE.");
+    }
+  }
+  return options;
+}
+
+inline std::string EscapeJson(const std::string& text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\') escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+inline void WriteJson(std::ostream& out, const std::string& suite,
+                      const std::vector<Result>& results) {
+  out << std::setprecision(std::numeric_limits<double>::max_digits10)
+      << "{\n  \"suite\": \"" << EscapeJson(suite) << "\",\n"
+      << "  \"compiler\": \"" << EscapeJson(SAM_BENCH_COMPILER) << "\",\n"
+      << "  \"build_type\": \"" << EscapeJson(SAM_BENCH_BUILD_TYPE)
+      << "\",\n"
+      << "  \"flags\": \"" << EscapeJson(SAM_BENCH_FLAGS) << "\",\n"
+      << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    out << (i == 0 ? "\n" : ",\n")
+        << "    {\"name\": \"" << EscapeJson(result.name) << "\", "
+        << "\"repetitions\": " << result.repetitions << ", "
+        << "\"min\": " << result.min << ", "
+        << "\"median\": " << result.median;
+    if (result.items > 0.) {
+      out << ", \"items_per_second\": " << result.items/result.median;
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+inline Suite::Suite(const std::string& name, const Options& options)
+    : name_(name), options_(options) {}
+
+template<typename function_type>
+void Suite::Run(const std::string& name, function_type function,
+                double items) {
+  if (name.find(options_.filter) == std::string::npos) {
+    return;
+  }
+  results_.push_back(bench::Run(name, options_.repetitions, function, items));
+}
+
+inline const std::vector<Result>& Suite::GetResults() const {
+  return results_;
+}
+
+inline int Suite::Finish() const {
+  if (options_.json.empty()) {
+    return 0;
+  }
+  std::ofstream file(options_.json);
+  if (!file) {
+    std::cerr << "Cannot write " << options_.json << std::endl;
+    return 1;
+  }
+  WriteJson(file, name_, results_);
+  return 0;
+}
+
+}  // namespace bench
+
+#endif  // BENCH_BENCHMARK_HPP_
@@ -0,0 +1,258 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_ANALYSIS_ADJOINT_HPP_
+#define INCLUDE_SAM_ANALYSIS_ADJOINT_HPP_
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "../helper/state_traits.hpp"
+#include "../observer/position_observer.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Parameters for the backward integration of the adjoint equation.
+ */
+struct AdjointParameters {
+  //! The number of steps of the orbit and the adjoint per period.
+  unsigned int steps_per_period = 1000;
+  //! The maximal number of periods of the backward integration.
+  unsigned int max_periods = 100;
+  //! The largest change of the iPRC over one period for convergence.
+  double tolerance = 1e-8;
+  //! The relative step of the numerical Jacobian.
+  double jacobian_step = 1e-6;
+  //! The largest number of entries of the Jacobians along the orbit, that
+  //! are stored. If they fit, the Jacobians are only calculated once,
+  //! otherwise they are calculated again in every period. Every entry is a
+  //! double, the default of 2^19 uses at most 4 MiB.
+  size_t max_stored_entries = 1 << 19;
+};
+
+/*!
+ * \brief The periodic orbit and its infinitesimal phase response curve.
+ *
+ * The entry k of every vector belongs to the time k T/steps_per_period after
+ * the start of the orbit, the first and last point are the same.
+ */
+template<typename state_type>
+struct AdjointSolution {
+  std::vector<double> time;
+  std::vector<state_type> orbit;
+  //! The gradient of the phase Z(t), normalized to Z.f = 2 pi/T.
+  std::vector<state_type> iprc;
+};
+
+/*!
+ * \brief Jacobian of the ODE of a system with central differences.
+ *
+ * It is called as jacobian(x, J, t) and writes df_i/dx_j at the position x
+ * and time t into J. The system is copied and only used to evaluate the ODE.
+ */
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
+class NumericalJacobian {
+ public:
+  explicit NumericalJacobian(const system_type& system, double step = 1e-6);
+
+  void operator()(const state_type& x, Eigen::MatrixXd& jacobian, double t);
+
+ private:
+  system_type system_;
+  double step_;
+  state_type shifted_, forward_, backward_;
+};
+
+/*!
+ * \brief Calculate the infinitesimal phase response curve (iPRC) along a
+ * limit cycle with the adjoint method.
+ *
+ * The periodic orbit is recorded for one period starting at the current
+ * position of the system, which has to be on the limit cycle, and the
+ * adjoint equation
+ * \f[ \dot{Z} = -J(x(t))^T Z \f]
+ * is integrated backward along it with a Runge-Kutta method of 4th order,
+ * where the orbit at half steps is used for the intermediate stages. The
+ * solution converges to the periodic iPRC, because all other solutions
+ * decay in backward time. It is normalized so that Z.f(x) = 2 pi/T at every
+ * point, i.e. the phase grows from 0 to 2 pi in one period. This needs a few
+ * periods of integration instead of one relaxation per perturbed state like
+ * FindLinearizedPhaseFrequency. The transposed Jacobians at the 2 M + 1
+ * points of the orbit are calculated once, if they fit into
+ * params.max_stored_entries, so every further period only needs
+ * matrix-vector products. They need n^2 (2 M + 1) doubles for the dimension
+ * n of the state, e.g. 4 MiB for n = 16 and M = 1000 with the default.
+ *
+ * @param system The system on the limit cycle, it is copied.
+ * @param period The period of the limit cycle, e.g. from CalculatePeriod.
+ * @param jacobian Called as jacobian(x, J, t) with an Eigen::MatrixXd J, see
+ *        NumericalJacobian.
+ * @param params The parameters of the integration.
+ *
+ * @throws std::runtime_error If the iPRC does not converge within
+ *         params.max_periods periods.
+ */
+template<typename system_type, typename jacobian_type,
+         typename state_type = system_state_type<system_type>>
+AdjointSolution<state_type> CalculateAdjoint(system_type system,
+                                             double period,
+                                             jacobian_type&& jacobian,
+                                             AdjointParameters params);
+
+/*!
+ * \brief Same as above with a NumericalJacobian of the system.
+ */
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
+AdjointSolution<state_type> CalculateAdjoint(const system_type& system,
+                                             double period,
+                                             AdjointParameters params);
+
+// Implementation
+
+template<typename system_type, typename state_type>
+NumericalJacobian<system_type, state_type>::NumericalJacobian(
+    const system_type& system, double step)
+    : system_(system), step_(step) {}
+
+template<typename system_type, typename state_type>
+void NumericalJacobian<system_type, state_type>::operator()(
+    const state_type& x, Eigen::MatrixXd& jacobian, double t) {
+  const size_t n = x.size();
+  jacobian.resize(n, n);
+  shifted_ = x;
+  system_.SetTime(t);
+  for (size_t j = 0; j < n; ++j) {
+    const double h = step_*std::fmax(1., std::fabs(x[j]));
+    shifted_[j] = x[j] + h;
+    system_.SetPosition(shifted_);
+    system_.GetDerivative(forward_);
+    shifted_[j] = x[j] - h;
+    system_.SetPosition(shifted_);
+    system_.GetDerivative(backward_);
+    shifted_[j] = x[j];
+    for (size_t i = 0; i < n; ++i) {
+      jacobian(i, j) = (forward_[i] - backward_[i])/(2.*h);
+    }
+  }
+}
+
+template<typename system_type, typename jacobian_type, typename state_type>
+AdjointSolution<state_type> CalculateAdjoint(system_type system,
+                                             double period,
+                                             jacobian_type&& jacobian,
+                                             AdjointParameters params) {
+  const unsigned int M = params.steps_per_period;
+  const double dt = period/static_cast<double>(M);
+  const double start_time = system.GetTime();
+  // the orbit at half steps, entry 2k is the point k
+  std::vector<state_type> orbit;
+  std::vector<double> orbit_time;
+  system.Integrate(dt/2., 2*M,
+                   PositionObserver<state_type>(orbit, orbit_time));
+  const size_t n = orbit.front().size();
+
+  // derivatives of the points k for the normalization
+  std::vector<Eigen::VectorXd> derivative(M + 1);
+  state_type buffer;
+  for (size_t k = 0; k <= M; ++k) {
+    system.SetPosition(orbit[2*k]);
+    system.SetTime(orbit_time[2*k]);
+    system.GetDerivative(buffer);
+    derivative[k].resize(n);
+    for (size_t i = 0; i < n; ++i) derivative[k](i) = buffer[i];
+  }
+  const double frequency = 2.*M_PI/period;
+  auto normalize = [&](Eigen::VectorXd& Z, size_t k) {
+    const double product = Z.dot(derivative[k]);
+    if (product == 0.) {
+      throw std::runtime_error("The adjoint is orthogonal to the flow.");
+    }
+    Z *= frequency/product;
+  };
+
+  // dZ/ds = J^T Z in the backward time s = -t
+  Eigen::VectorXd Z = derivative[M]/derivative[M].squaredNorm()*frequency;
+  Eigen::VectorXd k1, k2, k3, k4;
+  auto step = [&](const auto& Jt_end, const auto& Jt_half,
+                  const auto& Jt_start) {
+    k1.noalias() = Jt_end*Z;
+    k2.noalias() = Jt_half*(Z + dt/2.*k1);
+    k3.noalias() = Jt_half*(Z + dt/2.*k2);
+    k4.noalias() = Jt_start*(Z + dt*k3);
+    Z += dt/6.*(k1 + 2.*k2 + 2.*k3 + k4);
+  };
+  // the orbit does not change, so the Jacobians of all periods are the same
+  std::vector<Eigen::MatrixXd> transposed;
+  Eigen::MatrixXd J_end, J_half, J_start;
+  if (n*n*(2*M + 1) <= params.max_stored_entries) {
+    transposed.resize(2*M + 1);
+    for (size_t j = 0; j <= 2*M; ++j) {
+      jacobian(orbit[j], J_start, orbit_time[j]);
+      transposed[j] = J_start.transpose();
+    }
+  }
+  std::vector<Eigen::VectorXd> iprc(M + 1);
+  bool converged = false;
+  for (unsigned int p = 0; p < params.max_periods && !converged; ++p) {
+    const Eigen::VectorXd Z_period = Z;
+    iprc[M] = Z;
+    if (!transposed.empty()) {
+      for (size_t k = M; k-- > 0;) {
+        step(transposed[2*k + 2], transposed[2*k + 1], transposed[2*k]);
+        iprc[k] = Z;
+      }
+    } else {
+      // the Jacobian of the end of a step is the one of the beginning of the
+      // next step, the orbit is periodic, so the start is the end of the next
+      // period
+      jacobian(orbit[2*M], J_end, orbit_time[2*M]);
+      for (size_t k = M; k-- > 0;) {
+        jacobian(orbit[2*k + 1], J_half, orbit_time[2*k + 1]);
+        jacobian(orbit[2*k], J_start, orbit_time[2*k]);
+        step(J_end.transpose(), J_half.transpose(), J_start.transpose());
+        iprc[k] = Z;
+        std::swap(J_end, J_start);
+      }
+    }
+    normalize(Z, 0);
+    converged = (Z - Z_period).lpNorm<Eigen::Infinity>() < params.tolerance;
+  }
+  if (!converged) {
+    throw std::runtime_error("The adjoint did not converge within the "
+                             "maximal number of periods.");
+  }
+
+  AdjointSolution<state_type> solution;
+  for (size_t k = 0; k <= M; ++k) {
+    normalize(iprc[k], k);
+    solution.time.push_back(orbit_time[2*k] - start_time);
+    solution.orbit.push_back(orbit[2*k]);
+    state_type Z_k = StateTraits<state_type>::Zero(n);
+    for (size_t i = 0; i < n; ++i) Z_k[i] = iprc[k](i);
+    solution.iprc.push_back(Z_k);
+  }
+  return solution;
+}
+
+template<typename system_type, typename state_type>
+AdjointSolution<state_type> CalculateAdjoint(const system_type& system,
+                                             double period,
+                                             AdjointParameters params) {
+  return CalculateAdjoint<system_type, NumericalJacobian<system_type,
+                                                         state_type>,
+                          state_type>(
+      system, period,
+      NumericalJacobian<system_type, state_type>(system,
+                                                 params.jacobian_step),
+      params);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_ANALYSIS_ADJOINT_HPP_
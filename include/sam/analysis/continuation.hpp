@@ -0,0 +1,223 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_ANALYSIS_CONTINUATION_HPP_
+#define INCLUDE_SAM_ANALYSIS_CONTINUATION_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../helper/npy.hpp"
+#include "../helper/state_traits.hpp"
+#include "../helper/thread_pool.hpp"
+#include "./period.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Parameters for ContinuePeriod.
+ */
+struct ContinuationParameters : PeriodEstimateParameters {
+  //! The number of independent segments of the parameter range, that are
+  //! continued in parallel. Every segment starts from the initial state.
+  unsigned int segments = 1;
+  //! The largest time to the next crossing in periods of the previous point
+  //! with a crossing. Past it the oscillation is taken as dead, so a point
+  //! without crossings costs only a few periods instead of params.max_iter
+  //! steps. The first point of a segment and 0 only use params.max_iter.
+  double max_periods = 10.;
+};
+
+/*!
+ * \brief The limit cycle at one value of the parameter.
+ */
+template<typename state_type>
+struct ContinuationPoint {
+  double parameter;
+  PeriodType type;
+  double period;
+  //! The standard error of the period.
+  double uncertainty;
+  //! The number of crossings of the section per period.
+  unsigned int multiplicity;
+  //! The number of crossings that EstimatePeriod needed.
+  size_t crossings;
+  //! Half of the range of every coordinate over one period.
+  state_type amplitude;
+  //! The state after one period, the next point starts from it. If there
+  //! was no crossing, it is the state of the last point with a crossing.
+  state_type state;
+};
+
+/*!
+ * \brief Calculate the period and amplitude of a limit cycle along a range of
+ * parameters.
+ *
+ * The parameters are walked in the given order. At every point the parameter
+ * is set with set_parameter(system, value), the period is found with
+ * EstimatePeriod and the amplitude is measured over one more period. The next
+ * point starts from the state of the previous one, so it is already close to
+ * the new limit cycle. EstimatePeriod fits as few as
+ * 3 params.max_multiplicity crossings, so such a point needs fewer crossings
+ * than one that relaxes from the initial state again. If the oscillation
+ * dies at a parameter, e.g. past a Hopf bifurcation, and there is no
+ * crossing within params.max_periods periods of the last point with a
+ * crossing, the point is kNotConverged with the period -1 and the next point
+ * starts from the last state with a crossing. The range is split into
+ * params.segments contiguous segments, which are continued in parallel, each
+ * with its own copy of the system that starts at the initial state.
+ *
+ * @param system The system with the initial state, it is copied.
+ * @param parameters The values of the parameter in the order of the walk.
+ * @param set_parameter Called as set_parameter(system_type&, double), e.g.
+ *        with system.SetParameters.
+ * @param dt The timestep.
+ * @param condition A boolean function of the state at a crossing, see
+ *        EstimatePeriod.
+ * @param params The parameters of the section, the period estimation and
+ *        the number of segments.
+ * @param pool The threads for the segments.
+ *
+ * @returns One point per parameter in the same order.
+ *
+ * @throws std::invalid_argument If the parameters of EstimatePeriod are
+ *         invalid.
+ */
+template<typename system_type, typename setter_func, typename condition_func,
+         typename state_type = system_state_type<system_type>>
+std::vector<ContinuationPoint<state_type>> ContinuePeriod(
+    const system_type& system, const std::vector<double>& parameters,
+    const setter_func& set_parameter, double dt,
+    const condition_func& condition, ContinuationParameters params,
+    ThreadPool& pool);
+
+/*!
+ * \brief Same as above with a new pool of number_threads threads, 0 uses all
+ * hardware threads.
+ */
+template<typename system_type, typename setter_func, typename condition_func,
+         typename state_type = system_state_type<system_type>>
+std::vector<ContinuationPoint<state_type>> ContinuePeriod(
+    const system_type& system, const std::vector<double>& parameters,
+    const setter_func& set_parameter, double dt,
+    const condition_func& condition, ContinuationParameters params,
+    unsigned int number_threads = 0);
+
+/*!
+ * \brief Save the points as a .npy table with one row per point, see
+ * WriteNpy.
+ *
+ * The columns are the parameter, the period, its uncertainty, the
+ * multiplicity and the amplitudes of all coordinates. Points that did not
+ * converge have the period -1.
+ */
+template<typename state_type>
+void SaveContinuation(const std::string& filename,
+                      const std::vector<ContinuationPoint<state_type>>& points);
+
+// Implementation
+
+template<typename system_type, typename setter_func, typename condition_func,
+         typename state_type>
+std::vector<ContinuationPoint<state_type>> ContinuePeriod(
+    const system_type& system, const std::vector<double>& parameters,
+    const setter_func& set_parameter, double dt,
+    const condition_func& condition, ContinuationParameters params,
+    ThreadPool& pool) {
+  std::vector<ContinuationPoint<state_type>> points(parameters.size());
+  const size_t segments = std::max<size_t>(
+      1, std::min<size_t>(params.segments, parameters.size()));
+  pool.ParallelFor(segments, [&](size_t s) {
+    system_type copy(system);
+    const size_t size = copy.GetPosition().size();
+    state_type minimum = StateTraits<state_type>::Zero(size);
+    state_type maximum = minimum;
+    auto range = [&](const state_type& x, double t) {
+      for (size_t i = 0; i < size; ++i) {
+        minimum[i] = std::min(minimum[i], x[i]);
+        maximum[i] = std::max(maximum[i], x[i]);
+      }
+    };
+    state_type last_state = copy.GetPosition();
+    double last_period = -1.;
+    const size_t end = (s + 1)*parameters.size()/segments;
+    for (size_t k = s*parameters.size()/segments; k < end; ++k) {
+      set_parameter(copy, parameters[k]);
+      PeriodEstimateParameters point_params = params;
+      if (last_period > 0. && params.max_periods > 0.) {
+        point_params.max_iter = static_cast<unsigned int>(std::min<double>(
+            params.max_iter, std::ceil(params.max_periods*last_period/dt)));
+      }
+      PeriodEstimate estimate;
+      try {
+        estimate = EstimatePeriod(copy, dt, condition, point_params);
+      } catch (const NoCrossingError&) {
+        // the oscillation has died
+        copy.SetPosition(last_state);
+      }
+      ContinuationPoint<state_type>& point = points[k];
+      point.parameter = parameters[k];
+      point.type = estimate.type;
+      point.period = estimate.period;
+      point.uncertainty = estimate.uncertainty;
+      point.multiplicity = estimate.multiplicity;
+      point.crossings = estimate.crossing_times.size();
+
+      minimum = copy.GetPosition();
+      maximum = minimum;
+      if (estimate.period > 0.) {
+        copy.Integrate(dt, static_cast<unsigned int>(
+            std::ceil(estimate.period/dt)), range);
+      }
+      point.amplitude = minimum;
+      for (size_t i = 0; i < size; ++i) {
+        point.amplitude[i] = 0.5*(maximum[i] - minimum[i]);
+      }
+      point.state = copy.GetPosition();
+      if (point.crossings > 0) {
+        last_state = point.state;
+      }
+      if (estimate.period > 0.) {
+        last_period = estimate.period;
+      }
+    }
+  });
+  return points;
+}
+
+template<typename system_type, typename setter_func, typename condition_func,
+         typename state_type>
+std::vector<ContinuationPoint<state_type>> ContinuePeriod(
+    const system_type& system, const std::vector<double>& parameters,
+    const setter_func& set_parameter, double dt,
+    const condition_func& condition, ContinuationParameters params,
+    unsigned int number_threads) {
+  ThreadPool pool(number_threads);
+  return ContinuePeriod<system_type, setter_func, condition_func,
+                        state_type>(system, parameters, set_parameter, dt,
+                                    condition, params, pool);
+}
+
+template<typename state_type>
+void SaveContinuation(
+    const std::string& filename,
+    const std::vector<ContinuationPoint<state_type>>& points) {
+  const size_t size = points.empty() ? 0 : points.front().amplitude.size();
+  std::vector<double> table;
+  table.reserve(points.size()*(4 + size));
+  for (const ContinuationPoint<state_type>& point : points) {
+    table.push_back(point.parameter);
+    table.push_back(point.period);
+    table.push_back(point.uncertainty);
+    table.push_back(point.multiplicity);
+    for (size_t i = 0; i < size; ++i) table.push_back(point.amplitude[i]);
+  }
+  WriteNpy(filename, table, {points.size(), 4 + size});
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_ANALYSIS_CONTINUATION_HPP_
@@ -0,0 +1,222 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_ANALYSIS_EVENTS_HPP_
+#define INCLUDE_SAM_ANALYSIS_EVENTS_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../helper/state_traits.hpp"
+
+namespace sam {
+
+/*!
+ * \brief The direction in which the event function has to cross zero.
+ */
+enum class EventDirection {
+  kBoth,
+  //! From negative to positive.
+  kRising,
+  //! From positive to negative.
+  kFalling
+};
+
+/*!
+ * \brief Parameters for the detection of events.
+ */
+struct EventParameters {
+  EventDirection direction = EventDirection::kBoth;
+  //! The tolerance of the time of an event.
+  double tolerance = 1e-12;
+  //! The maximal number of iterations of the root finding per event.
+  unsigned int max_iter = 100;
+  //! Stop the integration after this many events, 0 for no limit.
+  unsigned int max_events = 0;
+};
+
+/*!
+ * \brief A zero of the event function.
+ */
+template<typename state_type>
+struct Event {
+  double time;
+  state_type state;
+  //! 1 if the event function rises through zero, -1 if it falls.
+  int direction;
+};
+
+/*!
+ * \brief Find a root of function in the bracket [a, b] with Brent's method.
+ *
+ * The values at the ends fa = function(a) and fb = function(b) must not have
+ * the same sign. Inverse quadratic interpolation and secant steps are used as
+ * long as they stay in the bracket and shrink it fast enough, otherwise it is
+ * bisected, so it always converges.
+ *
+ * @throws std::runtime_error If the bracket is not smaller than tolerance
+ *         after max_iter iterations.
+ */
+template<typename function_type>
+double BrentRoot(function_type&& function, double a, double b, double fa,
+                 double fb, double tolerance, unsigned int max_iter);
+
+/*!
+ * \brief Integrate the system and locate all zeros of an event function.
+ *
+ * The event function g(x, t) is evaluated after every step of size dt. If it
+ * changes its sign in the chosen direction, the time of the zero is found
+ * with BrentRoot, where every evaluation integrates a copy of the system
+ * from the beginning of the step with a single step of the fraction of dt.
+ * So the events have the same accuracy as the integration itself and work
+ * for any scalar function, not only the crossing of one coordinate like
+ * IntegrateToCrossing. A whole Poincare section is collected in one
+ * integration.
+ *
+ * @param system The system, it is integrated number_steps steps, or up to
+ *        the step of the last event if params.max_events is reached.
+ * @param dt The timestep.
+ * @param number_steps The maximal number of steps.
+ * @param event The event function, called as event(x, t) with a state_type.
+ * @param params The parameters of the detection.
+ *
+ * @returns The events in the order of their times.
+ *
+ * @throws std::runtime_error If the root finding does not converge.
+ */
+template<typename system_type, typename event_func,
+         typename state_type = system_state_type<system_type>>
+std::vector<Event<state_type>> IntegrateWithEvents(
+    system_type& system, double dt, unsigned int number_steps,
+    event_func&& event, EventParameters params = EventParameters());
+
+// Implementation
+
+template<typename function_type>
+double BrentRoot(function_type&& function, double a, double b, double fa,
+                 double fb, double tolerance, unsigned int max_iter) {
+  if (fa == 0.) return a;
+  if (fb == 0.) return b;
+  if ((fa > 0.) == (fb > 0.)) {
+    throw std::invalid_argument("The root is not bracketed.");
+  }
+  // b is the best estimate, a the previous one and c the other end of the
+  // bracket
+  double c = a, fc = fa, d = b - a, e = d;
+  for (unsigned int iter = 0; iter < max_iter; ++iter) {
+    if ((fb > 0.) == (fc > 0.)) {
+      c = a;
+      fc = fa;
+      d = e = b - a;
+    }
+    if (std::fabs(fc) < std::fabs(fb)) {
+      a = b;
+      b = c;
+      c = a;
+      fa = fb;
+      fb = fc;
+      fc = fa;
+    }
+    const double tol = 2.*1e-16*std::fabs(b) + 0.5*tolerance;
+    const double m = 0.5*(c - b);
+    if (std::fabs(m) <= tol || fb == 0.) {
+      return b;
+    }
+    if (std::fabs(e) >= tol && std::fabs(fa) > std::fabs(fb)) {
+      double p, q, r;
+      const double s = fb/fa;
+      if (a == c) {
+        // secant
+        p = 2.*m*s;
+        q = 1. - s;
+      } else {
+        // inverse quadratic interpolation
+        q = fa/fc;
+        r = fb/fc;
+        p = s*(2.*m*q*(q - r) - (b - a)*(r - 1.));
+        q = (q - 1.)*(r - 1.)*(s - 1.);
+      }
+      if (p > 0.) {
+        q = -q;
+      } else {
+        p = -p;
+      }
+      if (2.*p < std::fmin(3.*m*q - std::fabs(tol*q), std::fabs(e*q))) {
+        e = d;
+        d = p/q;
+      } else {
+        d = m;
+        e = m;
+      }
+    } else {
+      d = m;
+      e = m;
+    }
+    a = b;
+    fa = fb;
+    b += std::fabs(d) > tol ? d : (m > 0. ? tol : -tol);
+    fb = function(b);
+  }
+  throw std::runtime_error("The root finding did not converge within the "
+                           "maximal number of iterations.");
+}
+
+template<typename system_type, typename event_func, typename state_type>
+std::vector<Event<state_type>> IntegrateWithEvents(
+    system_type& system, double dt, unsigned int number_steps,
+    event_func&& event, EventParameters params) {
+  std::vector<Event<state_type>> events;
+  // the state is copied from the view into buffers, so no memory is
+  // allocated per step
+  auto position = system.GetPositionView();
+  const size_t size = position.size();
+  state_type x_start = StateTraits<state_type>::Zero(size);
+  state_type x_end = x_start;
+  for (size_t i = 0; i < size; ++i) x_end[i] = position[i];
+  double t_end = system.GetTime();
+  double g_end = event(x_end, t_end);
+
+  // the copy integrates from the beginning of a step to a fraction of it
+  system_type refinement(system);
+  auto refined_position = refinement.GetPositionView();
+  state_type x_refined = x_start;
+  double t_start = t_end;
+  auto integrate_fraction = [&](double s) {
+    refinement.SetPosition(x_start);
+    refinement.SetTime(t_start);
+    if (s > 0.) refinement.Integrate(s*dt, 1);
+    for (size_t i = 0; i < size; ++i) x_refined[i] = refined_position[i];
+  };
+
+  for (unsigned int step = 0; step < number_steps; ++step) {
+    std::swap(x_start, x_end);
+    t_start = t_end;
+    const double g_start = g_end;
+    system.Integrate(dt, 1);
+    for (size_t i = 0; i < size; ++i) x_end[i] = position[i];
+    t_end = system.GetTime();
+    g_end = event(x_end, t_end);
+
+    const bool rising = g_start < 0. && g_end >= 0.;
+    const bool falling = g_start > 0. && g_end <= 0.;
+    if ((rising && params.direction != EventDirection::kFalling)
+        || (falling && params.direction != EventDirection::kRising)) {
+      const double s = BrentRoot([&](double s) {
+          integrate_fraction(s);
+          return event(x_refined, t_start + s*dt);
+        }, 0., 1., g_start, g_end, params.tolerance/dt, params.max_iter);
+      integrate_fraction(s);
+      events.push_back({t_start + s*dt, x_refined, rising ? 1 : -1});
+      if (events.size() == params.max_events) {
+        break;
+      }
+    }
+  }
+  return events;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_ANALYSIS_EVENTS_HPP_
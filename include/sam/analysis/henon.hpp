@@ -4,9 +4,12 @@
 #define INCLUDE_SAM_ANALYSIS_HENON_HPP_
 
 #include <cmath>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "../helper/state_traits.hpp"
 #include "../system/rk4_system.hpp"
 
 namespace sam {
@@ -18,6 +21,21 @@ struct CrossingParameters {
   unsigned int n_osc = 0;  //! The oscillator which should be considered.
   unsigned int dimension = 0;  //! The dimension to consider.
   double target = 0.;  //! The target value for the dimension.
+  //! The maximal number of steps to the crossing.
+  unsigned int max_iter = 10000000;
+};
+
+/*!
+ * \brief Thrown if there is no crossing within the maximal number of steps.
+ *
+ * It is a std::runtime_error, so it can be told apart from other errors,
+ * e.g. of the ODE, when a missing crossing is expected.
+ */
+class NoCrossingError : public std::runtime_error {
+ public:
+  NoCrossingError()
+      : std::runtime_error("No crossing within the maximal number of "
+                           "steps.") {}
 };
 
 /*!
@@ -30,15 +48,57 @@ struct CrossingParameters {
  * For more information see his paper at:
  * https://www.sciencedirect.com/science/article/abs/pii/0167278982900343
  *
+ * The system needs GetDimension(), GetPosition() and GetTime(). Its ODE is
+ * evaluated with EvaluateDerivative(x, dx, t) without a copy, if the system
+ * has it. Otherwise the system is copied once and the ODE is evaluated with
+ * SetPosition, SetTime and GetDerivative() of the copy.
+ *
  * @param system The system with a state close to the crossing.
  * @param params The parameters for the crossing.
  *
  * @returns A pair of time and state at the time of crossing.
  */
-template<typename system_type, typename state_type = std::vector<double>>
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
 std::pair<double, state_type> HenonTrick(const system_type& system,
                                          CrossingParameters params);
 
+template<typename system_type, typename state_type>
+class InverseHelperODE;
+
+/*!
+ * \brief The Henon trick for many crossings of the same system.
+ *
+ * HenonTrick creates a new helper system for every crossing. The refiner
+ * creates it once and reuses it, e.g. for recording all crossings of a long
+ * integration, see PoincareSection. The helper evaluates the ODE of the
+ * system with EvaluateDerivative instead of copying it, so the system has to
+ * outlive the refiner. Systems without EvaluateDerivative are copied once,
+ * see HenonTrick.
+ */
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
+class HenonRefiner {
+ public:
+  HenonRefiner(const system_type& system, CrossingParameters params);
+
+  /*!
+   * \brief Return the time of the crossing and write its state into
+   * crossing.
+   *
+   * @param x A state of the system close to the crossing.
+   * @param t The time of the state.
+   * @param crossing The state at the crossing, it is resized if needed.
+   */
+  double Refine(const state_type& x, double t, state_type& crossing);
+
+ private:
+  size_t indx_;
+  double target_;
+  RK4System<InverseHelperODE<system_type, state_type>, state_type> helper_;
+  state_type initial_;
+};
+
 /*!
  * \brief Integrate the system to the next regular point after axis crossing.
  *
@@ -52,10 +112,11 @@ std::pair<double, state_type> HenonTrick(const system_type& system,
  *
  * @returns A pair of time and state at the time of crossing.
  *
- * TODO: Implement max iter
- * TODO: Implement condition/predicate
+ * @throws NoCrossingError If there is no crossing within params.max_iter
+ *         steps.
  */
-template<typename system_type, typename state_type = std::vector<double>>
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
 std::pair<double, state_type> IntegrateToCrossing(system_type& system,
                                                   double dt,
                                                   CrossingParameters params);
@@ -77,66 +138,131 @@ std::pair<double, state_type> IntegrateToCrossing(system_type& system,
  *
  * @returns A pair of time and state at the time of crossing.
  *
- * TODO: Implement max iter
- * TODO: Implement condition/predicate
+ * @throws NoCrossingError If there is no crossing within params.max_iter
+ *         steps.
  */
 template<typename system_type, typename condition_func,
-         typename state_type = std::vector<double>>
+         typename state_type = system_state_type<system_type>>
 std::pair<double, state_type> IntegrateToCrossingConditional(
     system_type& system, double dt, condition_func&& condition,
     CrossingParameters params);
 
 // Implementation
 
+template<typename system_type, typename state_type, typename = void>
+struct HasEvaluateDerivative : std::false_type {};
+
+template<typename system_type, typename state_type>
+struct HasEvaluateDerivative<system_type, state_type, decltype(void(
+    std::declval<const system_type&>().EvaluateDerivative(
+        std::declval<const state_type&>(), std::declval<state_type&>(),
+        0.)))> : std::true_type {};
+
+// Evaluates the ODE of the system with EvaluateDerivative, so neither the
+// system nor the ODE is copied.
+template<typename system_type, typename state_type,
+         bool = HasEvaluateDerivative<system_type, state_type>::value>
+class DerivativeEvaluator {
+ public:
+  explicit DerivativeEvaluator(const system_type* system) : system_(system) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    system_->EvaluateDerivative(x, dx, t);
+  }
+
+ private:
+  const system_type* system_;
+};
+
+// Systems without EvaluateDerivative are copied once and evaluated through
+// their state.
+template<typename system_type, typename state_type>
+class DerivativeEvaluator<system_type, state_type, false> {
+ public:
+  explicit DerivativeEvaluator(const system_type* system) : system_(*system) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    system_.SetPosition(x);
+    system_.SetTime(t);
+    dx = system_.GetDerivative();
+  }
+
+ private:
+  system_type system_;
+};
+
+// The ODE with the dimension indx as independent variable. It refers to the
+// system and evaluates its ODE with a DerivativeEvaluator. The state and the
+// derivative are kept in buffers, so no memory is allocated during the
+// integration. The system is passed as a pointer, because the GenericSystem
+// copies the parameters of the ODE.
 template<typename system_type, typename state_type>
 class InverseHelperODE {
  public:
-  InverseHelperODE(system_type system, int indx)
-    : system_(system), indx_(indx) {}
+  InverseHelperODE(const system_type* system, size_t indx)
+    : evaluate_(system), indx_(indx), state_(system->GetPosition()),
+      derivative_(state_) {}
 
   void operator()(const state_type& x, state_type& dx, double t) {
-    state_type state = x;
-    state[indx_] = t;
-    system_.SetPosition(state);
-    system_.SetTime(x[indx_]);
-    state_type derivative = system_.GetDerivative();
-    for (size_t i = 0; i < derivative.size(); ++i) {
-      if (i == indx_) {
-        dx[indx_] = 1./derivative[indx_];
-      } else {
-        dx[i] = derivative[i] / derivative[indx_];
-      }
+    const size_t size = state_.size();
+    for (size_t i = 0; i < size; ++i) {
+      state_[i] = x[i];
+    }
+    state_[indx_] = t;
+    evaluate_(state_, derivative_, x[indx_]);
+    const double inverse = 1./derivative_[indx_];
+    for (size_t i = 0; i < size; ++i) {
+      dx[i] = derivative_[i]*inverse;
     }
+    dx[indx_] = inverse;
   }
 
  private:
-  system_type system_;
-  int indx_;
+  DerivativeEvaluator<system_type, state_type> evaluate_;
+  size_t indx_;
+  state_type state_, derivative_;
 };
 
+template<typename system_type, typename state_type>
+HenonRefiner<system_type, state_type>::HenonRefiner(
+    const system_type& system, CrossingParameters params)
+    // GetDimension().second is the dimension of each oscillator
+    : indx_(system.GetDimension().second*params.n_osc + params.dimension),
+      target_(params.target),
+      helper_(system.GetDimension().first, system.GetDimension().second,
+              &system, indx_) {}
+
+template<typename system_type, typename state_type>
+double HenonRefiner<system_type, state_type>::Refine(const state_type& x,
+                                                     double t,
+                                                     state_type& crossing) {
+  initial_ = x;
+  const double start = initial_[indx_];
+  helper_.SetTime(start);
+  initial_[indx_] = t;
+  helper_.SetPosition(initial_);
+  helper_.Integrate(target_ - start, 1);
+
+  crossing = initial_;
+  auto result = helper_.GetPositionView();
+  for (size_t i = 0; i < result.size(); ++i) {
+    crossing[i] = result[i];
+  }
+  const double t_crossing = crossing[indx_];
+  crossing[indx_] = helper_.GetTime();
+  return t_crossing;
+}
+
 template<typename system_type, typename state_type>
 std::pair<double, state_type> HenonTrick(const system_type& system,
                                          CrossingParameters params) {
-  std::pair<unsigned int, unsigned int> dimensionality = system.GetDimension();
-  // dimensionality.second is the dimension of each oscillator
-  size_t indx = dimensionality.second * params.n_osc + params.dimension;
-  auto helper_system =
-      RK4System<InverseHelperODE<system_type, state_type>, state_type>(
-          dimensionality.first, dimensionality.second, system, indx);
-  state_type initial = system.GetPosition();
-  helper_system.SetTime(initial[indx]);
-  initial[indx] = system.GetTime();
-  helper_system.SetPosition(initial);
-  helper_system.Integrate(params.target - system.GetPosition()[indx], 1);
-
-  state_type res = helper_system.GetPosition();
-  double t = res[indx];
-  res[indx] = helper_system.GetTime();
-  std::pair<double, state_type> ret_values(t, res);
-  return ret_values;
+  HenonRefiner<system_type, state_type> refiner(system, params);
+  state_type crossing;
+  double t = refiner.Refine(system.GetPosition(), system.GetTime(), crossing);
+  return std::pair<double, state_type>(t, crossing);
 }
 
-template<typename system_type, typename state_type = std::vector<double>>
+template<typename system_type, typename state_type>
 std::pair<double, state_type> IntegrateToCrossing(system_type& system,
                                                   double dt,
                                                   CrossingParameters params) {
@@ -145,19 +271,25 @@ std::pair<double, state_type> IntegrateToCrossing(system_type& system,
 }
 
 template<typename system_type, typename condition_func,
-         typename state_type = std::vector<double>>
+         typename state_type>
 std::pair<double, state_type> IntegrateToCrossingConditional(
     system_type& system, double dt, condition_func&& condition,
     CrossingParameters params) {
   std::pair<unsigned int, unsigned int> dimensionality = system.GetDimension();
   // dimensionality.second is the dimension of each oscillator
   size_t indx = dimensionality.second * params.n_osc + params.dimension;
-  state_type previous_state;
+  // the view follows the integration, so no state is copied per step
+  auto position = system.GetPositionView();
+  double previous;
+  unsigned int steps = 0;
   do {
-    previous_state = system.GetPosition();
+    if (steps++ == params.max_iter) {
+      throw NoCrossingError();
+    }
+    previous = position[indx];
     system.Integrate(dt, 1);
-  } while (std::copysign(1., previous_state[indx] - params.target)
-           == std::copysign(1., system.GetPosition()[indx] - params.target)
+  } while (std::copysign(1., previous - params.target)
+           == std::copysign(1., position[indx] - params.target)
            || !condition(system.GetPosition()));
   return HenonTrick(system, params);
 }
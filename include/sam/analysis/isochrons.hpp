@@ -0,0 +1,284 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_ANALYSIS_ISOCHRONS_HPP_
+#define INCLUDE_SAM_ANALYSIS_ISOCHRONS_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../helper/npy.hpp"
+#include "../helper/state_traits.hpp"
+#include "../helper/thread_pool.hpp"
+#include "./henon.hpp"
+#include "./phase.hpp"
+
+namespace sam {
+
+/*!
+ * \brief A regular grid of initial states in 2 or 3 coordinates.
+ *
+ * All points are the base state, where the chosen coordinates are replaced
+ * by the values of the grid. The points are numbered in row-major order, the
+ * last coordinate changes fastest.
+ */
+template<typename state_type = std::vector<double>>
+class IsochronGrid {
+ public:
+  /*!
+   * @param base The state for all coordinates that are not varied.
+   * @param indices The 2 or 3 coordinates of the state that are varied.
+   * @param minimum The first value of every varied coordinate.
+   * @param maximum The last value of every varied coordinate.
+   * @param number_points The number of values of every varied coordinate.
+   *
+   * @throws std::invalid_argument If there are not 2 or 3 coordinates, the
+   *         sizes do not match or a coordinate has no points.
+   */
+  IsochronGrid(const state_type& base, const std::vector<size_t>& indices,
+               const std::vector<double>& minimum,
+               const std::vector<double>& maximum,
+               const std::vector<unsigned int>& number_points);
+
+  /*!
+   * \brief Return the total number of points.
+   */
+  size_t size() const;
+
+  /*!
+   * \brief Return the number of points of every coordinate.
+   */
+  std::vector<size_t> GetShape() const;
+
+  /*!
+   * \brief Write point i into x, which has the size of the base.
+   */
+  void GetPoint(size_t i, state_type& x) const;
+
+  const state_type& GetBase() const;
+
+ private:
+  state_type base_;
+  std::vector<size_t> indices_;
+  std::vector<double> minimum_, step_;
+  std::vector<unsigned int> number_points_;
+};
+
+/*!
+ * \brief Return the asymptotic phase of a position, the integration stops as
+ * soon as the phase has converged.
+ *
+ * The system is integrated from the position at time 0 from crossing to
+ * crossing. The time t_k of the k-th crossing gives the estimate
+ * 2 pi (ceil(t_k/T) - t_k/T) of the phase, which is the same as for FindPhase.
+ * The differences of successive estimates shrink like rho^k with the
+ * contraction rate rho of the limit cycle, so the error of the last estimate
+ * is about diff rho/(1 - rho). rho is estimated from the last three
+ * estimates and the integration stops as soon as this error is smaller than
+ * params.phase_tolerance, the returned phase is extrapolated with Aitken's
+ * method. Points that are close to the limit cycle need only a few periods,
+ * no matter how long the whole state needs to relax, and for a weakly
+ * attracting cycle the integration is not stopped too early. All crossings
+ * are refined with one HenonRefiner. The system is changed, so it can be
+ * reused for the next position.
+ *
+ * @returns The phase in [0, 2 pi) or -1 if it did not converge within
+ *          params.phase_max_iter periods, e.g. at an unstable fixed point.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+double IsochronPhase(system_type& system, const state_type& position,
+                     double period, condition_func&& condition,
+                     PhaseParameters params);
+
+/*!
+ * \brief Calculate the asymptotic phases of all points of the grid in
+ * parallel with IsochronPhase.
+ *
+ * Every thread uses its own copy of the system, see FindPhases.
+ *
+ * @returns The phases in the order of the points, -1 if it did not converge.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+std::vector<double> CalculateIsochrons(const IsochronGrid<state_type>& grid,
+                                       double period,
+                                       const system_type& system,
+                                       const condition_func& condition,
+                                       PhaseParameters params,
+                                       ThreadPool& pool);
+
+/*!
+ * \brief Same as above with a new pool of number_threads threads, 0 uses all
+ * hardware threads.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+std::vector<double> CalculateIsochrons(const IsochronGrid<state_type>& grid,
+                                       double period,
+                                       const system_type& system,
+                                       const condition_func& condition,
+                                       PhaseParameters params,
+                                       unsigned int number_threads = 0);
+
+/*!
+ * \brief Save the phases of a grid as a dense .npy array with the shape of
+ * the grid, see WriteNpy.
+ */
+template<typename state_type>
+void SaveIsochrons(const std::string& filename,
+                   const IsochronGrid<state_type>& grid,
+                   const std::vector<double>& phases);
+
+// Implementation
+
+template<typename state_type>
+IsochronGrid<state_type>::IsochronGrid(
+    const state_type& base, const std::vector<size_t>& indices,
+    const std::vector<double>& minimum, const std::vector<double>& maximum,
+    const std::vector<unsigned int>& number_points)
+    : base_(base), indices_(indices), minimum_(minimum),
+      number_points_(number_points) {
+  if (indices_.size() != 2 && indices_.size() != 3) {
+    throw std::invalid_argument("An isochron grid needs 2 or 3 "
+                                "coordinates.");
+  }
+  if (minimum_.size() != indices_.size() || maximum.size() != indices_.size()
+      || number_points_.size() != indices_.size()) {
+    throw std::invalid_argument("The grid needs a range and a number of "
+                                "points for every coordinate.");
+  }
+  for (size_t a = 0; a < indices_.size(); ++a) {
+    if (indices_[a] >= static_cast<size_t>(base_.size())
+        || number_points_[a] == 0) {
+      throw std::invalid_argument("The coordinates of the grid have to be in "
+                                  "the state and have points.");
+    }
+    step_.push_back(number_points_[a] == 1 ? 0.
+        : (maximum[a] - minimum_[a])/(number_points_[a] - 1));
+  }
+}
+
+template<typename state_type>
+size_t IsochronGrid<state_type>::size() const {
+  size_t size = 1;
+  for (unsigned int n : number_points_) size *= n;
+  return size;
+}
+
+template<typename state_type>
+std::vector<size_t> IsochronGrid<state_type>::GetShape() const {
+  return std::vector<size_t>(number_points_.begin(), number_points_.end());
+}
+
+template<typename state_type>
+void IsochronGrid<state_type>::GetPoint(size_t i, state_type& x) const {
+  x = base_;
+  for (size_t a = indices_.size(); a-- > 0;) {
+    const size_t j = i % number_points_[a];
+    i /= number_points_[a];
+    x[indices_[a]] = minimum_[a] + static_cast<double>(j)*step_[a];
+  }
+}
+
+template<typename state_type>
+const state_type& IsochronGrid<state_type>::GetBase() const {
+  return base_;
+}
+
+template <typename system_type, typename condition_func, typename state_type>
+double IsochronPhase(system_type& system, const state_type& position,
+                     double period, condition_func&& condition,
+                     PhaseParameters params) {
+  const double dt = period/static_cast<double>(params.phase_steps_per_period);
+  const size_t indx = system.GetDimension().second*params.n_osc
+                      + params.dimension;
+  system.SetTime(0.);
+  system.SetPosition(position);
+  auto x = system.GetPositionView();
+  HenonRefiner<system_type, state_type> refiner(system, params);
+  state_type state = position;
+  state_type crossing = position;
+  const size_t max_steps = static_cast<size_t>(params.phase_max_iter)
+                           *params.phase_steps_per_period;
+  size_t steps = 0;
+  unsigned int number_estimates = 0;
+  double previous_phase = 0., previous_difference = 0.;
+  while (true) {
+    double previous;
+    do {
+      if (steps++ == max_steps) {
+        return -1;
+      }
+      previous = x[indx];
+      system.Integrate(dt, 1);
+    } while (std::copysign(1., previous - params.target)
+             == std::copysign(1., x[indx] - params.target)
+             || !condition(system.GetPosition()));
+    for (size_t i = 0; i < state.size(); ++i) state[i] = x[i];
+    const double cycles = refiner.Refine(state, system.GetTime(), crossing)
+                          /period;
+    const double phase = 2*M_PI*(std::ceil(cycles) - cycles);
+    const double difference = std::remainder(phase - previous_phase,
+                                             2*M_PI);
+    ++number_estimates;
+    if (number_estimates >= 3) {
+      // below the noise of the crossing times the ratio is meaningless
+      if (std::fabs(difference) < 1e-3*params.phase_tolerance) {
+        return phase;
+      }
+      const double ratio = difference/previous_difference;
+      const double rho = std::fabs(ratio);
+      if (rho < 1.
+          && std::fabs(difference)*rho/(1. - rho) < params.phase_tolerance) {
+        const double extrapolated = phase + difference*ratio/(1. - ratio);
+        return extrapolated - 2*M_PI*std::floor(extrapolated/(2*M_PI));
+      }
+    }
+    previous_phase = phase;
+    previous_difference = difference;
+  }
+}
+
+template <typename system_type, typename condition_func, typename state_type>
+std::vector<double> CalculateIsochrons(const IsochronGrid<state_type>& grid,
+                                       double period,
+                                       const system_type& system,
+                                       const condition_func& condition,
+                                       PhaseParameters params,
+                                       ThreadPool& pool) {
+  std::vector<double> phases(grid.size());
+  ParallelForWithCopy(pool, grid.size(), system,
+                      [&](system_type& copy, size_t i) {
+    state_type point;
+    grid.GetPoint(i, point);
+    phases[i] = IsochronPhase(copy, point, period, condition, params);
+  });
+  return phases;
+}
+
+template <typename system_type, typename condition_func, typename state_type>
+std::vector<double> CalculateIsochrons(const IsochronGrid<state_type>& grid,
+                                       double period,
+                                       const system_type& system,
+                                       const condition_func& condition,
+                                       PhaseParameters params,
+                                       unsigned int number_threads) {
+  ThreadPool pool(number_threads);
+  return CalculateIsochrons<system_type, condition_func, state_type>(
+      grid, period, system, condition, params, pool);
+}
+
+template<typename state_type>
+void SaveIsochrons(const std::string& filename,
+                   const IsochronGrid<state_type>& grid,
+                   const std::vector<double>& phases) {
+  WriteNpy(filename, phases, grid.GetShape());
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_ANALYSIS_ISOCHRONS_HPP_
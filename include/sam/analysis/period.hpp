@@ -3,9 +3,14 @@
 #ifndef INCLUDE_SAM_ANALYSIS_PERIOD_HPP_
 #define INCLUDE_SAM_ANALYSIS_PERIOD_HPP_
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
+#include "../helper/state_traits.hpp"
 #include "./henon.hpp"
 
 namespace sam {
@@ -15,22 +20,268 @@ struct PeriodParameters : CrossingParameters {
   unsigned int period_max_iter = 100;
 };
 
+/*!
+ * \brief Parameters for EstimatePeriod.
+ */
+struct PeriodEstimateParameters : CrossingParameters {
+  //! The largest number of the last crossings that are fitted.
+  unsigned int window = 20;
+  //! The largest standard error of the period for convergence.
+  double tolerance = 1e-6;
+  //! The maximal number of crossings.
+  unsigned int max_crossings = 1000;
+  //! The largest number of crossings per period that is tested.
+  unsigned int max_multiplicity = 4;
+};
+
+/*!
+ * \brief The kind of motion that is found by EstimatePeriod.
+ */
+enum class PeriodType {
+  //! The period did not converge within the maximal number of crossings.
+  kNotConverged,
+  //! The motion is periodic, it may cross the section several times per
+  //! period, e.g. after a period doubling.
+  kPeriodic,
+  //! The return times neither converge nor relax, e.g. for a quasi-periodic
+  //! or chaotic motion.
+  kQuasiPeriodic
+};
+
+/*!
+ * \brief A least-squares fit of the period to crossing times.
+ */
+struct PeriodFit {
+  double period;
+  //! The standard error of the period.
+  double uncertainty;
+  //! The change of the period per period.
+  double drift;
+};
+
+/*!
+ * \brief The result of EstimatePeriod.
+ */
+struct PeriodEstimate {
+  PeriodType type = PeriodType::kNotConverged;
+  //! The period, for quasi-periodic motion the mean return time, -1 if it
+  //! did not converge.
+  double period = -1.;
+  //! The standard error of the period.
+  double uncertainty = std::numeric_limits<double>::infinity();
+  //! The change of the period per period in the fitted crossings.
+  double drift = 0.;
+  //! The number of crossings per period, 2 after a period doubling.
+  unsigned int multiplicity = 1;
+  //! The times of all crossings.
+  std::vector<double> crossing_times;
+};
+
+/*!
+ * \brief Return the difference of two successive crossing times, as soon as
+ * it changes by less than params.period_precision.
+ *
+ * @returns The period or -1 if it did not converge within
+ *          params.period_max_iter crossings.
+ */
 template <typename system_type, typename condition_func,
           typename state_type = std::vector<double>>
+double CalculatePeriod(system_type& system, double dt,
+                       condition_func&& condition, PeriodParameters params);
+
+/*!
+ * \brief Fit the period to n crossing times with multiplicity crossings per
+ * period.
+ *
+ * The crossings r, r + multiplicity, r + 2 multiplicity, ... lie on lines
+ * with the same slope, the period, and a separate offset for every r. The
+ * drift is the slope of the intervals between crossings that are one period
+ * apart.
+ */
+inline PeriodFit FitPeriod(const double* times, size_t n,
+                           unsigned int multiplicity);
+
+/*!
+ * \brief Estimate the period from many crossings of one integration.
+ *
+ * The system is integrated from crossing to crossing like
+ * IntegrateToCrossingConditional, all crossings are refined with the same
+ * HenonRefiner. From 3 params.max_multiplicity crossings on, the last
+ * crossing times, at most params.window, are fitted after every crossing
+ * with FitPeriod for 1 to params.max_multiplicity crossings per period. The
+ * integration stops at the first multiplicity, whose standard error is
+ * smaller than params.tolerance, so the transient is only as long as needed.
+ * A state on the limit cycle needs only 3 params.max_multiplicity crossings.
+ * Period doublings are detected. If the period does not converge within
+ * params.max_crossings crossings, the fit of the last window is compared
+ * with the one of the window in the middle of the integration. The
+ * motion is still relaxing to a limit cycle, if the error has dropped by more
+ * than an order of magnitude, otherwise it is quasi-periodic or chaotic.
+ *
+ * @param system The system, it is integrated to the last crossing.
+ * @param dt The timestep.
+ * @param condition A boolean function of the state at a crossing, only
+ *        crossings where it is true are counted.
+ * @param params The parameters of the section and the estimation.
+ *
+ * @throws std::invalid_argument If params.window is smaller than
+ *         3 params.max_multiplicity or params.max_crossings is smaller than
+ *         2 params.window.
+ * @throws NoCrossingError If there is no crossing within params.max_iter
+ *         steps.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+PeriodEstimate EstimatePeriod(system_type& system, double dt,
+                              condition_func&& condition,
+                              PeriodEstimateParameters params);
+
+// Implementation
+
+template <typename system_type, typename condition_func, typename state_type>
 double CalculatePeriod(system_type& system, double dt,
                        condition_func&& condition, PeriodParameters params) {
-  double t_prev;
+  double t_prev = IntegrateToCrossingConditional(system, dt, condition,
+                                                 params).first;
   double t_current = IntegrateToCrossingConditional(system, dt, condition,
                                                     params).first;
-  unsigned int n_iter = 0;
-  do {
+  double period = t_current - t_prev;
+  for (unsigned int n_iter = 0; n_iter < params.period_max_iter; ++n_iter) {
     t_prev = t_current;
     t_current = IntegrateToCrossingConditional(system, dt, condition,
                                                params).first;
-    ++n_iter;
-  } while (std::fabs(t_current - t_prev) < params.period_precision
-           && n_iter < params.period_max_iter);
-  return n_iter == params.period_max_iter ? -1 : t_current - t_prev;
+    const double previous_period = period;
+    period = t_current - t_prev;
+    if (std::fabs(period - previous_period) < params.period_precision) {
+      return period;
+    }
+  }
+  return -1;
+}
+
+inline PeriodFit FitPeriod(const double* times, size_t n,
+                           unsigned int multiplicity) {
+  // regression of the time on the number of the period with one offset for
+  // every residue r
+  double sxx = 0., sxy = 0.;
+  for (size_t r = 0; r < multiplicity && r < n; ++r) {
+    const size_t count = (n - r + multiplicity - 1)/multiplicity;
+    const double mean_i = 0.5*static_cast<double>(count - 1);
+    double mean_t = 0.;
+    for (size_t i = 0; i < count; ++i) mean_t += times[r + i*multiplicity];
+    mean_t /= static_cast<double>(count);
+    for (size_t i = 0; i < count; ++i) {
+      const double di = static_cast<double>(i) - mean_i;
+      sxx += di*di;
+      sxy += di*(times[r + i*multiplicity] - mean_t);
+    }
+  }
+  PeriodFit fit;
+  fit.period = sxx > 0. ? sxy/sxx : 0.;
+
+  double ssr = 0.;
+  for (size_t r = 0; r < multiplicity && r < n; ++r) {
+    const size_t count = (n - r + multiplicity - 1)/multiplicity;
+    const double mean_i = 0.5*static_cast<double>(count - 1);
+    double mean_t = 0.;
+    for (size_t i = 0; i < count; ++i) mean_t += times[r + i*multiplicity];
+    mean_t /= static_cast<double>(count);
+    for (size_t i = 0; i < count; ++i) {
+      const double residual = times[r + i*multiplicity] - mean_t
+          - fit.period*(static_cast<double>(i) - mean_i);
+      ssr += residual*residual;
+    }
+  }
+  const double dof = static_cast<double>(n) - multiplicity - 1.;
+  fit.uncertainty = dof > 0. && sxx > 0. ? std::sqrt(ssr/dof/sxx)
+      : std::numeric_limits<double>::infinity();
+
+  // the slope of the intervals of one period over the crossings
+  fit.drift = 0.;
+  if (n > multiplicity + 1) {
+    const size_t count = n - multiplicity;
+    const double mean_k = 0.5*static_cast<double>(count - 1);
+    double mean_interval = 0.;
+    for (size_t k = 0; k < count; ++k) {
+      mean_interval += times[k + multiplicity] - times[k];
+    }
+    mean_interval /= static_cast<double>(count);
+    double skk = 0., ski = 0.;
+    for (size_t k = 0; k < count; ++k) {
+      const double dk = static_cast<double>(k) - mean_k;
+      skk += dk*dk;
+      ski += dk*(times[k + multiplicity] - times[k] - mean_interval);
+    }
+    fit.drift = ski/skk*multiplicity;
+  }
+  return fit;
+}
+
+template <typename system_type, typename condition_func, typename state_type>
+PeriodEstimate EstimatePeriod(system_type& system, double dt,
+                              condition_func&& condition,
+                              PeriodEstimateParameters params) {
+  if (params.max_multiplicity == 0
+      || params.window < 3*params.max_multiplicity
+      || params.max_crossings < 2*params.window) {
+    throw std::invalid_argument("The window has to fit three crossings of "
+                                "every multiplicity and the maximal number "
+                                "of crossings two windows.");
+  }
+  const size_t indx = system.GetDimension().second*params.n_osc
+                      + params.dimension;
+  HenonRefiner<system_type, state_type> refiner(system, params);
+  state_type x = system.GetPosition();
+  state_type crossing = x;
+  auto position = system.GetPositionView();
+
+  PeriodEstimate estimate;
+  std::vector<double>& times = estimate.crossing_times;
+  times.reserve(params.max_crossings);
+  while (times.size() < params.max_crossings) {
+    double previous;
+    unsigned int steps = 0;
+    do {
+      if (steps++ == params.max_iter) {
+        throw NoCrossingError();
+      }
+      previous = position[indx];
+      system.Integrate(dt, 1);
+    } while (std::copysign(1., previous - params.target)
+             == std::copysign(1., position[indx] - params.target)
+             || !condition(system.GetPosition()));
+    for (size_t i = 0; i < x.size(); ++i) x[i] = position[i];
+    times.push_back(refiner.Refine(x, system.GetTime(), crossing));
+
+    if (times.size() < 3*params.max_multiplicity) {
+      continue;
+    }
+    const size_t n = std::min<size_t>(times.size(), params.window);
+    const double* window = times.data() + times.size() - n;
+    for (unsigned int m = 1; m <= params.max_multiplicity; ++m) {
+      const PeriodFit fit = FitPeriod(window, n, m);
+      if (fit.uncertainty < params.tolerance) {
+        estimate.type = PeriodType::kPeriodic;
+        estimate.period = fit.period;
+        estimate.uncertainty = fit.uncertainty;
+        estimate.drift = fit.drift;
+        estimate.multiplicity = m;
+        return estimate;
+      }
+    }
+  }
+
+  const PeriodFit late = FitPeriod(times.data() + times.size()
+                                   - params.window, params.window, 1);
+  const PeriodFit early = FitPeriod(times.data() + times.size()/2
+                                    - params.window, params.window, 1);
+  estimate.uncertainty = late.uncertainty;
+  estimate.drift = late.drift;
+  if (10.*late.uncertainty >= early.uncertainty) {
+    estimate.type = PeriodType::kQuasiPeriodic;
+    estimate.period = late.period;
+  }
+  return estimate;
 }
 
 }  // namespace sam
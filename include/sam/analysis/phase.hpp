@@ -3,10 +3,14 @@
 #ifndef INCLUDE_SAM_ANALYSIS_PHASE_HPP_
 #define INCLUDE_SAM_ANALYSIS_PHASE_HPP_
 
+#include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <utility>
 #include <vector>
 
+#include "../helper/state_traits.hpp"
+#include "../helper/thread_pool.hpp"
 #include "./henon.hpp"
 
 namespace sam {
@@ -18,19 +22,53 @@ struct PhaseParameters : CrossingParameters {
 };
 
 template <typename system_type, typename condition_func,
-          typename state_type = std::vector<double>>
+          typename state_type = system_state_type<system_type>>
 double PhaseOnLimitCycle(system_type system, double period, double dt,
                          condition_func&& condition, CrossingParameters params);
 
 template <typename system_type, typename condition_func,
-          typename state_type = std::vector<double>>
+          typename state_type = system_state_type<system_type>>
 double FindPhase(const state_type& position, double period,
                  system_type unperturbed_system, condition_func&& condition,
                  PhaseParameters params);
 
+/*!
+ * \brief Find the asymptotic phases of many states in parallel, e.g. for a
+ * phase response curve or an isochron map.
+ *
+ * The same as calling FindPhase for every position, but the positions are
+ * distributed over the threads of the pool. Every thread copies the
+ * unperturbed system once and reuses it for all of its positions, so only
+ * one copy per thread is made instead of two per position. The condition is
+ * called from several threads at the same time, so it must not change any
+ * shared state.
+ *
+ * @returns The phases in the order of the positions, -1 for positions that
+ *          did not relax onto the limit cycle.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+std::vector<double> FindPhases(const std::vector<state_type>& positions,
+                               double period,
+                               const system_type& unperturbed_system,
+                               const condition_func& condition,
+                               PhaseParameters params, ThreadPool& pool);
+
+/*!
+ * \brief Same as above with a new pool of number_threads threads, 0 uses all
+ * hardware threads.
+ */
+template <typename system_type, typename condition_func,
+          typename state_type = system_state_type<system_type>>
+std::vector<double> FindPhases(const std::vector<state_type>& positions,
+                               double period,
+                               const system_type& unperturbed_system,
+                               const condition_func& condition,
+                               PhaseParameters params,
+                               unsigned int number_threads = 0);
 
 template <typename system_type, typename condition_func,
-          typename state_type = std::vector<double>>
+          typename state_type = system_state_type<system_type>>
 std::pair<double, double> FindLinearizedPhaseFrequency(const state_type& state,
     double period, system_type linearized_system, condition_func&& condition,
     PhaseParameters params);
@@ -54,46 +92,112 @@ bool RelaxOntoLimitCycle(system_type& system, double period,
                          PhaseParameters params,
                          std::vector<size_t> pos_indx = std::vector<size_t>()) {
   double dt = period / static_cast<double>(params.phase_steps_per_period);
+  // the view follows the integration, so no state is copied per period
+  auto position = system.GetPositionView();
   if (pos_indx.size() == 0) {
-    for (size_t i = 0; i < system.GetPosition().size(); ++i) {
+    for (size_t i = 0; i < position.size(); ++i) {
       pos_indx.push_back(i);
     }
   }
-  state_type pos_previous;
+  std::vector<double> pos_previous(pos_indx.size());
   double error;
   unsigned int iter = 0;
   do {
     error = 0;
-    pos_previous = system.GetPosition();
+    for (size_t i = 0; i < pos_indx.size(); ++i) {
+      pos_previous[i] = position[pos_indx[i]];
+    }
     system.Integrate(dt, params.phase_steps_per_period);
-    state_type position = system.GetPosition();
-    for (auto it = pos_indx.begin(); it != pos_indx.end(); ++it) {
-      error += std::fabs(pos_previous[*it] - position[*it]);
+    for (size_t i = 0; i < pos_indx.size(); ++i) {
+      error += std::fabs(pos_previous[i] - position[pos_indx[i]]);
     }
     ++iter;
   } while (error > params.phase_tolerance && iter < params.phase_max_iter);
   return iter != params.phase_max_iter;
 }
 
+// Call task(system, i) for all i in [0, number_tasks), where system is a
+// copy of prototype that is made once per thread. There is one pool task per
+// thread and the indices are handed out dynamically, because e.g. the
+// relaxation takes longer far from the limit cycle.
+template <typename system_type, typename task_type>
+void ParallelForWithCopy(ThreadPool& pool, size_t number_tasks,
+                         const system_type& prototype, task_type&& task) {
+  std::atomic<size_t> next_task(0);
+  pool.ParallelFor(pool.GetNumberThreads(), [&](size_t) {
+    size_t i = next_task++;
+    if (i >= number_tasks) {
+      return;
+    }
+    system_type system(prototype);
+    do {
+      task(system, i);
+    } while ((i = next_task++) < number_tasks);
+  });
+}
+
+// Find the phase of position with system, which is changed, so it can be
+// reused for the next position without a copy.
 template <typename system_type, typename condition_func,
-          typename state_type = std::vector<double>>
-double FindPhase(const state_type& position, double period,
-                 system_type unperturbed_system, condition_func&& condition,
-                 PhaseParameters params) {
+          typename state_type>
+double FindPhaseWith(system_type& system, const state_type& position,
+                     double period, condition_func&& condition,
+                     PhaseParameters params) {
   double dt = period / static_cast<double>(params.phase_steps_per_period);
-  unperturbed_system.SetTime(0.);
-  unperturbed_system.SetPosition(position);
+  system.SetTime(0.);
+  system.SetPosition(position);
   bool relaxed = RelaxOntoLimitCycle<system_type, state_type>(
-    unperturbed_system, period, params);
+    system, period, params);
   if (!relaxed) {
     return -1;
   }
-  return PhaseOnLimitCycle(unperturbed_system, period, dt,
-                           condition, params);
+  // same as PhaseOnLimitCycle without copying the system
+  system.SetTime(0.);
+  double delta_t = IntegrateToCrossingConditional(system, dt, condition,
+                                                  params).first;
+  return 2*M_PI*(period - delta_t)/period;
+}
+
+template <typename system_type, typename condition_func,
+          typename state_type>
+double FindPhase(const state_type& position, double period,
+                 system_type unperturbed_system, condition_func&& condition,
+                 PhaseParameters params) {
+  return FindPhaseWith(unperturbed_system, position, period, condition,
+                       params);
+}
+
+template <typename system_type, typename condition_func,
+          typename state_type>
+std::vector<double> FindPhases(const std::vector<state_type>& positions,
+                               double period,
+                               const system_type& unperturbed_system,
+                               const condition_func& condition,
+                               PhaseParameters params, ThreadPool& pool) {
+  std::vector<double> phases(positions.size());
+  ParallelForWithCopy(pool, positions.size(), unperturbed_system,
+                      [&](system_type& system, size_t i) {
+    phases[i] = FindPhaseWith(system, positions[i], period, condition,
+                              params);
+  });
+  return phases;
+}
+
+template <typename system_type, typename condition_func,
+          typename state_type>
+std::vector<double> FindPhases(const std::vector<state_type>& positions,
+                               double period,
+                               const system_type& unperturbed_system,
+                               const condition_func& condition,
+                               PhaseParameters params,
+                               unsigned int number_threads) {
+  ThreadPool pool(number_threads);
+  return FindPhases<system_type, condition_func, state_type>(
+      positions, period, unperturbed_system, condition, params, pool);
 }
 
 template <typename system_type, typename condition_func,
-          typename state_type = std::vector<double>>
+          typename state_type>
 std::pair<double, double> FindLinearizedPhaseFrequency(const state_type& state,
     double period, system_type linearized_system, condition_func&& condition,
     PhaseParameters params) {
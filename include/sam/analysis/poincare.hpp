@@ -0,0 +1,205 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_ANALYSIS_POINCARE_HPP_
+#define INCLUDE_SAM_ANALYSIS_POINCARE_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../helper/binary_trajectory.hpp"
+#include "../helper/state_traits.hpp"
+#include "./events.hpp"
+#include "./henon.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Records all crossings of a Poincare section during an integration.
+ *
+ * The section is the value params.target of one coordinate like for
+ * IntegrateToCrossing. The states are passed by a PoincareObserver during
+ * the integration, so a whole return map is recorded in one call of
+ * Integrate instead of restarting at every crossing. Every crossing is
+ * refined with one HenonRefiner, that is created once for the whole run.
+ * The crossings are stored in buffers that are preallocated for capacity
+ * crossings, so nothing is allocated per crossing until they are full. With
+ * a BinaryTrajectoryWriter the crossings are streamed into a binary file
+ * instead and no buffers are allocated, which is the choice for large
+ * systems.
+ */
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
+class PoincareSection {
+ public:
+  /*!
+   * @param system The system that is integrated, its ODE is used for the
+   *        refinement, so it has to outlive the section.
+   * @param params The coordinate and the value of the section.
+   * @param direction The direction of the crossings that are recorded.
+   * @param capacity The number of crossings the buffers are preallocated
+   *        for, every one is a copy of the state.
+   */
+  PoincareSection(const system_type& system, CrossingParameters params,
+                  EventDirection direction = EventDirection::kBoth,
+                  size_t capacity = 1024);
+
+  /*!
+   * \brief Write the crossings into a file, no buffers are allocated.
+   */
+  PoincareSection(const system_type& system, CrossingParameters params,
+                  std::shared_ptr<BinaryTrajectoryWriter> writer,
+                  EventDirection direction = EventDirection::kBoth);
+
+  /*!
+   * \brief Write the crossings into a file instead of the buffers.
+   *
+   * The buffers and the crossings recorded in them are released. Pass the
+   * writer to the constructor, so they are not allocated at all.
+   */
+  void SetWriter(std::shared_ptr<BinaryTrajectoryWriter> writer);
+
+  /*!
+   * \brief Check the step from the previous to the state x at time t for a
+   * crossing and record it.
+   */
+  void Observe(const state_type& x, double t);
+
+  /*!
+   * \brief Return the number of recorded crossings in the buffers.
+   */
+  size_t size() const;
+
+  /*!
+   * \brief Return the time of the i-th recorded crossing.
+   *
+   * @throws std::out_of_range If there are not more than i crossings.
+   */
+  double GetTime(size_t i) const;
+
+  /*!
+   * \brief Return the state of the i-th recorded crossing.
+   *
+   * @throws std::out_of_range If there are not more than i crossings.
+   */
+  const state_type& GetState(size_t i) const;
+
+  /*!
+   * \brief Remove the crossings and forget the previous state, so the next
+   * integration can start anywhere.
+   */
+  void Clear();
+
+ private:
+  size_t indx_;
+  double target_;
+  EventDirection direction_;
+  HenonRefiner<system_type, state_type> refiner_;
+  std::shared_ptr<BinaryTrajectoryWriter> writer_;
+  bool has_previous_;
+  double previous_;
+  size_t size_;
+  std::vector<double> times_;
+  std::vector<state_type> states_;
+  state_type crossing_;
+};
+
+// Implementation
+
+template<typename system_type, typename state_type>
+PoincareSection<system_type, state_type>::PoincareSection(
+    const system_type& system, CrossingParameters params,
+    EventDirection direction, size_t capacity)
+    : indx_(system.GetDimension().second*params.n_osc + params.dimension),
+      target_(params.target), direction_(direction), refiner_(system, params),
+      has_previous_(false), previous_(0.), size_(0), times_(capacity),
+      states_(capacity, system.GetPosition()),
+      crossing_(system.GetPosition()) {}
+
+template<typename system_type, typename state_type>
+PoincareSection<system_type, state_type>::PoincareSection(
+    const system_type& system, CrossingParameters params,
+    std::shared_ptr<BinaryTrajectoryWriter> writer, EventDirection direction)
+    : indx_(system.GetDimension().second*params.n_osc + params.dimension),
+      target_(params.target), direction_(direction), refiner_(system, params),
+      writer_(writer), has_previous_(false), previous_(0.), size_(0),
+      crossing_(system.GetPosition()) {}
+
+template<typename system_type, typename state_type>
+void PoincareSection<system_type, state_type>::SetWriter(
+    std::shared_ptr<BinaryTrajectoryWriter> writer) {
+  writer_ = writer;
+  if (writer_) {
+    size_ = 0;
+    std::vector<double>().swap(times_);
+    std::vector<state_type>().swap(states_);
+  }
+}
+
+template<typename system_type, typename state_type>
+void PoincareSection<system_type, state_type>::Observe(const state_type& x,
+                                                      double t) {
+  const double previous = previous_;
+  const bool has_previous = has_previous_;
+  previous_ = x[indx_];
+  has_previous_ = true;
+  if (!has_previous || std::copysign(1., previous - target_)
+                       == std::copysign(1., x[indx_] - target_)) {
+    return;
+  }
+  const bool rising = previous < target_;
+  if ((rising && direction_ == EventDirection::kFalling)
+      || (!rising && direction_ == EventDirection::kRising)) {
+    return;
+  }
+  const double t_crossing = refiner_.Refine(x, t, crossing_);
+  if (writer_) {
+    writer_->Write(crossing_, t_crossing);
+    return;
+  }
+  // only more crossings than the capacity are allocated
+  if (size_ == times_.size()) {
+    times_.push_back(t_crossing);
+    states_.push_back(crossing_);
+  } else {
+    times_[size_] = t_crossing;
+    states_[size_] = crossing_;
+  }
+  ++size_;
+}
+
+template<typename system_type, typename state_type>
+size_t PoincareSection<system_type, state_type>::size() const {
+  return size_;
+}
+
+template<typename system_type, typename state_type>
+double PoincareSection<system_type, state_type>::GetTime(size_t i) const {
+  if (i >= size_) {
+    throw std::out_of_range("The Poincare section has no crossing with this "
+                            "index.");
+  }
+  return times_[i];
+}
+
+template<typename system_type, typename state_type>
+const state_type& PoincareSection<system_type, state_type>::GetState(
+    size_t i) const {
+  if (i >= size_) {
+    throw std::out_of_range("The Poincare section has no crossing with this "
+                            "index.");
+  }
+  return states_[i];
+}
+
+template<typename system_type, typename state_type>
+void PoincareSection<system_type, state_type>::Clear() {
+  size_ = 0;
+  has_previous_ = false;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_ANALYSIS_POINCARE_HPP_
@@ -5,6 +5,7 @@
 
 #include <Eigen/Dense>
 
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 
@@ -26,7 +27,7 @@ Eigen::MatrixXd CalculateConvolutionCoefficients(unsigned int n_points,
   for (unsigned int i = 0; i < n_points; ++i) {
     double z = static_cast<int>(i) - static_cast<int>(n_left);
     for (unsigned int j = 0; j < derivatives; ++j) {
-      J(i, j) = pow(z, j);
+      J(i, j) = std::pow(z, j);
     }
   }
   return (J.transpose()*J).inverse()*J.transpose();
@@ -61,7 +62,7 @@ std::vector<std::vector<double>> SavitzkyGolayFilter(double stepsize,
            i <= static_cast<int>(n_points)/2; ++i) {
         sum += coefficients(deriv, i + n_points/2)*state[point + i];
       }
-      sum *= factorial(deriv)/pow(stepsize, deriv);
+      sum *= factorial(deriv)/std::pow(stepsize, deriv);
       a[deriv].push_back(sum);
     }
   }
@@ -0,0 +1,473 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_BINARY_TRAJECTORY_HPP_
+#define INCLUDE_SAM_HELPER_BINARY_TRAJECTORY_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "./state_view.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Header at the beginning of a binary trajectory file.
+ *
+ * It is followed by number_nodes node sizes as uint64_t and then by the
+ * records. Every record consists of the time and the flattened state, all as
+ * doubles in the byte order of the machine.
+ */
+struct TrajectoryHeader {
+  char magic[8];
+  uint64_t version;
+  uint64_t number_oscillators;
+  uint64_t dimension;
+  uint64_t number_nodes;
+  uint64_t number_records;
+  double dt;
+};
+
+//! Identifies binary trajectory files.
+constexpr char kTrajectoryMagic[8] = {'S', 'A', 'M', 'T', 'R', 'A', 'J',
+                                      '\0'};
+constexpr uint64_t kTrajectoryVersion = 1;
+
+/*!
+ * \brief Stream a trajectory into a memory-mapped binary file.
+ *
+ * The records are collected in one of two buffers, while a background
+ * thread copies the other, full buffer into the mapped file, so the
+ * integration only waits for the disk if it is faster than the flush. The
+ * file is preallocated for a number of records and grows by doubling if more
+ * are written, so the memory needed is independent of the length of the
+ * trajectory. The number of records in the header is updated after every
+ * flush, so a partially written file can be read. The file is truncated to
+ * its content by Close() or the destructor. Only POSIX systems are
+ * supported.
+ */
+class BinaryTrajectoryWriter {
+ public:
+  /*!
+   * @param filename The file to write, it is overwritten.
+   * @param node_sizes The number of oscillators in every node, for a system
+   *  without nodes {N}.
+   * @param dimension The dimension of every oscillator.
+   * @param dt The timestep between the records, it is only stored.
+   * @param capacity The number of records for which the file is
+   *  preallocated.
+   * @param buffer_records The number of records in each of the two buffers.
+   *
+   * @throws std::system_error If the file cannot be created or mapped.
+   */
+  BinaryTrajectoryWriter(const std::string& filename,
+                         const std::vector<unsigned int>& node_sizes,
+                         unsigned int dimension, double dt,
+                         size_t capacity = 1024, size_t buffer_records = 256);
+
+  BinaryTrajectoryWriter(const BinaryTrajectoryWriter&) = delete;
+  BinaryTrajectoryWriter& operator=(const BinaryTrajectoryWriter&) = delete;
+
+  ~BinaryTrajectoryWriter();
+
+  /*!
+   * \brief Append the state x at time t.
+   *
+   * @throws std::length_error If the state has the wrong size.
+   * @throws std::system_error If the background flush failed. The writer
+   *  is then failed and every later write throws the same error.
+   */
+  template<typename state_type>
+  void Write(const state_type& x, double t);
+
+  /*!
+   * \brief Write all buffered records, stop the background thread and close
+   * the file. Later writes throw.
+   */
+  void Close();
+
+  /*!
+   * \brief Return the number of records written so far.
+   */
+  size_t GetNumberRecords() const;
+
+ private:
+  int file_;
+  size_t state_size_;
+  size_t record_size_;
+  size_t data_offset_;
+  size_t capacity_;
+  size_t buffer_records_;
+  size_t number_records_;
+  char* map_;
+  size_t map_size_;
+  bool closed_;
+
+  // front_ is filled by Write, back_ is copied by the background thread
+  std::vector<double> front_, back_;
+  size_t front_count_, back_count_;
+  size_t records_flushed_;
+  // set by Write once the error of the flush was seen, only Write reads it
+  bool failed_;
+  bool flush_pending_;
+  bool stop_;
+  std::exception_ptr exception_;
+  std::mutex mutex_;
+  std::condition_variable flush_requested_;
+  std::condition_variable flush_done_;
+  std::thread flusher_;
+
+  void SubmitFront();
+
+  void FlushLoop();
+
+  void Map(size_t capacity);
+
+  TrajectoryHeader& Header();
+};
+
+/*!
+ * \brief Read a binary trajectory file written by BinaryTrajectoryWriter.
+ *
+ * The file is mapped read-only into memory, so the states are returned as
+ * views into the file without copying and only the parts that are accessed
+ * are loaded from the disk.
+ */
+class BinaryTrajectoryReader {
+ public:
+  /*!
+   * @throws std::system_error If the file cannot be opened or mapped.
+   * @throws std::invalid_argument If it is not a trajectory file.
+   */
+  explicit BinaryTrajectoryReader(const std::string& filename);
+
+  BinaryTrajectoryReader(const BinaryTrajectoryReader&) = delete;
+  BinaryTrajectoryReader& operator=(const BinaryTrajectoryReader&) = delete;
+
+  ~BinaryTrajectoryReader();
+
+  size_t GetNumberRecords() const;
+
+  unsigned int GetNumberOscillators() const;
+
+  unsigned int GetDimension() const;
+
+  std::vector<unsigned int> GetNodeSizes() const;
+
+  double GetTimestep() const;
+
+  /*!
+   * \brief Return the time of record i.
+   */
+  double GetTime(size_t i) const;
+
+  /*!
+   * \brief Return a view of the state of record i, which is valid as long as
+   * the reader exists.
+   */
+  StateView<double> GetState(size_t i) const;
+
+ private:
+  int file_;
+  char* map_;
+  size_t map_size_;
+  const TrajectoryHeader* header_;
+  const uint64_t* node_sizes_;
+  const double* records_;
+  size_t record_size_;
+};
+
+// Implementation
+
+inline BinaryTrajectoryWriter::BinaryTrajectoryWriter(
+    const std::string& filename, const std::vector<unsigned int>& node_sizes,
+    unsigned int dimension, double dt, size_t capacity,
+    size_t buffer_records)
+    : file_(-1), capacity_(0), buffer_records_(std::max<size_t>(
+          buffer_records, 1)), number_records_(0), map_(nullptr),
+      map_size_(0), closed_(false), front_count_(0), back_count_(0),
+      records_flushed_(0), failed_(false), flush_pending_(false),
+      stop_(false) {
+  size_t number_oscillators = 0;
+  for (unsigned int size : node_sizes) number_oscillators += size;
+  state_size_ = number_oscillators*dimension;
+  record_size_ = state_size_ + 1;
+  data_offset_ = sizeof(TrajectoryHeader) + node_sizes.size()*sizeof(uint64_t);
+
+  file_ = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file_ < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create " + filename);
+  }
+  try {
+    Map(std::max<size_t>(capacity, 1));
+  } catch (...) {
+    close(file_);
+    throw;
+  }
+  TrajectoryHeader& header = Header();
+  std::memcpy(header.magic, kTrajectoryMagic, sizeof(header.magic));
+  header.version = kTrajectoryVersion;
+  header.number_oscillators = number_oscillators;
+  header.dimension = dimension;
+  header.number_nodes = node_sizes.size();
+  header.number_records = 0;
+  header.dt = dt;
+  uint64_t* sizes = reinterpret_cast<uint64_t*>(map_
+                                                + sizeof(TrajectoryHeader));
+  for (size_t i = 0; i < node_sizes.size(); ++i) sizes[i] = node_sizes[i];
+
+  front_.resize(buffer_records_*record_size_);
+  back_.resize(buffer_records_*record_size_);
+  flusher_ = std::thread(&BinaryTrajectoryWriter::FlushLoop, this);
+}
+
+inline BinaryTrajectoryWriter::~BinaryTrajectoryWriter() {
+  try {
+    Close();
+  } catch (...) {
+    // a destructor must not throw, call Close() to handle errors
+  }
+}
+
+template<typename state_type>
+void BinaryTrajectoryWriter::Write(const state_type& x, double t) {
+  if (closed_) {
+    throw std::logic_error("The trajectory file is already closed.");
+  }
+  if (failed_) {
+    // the front buffer may still be full, so nothing is written into it
+    std::rethrow_exception(exception_);
+  }
+  if (static_cast<size_t>(x.size()) != state_size_) {
+    throw std::length_error("The state does not match the size of the "
+                            "trajectory.");
+  }
+  double* record = front_.data() + front_count_*record_size_;
+  record[0] = t;
+  for (size_t i = 0; i < state_size_; ++i) {
+    record[i + 1] = x[i];
+  }
+  ++front_count_;
+  ++number_records_;
+  if (front_count_ == buffer_records_) {
+    try {
+      SubmitFront();
+    } catch (...) {
+      failed_ = true;
+      throw;
+    }
+  }
+}
+
+inline void BinaryTrajectoryWriter::Close() {
+  if (closed_) return;
+  closed_ = true;
+  if (front_count_ > 0) {
+    try {
+      SubmitFront();
+    } catch (...) {
+      // the error of the flush is rethrown after the thread is stopped
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  flush_requested_.notify_one();
+  flusher_.join();
+  const size_t file_size = data_offset_ + records_flushed_*record_size_
+                                          *sizeof(double);
+  int error = 0;
+  if (map_ != nullptr) {
+    Header().number_records = records_flushed_;
+    if (msync(map_, map_size_, MS_SYNC) != 0) error = errno;
+    munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+  if (ftruncate(file_, file_size) != 0 && error == 0) error = errno;
+  if (close(file_) != 0 && error == 0) error = errno;
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+  if (error != 0) {
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot write the trajectory file");
+  }
+}
+
+inline size_t BinaryTrajectoryWriter::GetNumberRecords() const {
+  return number_records_;
+}
+
+inline void BinaryTrajectoryWriter::SubmitFront() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  flush_done_.wait(lock, [this]() { return !flush_pending_; });
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+  std::swap(front_, back_);
+  back_count_ = front_count_;
+  front_count_ = 0;
+  flush_pending_ = true;
+  lock.unlock();
+  flush_requested_.notify_one();
+}
+
+inline void BinaryTrajectoryWriter::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    flush_requested_.wait(lock, [this]() { return flush_pending_ || stop_; });
+    if (!flush_pending_) return;
+    lock.unlock();
+    try {
+      // only this thread touches the mapping after the construction
+      const size_t needed = records_flushed_ + back_count_;
+      if (needed > capacity_) {
+        Map(std::max(needed, 2*capacity_));
+      }
+      std::memcpy(map_ + data_offset_ + records_flushed_*record_size_
+                                        *sizeof(double),
+                  back_.data(), back_count_*record_size_*sizeof(double));
+      Header().number_records = needed;
+      records_flushed_ = needed;
+    } catch (...) {
+      lock.lock();
+      exception_ = std::current_exception();
+      flush_pending_ = false;
+      flush_done_.notify_all();
+      return;
+    }
+    lock.lock();
+    flush_pending_ = false;
+    flush_done_.notify_all();
+  }
+}
+
+inline void BinaryTrajectoryWriter::Map(size_t capacity) {
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+  const size_t size = data_offset_ + capacity*record_size_*sizeof(double);
+  if (ftruncate(file_, size) != 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot resize the trajectory file");
+  }
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_,
+                   0);
+  if (map == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot map the trajectory file");
+  }
+  map_ = static_cast<char*>(map);
+  map_size_ = size;
+  capacity_ = capacity;
+}
+
+inline TrajectoryHeader& BinaryTrajectoryWriter::Header() {
+  return *reinterpret_cast<TrajectoryHeader*>(map_);
+}
+
+inline BinaryTrajectoryReader::BinaryTrajectoryReader(
+    const std::string& filename) : map_(nullptr), map_size_(0) {
+  file_ = open(filename.c_str(), O_RDONLY);
+  if (file_ < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot open " + filename);
+  }
+  struct stat status;
+  if (fstat(file_, &status) != 0) {
+    int error = errno;
+    close(file_);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot read " + filename);
+  }
+  map_size_ = status.st_size;
+  if (map_size_ < sizeof(TrajectoryHeader)) {
+    close(file_);
+    throw std::invalid_argument(filename + " is not a trajectory file.");
+  }
+  void* map = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, file_, 0);
+  if (map == MAP_FAILED) {
+    int error = errno;
+    close(file_);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot map " + filename);
+  }
+  map_ = static_cast<char*>(map);
+  header_ = reinterpret_cast<const TrajectoryHeader*>(map_);
+  record_size_ = header_->number_oscillators*header_->dimension + 1;
+  const size_t data_offset = sizeof(TrajectoryHeader)
+                             + header_->number_nodes*sizeof(uint64_t);
+  if (std::memcmp(header_->magic, kTrajectoryMagic, sizeof(header_->magic))
+      != 0 || header_->version != kTrajectoryVersion
+      || data_offset + header_->number_records*record_size_*sizeof(double)
+         > map_size_) {
+    munmap(map_, map_size_);
+    close(file_);
+    throw std::invalid_argument(filename + " is not a trajectory file.");
+  }
+  node_sizes_ = reinterpret_cast<const uint64_t*>(map_
+                                                  + sizeof(TrajectoryHeader));
+  records_ = reinterpret_cast<const double*>(map_ + data_offset);
+}
+
+inline BinaryTrajectoryReader::~BinaryTrajectoryReader() {
+  munmap(map_, map_size_);
+  close(file_);
+}
+
+inline size_t BinaryTrajectoryReader::GetNumberRecords() const {
+  return header_->number_records;
+}
+
+inline unsigned int BinaryTrajectoryReader::GetNumberOscillators() const {
+  return header_->number_oscillators;
+}
+
+inline unsigned int BinaryTrajectoryReader::GetDimension() const {
+  return header_->dimension;
+}
+
+inline std::vector<unsigned int> BinaryTrajectoryReader::GetNodeSizes()
+    const {
+  return std::vector<unsigned int>(node_sizes_,
+                                   node_sizes_ + header_->number_nodes);
+}
+
+inline double BinaryTrajectoryReader::GetTimestep() const {
+  return header_->dt;
+}
+
+inline double BinaryTrajectoryReader::GetTime(size_t i) const {
+  if (i >= GetNumberRecords()) {
+    throw std::out_of_range("The record does not exist.");
+  }
+  return records_[i*record_size_];
+}
+
+inline StateView<double> BinaryTrajectoryReader::GetState(size_t i) const {
+  if (i >= GetNumberRecords()) {
+    throw std::out_of_range("The record does not exist.");
+  }
+  return StateView<double>(records_ + i*record_size_ + 1, record_size_ - 1);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_BINARY_TRAJECTORY_HPP_
@@ -0,0 +1,59 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_COMPENSATED_SUM_HPP_
+#define INCLUDE_SAM_HELPER_COMPENSATED_SUM_HPP_
+
+#include <cmath>
+
+namespace sam {
+
+/*!
+ * \brief Sum of doubles with Kahan-Babuska (Neumaier) compensation.
+ *
+ * The rounding error of every addition is accumulated separately, so the
+ * error of the sum does not grow with the number of values. It is used for
+ * the mean fields, that stay accurate for large single precision states.
+ * The compensation relies on IEEE arithmetic, so it must not be compiled with
+ * -ffast-math.
+ */
+class CompensatedSum {
+ public:
+  CompensatedSum();
+
+  void Add(double value);
+
+  double Sum() const;
+
+  void Reset();
+
+ private:
+  double sum_;
+  double compensation_;
+};
+
+// Implementation
+
+inline CompensatedSum::CompensatedSum() : sum_(0.), compensation_(0.) {}
+
+inline void CompensatedSum::Add(double value) {
+  const double sum = sum_ + value;
+  if (std::fabs(sum_) >= std::fabs(value)) {
+    compensation_ += (sum_ - sum) + value;
+  } else {
+    compensation_ += (value - sum) + sum_;
+  }
+  sum_ = sum;
+}
+
+inline double CompensatedSum::Sum() const {
+  return sum_ + compensation_;
+}
+
+inline void CompensatedSum::Reset() {
+  sum_ = 0.;
+  compensation_ = 0.;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_COMPENSATED_SUM_HPP_
@@ -3,6 +3,14 @@
 #ifndef INCLUDE_SAM_HELPER_COORDINATE_HELPER_HPP_
 #define INCLUDE_SAM_HELPER_COORDINATE_HELPER_HPP_
 
+#include <cmath>
+#include <complex>
+#include <cstddef>
+
+#include "./compensated_sum.hpp"
+#include "./fast_math.hpp"
+#include "./state_traits.hpp"
+
 namespace sam {
 
 /*!
@@ -26,6 +34,23 @@ template<typename state_type>
 state_type CartesianToSpherical(typename state_type::const_iterator begin,
                                 typename state_type::const_iterator end);
 
+/*!
+ * \brief Transform cartesian coordinates into hyperspherical ones and write
+ * them to spherical.
+ *
+ * Same as above, but the coordinates are written to the output iterator
+ * spherical, which needs space for end - begin values. No memory is
+ * allocated, so it also works for states without push_back, e.g. with
+ * pointers into the data of an Eigen vector.
+ *
+ * @param begin An iterator pointing to the first element of the coordinates.
+ * @param end An iterator pointing to the last element of the coordinates.
+ * @param spherical An iterator to the beginning of the output.
+ */
+template<typename input_iterator, typename output_iterator>
+void CartesianToSpherical(input_iterator begin, input_iterator end,
+                          output_iterator spherical);
+
 /*!
  * \brief Transform cartesian coordinates into hyperspherical ones.
  *
@@ -44,41 +69,99 @@ state_type CartesianToSpherical(typename state_type::const_iterator begin,
 template<typename state_type>
 state_type CartesianToSpherical(const state_type& cartesian);
 
+/*!
+ * \brief Calculate the Kuramoto order parameter of phases.
+ *
+ * The order parameter is the mean of the phases on the unit circle,
+ * \f[ Z = R e^{i \Psi} = \frac{1}{N} \sum_j e^{i \varphi_j}. \f]
+ * Its magnitude R is 1 for synchronized phases and close to 0 for uniformly
+ * distributed phases.
+ *
+ * The sine and cosine are calculated in blocks with SinCos. The sums of the
+ * blocks are added with a CompensatedSum, so the order parameter of a large
+ * number of phases, also in single precision, is accurate.
+ *
+ * @param begin An iterator pointing to the first phase.
+ * @param end An iterator pointing behind the last phase.
+ * @param accuracy The accuracy of the sine and cosine.
+ *
+ * @returns The complex order parameter Z, it is 0 for no phases.
+ */
+template<typename input_iterator>
+std::complex<double> OrderParameter(
+    input_iterator begin, input_iterator end,
+    MathAccuracy accuracy = MathAccuracy::kHigh);
+
 // Implementation
 
 template<typename state_type>
 state_type CartesianToSpherical(typename state_type::const_iterator begin,
                                 typename state_type::const_iterator end) {
-  unsigned int dimension = end - begin;
-  state_type spherical;
-  // sum_squared = [sum(x_i**2), sum(x_i**2) - x_0**2,
-  //                sum(x_i**2) - x_0**2 - x_1**2, ...]
-  state_type sum_squared(dimension);
-  for (typename state_type::const_iterator i = begin; i != end; ++i) {
-    sum_squared[0] += (*i)*(*i);
-  }
-  for (size_t i = 1; i < dimension; ++i) {
-    sum_squared[i] = sum_squared[i-1] - (*(begin + i - 1))*(*(begin + i - 1));
+  state_type spherical = StateTraits<state_type>::Zero(end - begin);
+  CartesianToSpherical(begin, end, spherical.begin());
+  return spherical;
+}
+
+template<typename input_iterator, typename output_iterator>
+void CartesianToSpherical(input_iterator begin, input_iterator end,
+                          output_iterator spherical) {
+  const size_t dimension = end - begin;
+  // sum_squared = sum(x_i**2) - x_0**2 - ... - x_{k-1}**2 for the k-th phase
+  double sum_squared = 0.;
+  for (input_iterator i = begin; i != end; ++i) {
+    sum_squared += (*i)*(*i);
   }
   // radius or distance to the origin
-  spherical.push_back(sqrt(sum_squared[0]));
+  *spherical = std::sqrt(sum_squared);
+  ++spherical;
   // phases
-  for (size_t i = 0; i < dimension - 2; ++i) {
-    spherical.push_back(acos((*(begin + i))/sqrt(sum_squared[i])));
+  for (size_t i = 0; i + 2 < dimension; ++i) {
+    *spherical = std::acos((*(begin + i))/std::sqrt(sum_squared));
+    ++spherical;
+    sum_squared -= (*(begin + i))*(*(begin + i));
   }
   if ((*(end-1)) < 0) {
-    spherical.push_back(2*M_PI-acos((*(begin + dimension-2))
-                                    /sqrt(sum_squared[dimension-2])));
+    *spherical = 2*M_PI-std::acos((*(begin + dimension-2))
+                                  /std::sqrt(sum_squared));
   } else {
-    spherical.push_back(acos((*(begin + dimension-2))
-                             /sqrt(sum_squared[dimension-2])));
+    *spherical = std::acos((*(begin + dimension-2))/std::sqrt(sum_squared));
   }
-  return spherical;
 }
 
 template<typename state_type>
 state_type CartesianToSpherical(const state_type& cartesian) {
-  return CartesianToSpherical<state_type>(cartesian.begin(), cartesian.end());
+  state_type spherical = StateTraits<state_type>::Zero(cartesian.size());
+  CartesianToSpherical(cartesian.data(), cartesian.data() + cartesian.size(),
+                       spherical.data());
+  return spherical;
+}
+
+template<typename input_iterator>
+std::complex<double> OrderParameter(input_iterator begin, input_iterator end,
+                                    MathAccuracy accuracy) {
+  double phases[kMathBlockSize], sin[kMathBlockSize], cos[kMathBlockSize];
+  CompensatedSum x, y;
+  size_t N = 0;
+  input_iterator i = begin;
+  while (i != end) {
+    size_t size = 0;
+    for (; i != end && size < kMathBlockSize; ++i, ++size) {
+      phases[size] = *i;
+    }
+    SinCos(phases, sin, cos, size, accuracy);
+    double block_x = 0., block_y = 0.;
+    for (size_t j = 0; j < size; ++j) {
+      block_x += cos[j];
+      block_y += sin[j];
+    }
+    x.Add(block_x);
+    y.Add(block_y);
+    N += size;
+  }
+  if (N == 0) {
+    return std::complex<double>(0., 0.);
+  }
+  return std::complex<double>(x.Sum(), y.Sum())/static_cast<double>(N);
 }
 
 }  // namespace sam
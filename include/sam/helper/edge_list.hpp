@@ -0,0 +1,106 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_EDGE_LIST_HPP_
+#define INCLUDE_SAM_HELPER_EDGE_LIST_HPP_
+
+#include <Eigen/SparseCore>
+
+#include <cstddef>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sam {
+
+//! Sparse adjacency matrix in compressed sparse row (CSR) format.
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> AdjacencyMatrix;
+
+//! An edge (i, j, w) of the network sets the entry A_ij = w.
+typedef Eigen::Triplet<double> Edge;
+
+/*!
+ * \brief Build the adjacency matrix of a network from its edges.
+ *
+ * The entry A_ij is the weight with which unit i is coupled to unit j.
+ * Multiple edges between the same units are summed up.
+ *
+ * @param number_nodes The number of units in the network.
+ * @param edges The edges (i, j, w) of the network.
+ * @param symmetric If true, every edge is also added in the reverse
+ *  direction.
+ *
+ * @throws std::invalid_argument If an edge refers to a unit that does not
+ *  exist.
+ */
+inline AdjacencyMatrix BuildAdjacencyMatrix(size_t number_nodes,
+                                            std::vector<Edge> edges,
+                                            bool symmetric = false);
+
+/*!
+ * \brief Read the adjacency matrix from an edge list.
+ *
+ * Every line contains an edge in the form "i j" or "i j w", where the weight
+ * w defaults to 1. Empty lines and lines starting with '#' are ignored.
+ *
+ * @throws std::invalid_argument If a line cannot be read or an edge refers to
+ *  a unit that does not exist.
+ */
+inline AdjacencyMatrix ReadEdgeList(std::istream& input, size_t number_nodes,
+                                    bool symmetric = false);
+
+// Implementation
+
+inline AdjacencyMatrix BuildAdjacencyMatrix(size_t number_nodes,
+                                            std::vector<Edge> edges,
+                                            bool symmetric) {
+  const size_t number_edges = edges.size();
+  for (size_t i = 0; i < number_edges; ++i) {
+    if (edges[i].row() < 0 || edges[i].col() < 0
+        || static_cast<size_t>(edges[i].row()) >= number_nodes
+        || static_cast<size_t>(edges[i].col()) >= number_nodes) {
+      throw std::invalid_argument("Edge refers to a node outside of the "
+                                  "network.");
+    }
+    if (symmetric && edges[i].row() != edges[i].col()) {
+      edges.push_back(Edge(edges[i].col(), edges[i].row(), edges[i].value()));
+    }
+  }
+  AdjacencyMatrix adjacency(number_nodes, number_nodes);
+  adjacency.setFromTriplets(edges.begin(), edges.end());
+  adjacency.makeCompressed();
+  return adjacency;
+}
+
+inline AdjacencyMatrix ReadEdgeList(std::istream& input, size_t number_nodes,
+                                    bool symmetric) {
+  std::vector<Edge> edges;
+  std::string line;
+  while (std::getline(input, line)) {
+    std::istringstream line_stream(line);
+    long i, j;  // NOLINT(runtime/int)
+    if (!(line_stream >> i)) {
+      // the line is empty or only has whitespace
+      if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+      if (line[line.find_first_not_of(" \t\r")] == '#') continue;
+      throw std::invalid_argument("Cannot read edge from line: " + line);
+    }
+    if (!(line_stream >> j)) {
+      throw std::invalid_argument("Cannot read edge from line: " + line);
+    }
+    double weight = 1.;
+    if (!(line_stream >> weight)) {
+      if (!line_stream.eof()) {
+        throw std::invalid_argument("Cannot read weight from line: " + line);
+      }
+      weight = 1.;
+    }
+    edges.push_back(Edge(i, j, weight));
+  }
+  return BuildAdjacencyMatrix(number_nodes, edges, symmetric);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_EDGE_LIST_HPP_
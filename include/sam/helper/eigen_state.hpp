@@ -0,0 +1,54 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_EIGEN_STATE_HPP_
+#define INCLUDE_SAM_HELPER_EIGEN_STATE_HPP_
+
+#include <Eigen/Dense>
+
+#include <cstddef>
+
+// the eigen adaption of odeint relies on the general dispatcher
+#include <boost/numeric/odeint/algebra/algebra_dispatcher.hpp>
+#include <boost/numeric/odeint/external/eigen/eigen.hpp>
+
+#include "./state_traits.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Support for Eigen vectors as state_type.
+ *
+ * Including this header makes Eigen::VectorXd and fixed-size vectors like
+ * Eigen::Matrix<double, N, 1> usable as state_type of the systems and
+ * networks. odeint then uses its vector_space_algebra, so the stages of the
+ * steppers are evaluated as Eigen expressions, and the ODE can use Eigen
+ * expressions on the state as well. For fixed-size vectors the size of the
+ * system has to match the size of the vector, mean fields are returned as
+ * dynamic vectors.
+ */
+template<typename scalar_type, int rows, int options, int max_rows>
+struct StateTraits<Eigen::Matrix<scalar_type, rows, 1, options, max_rows, 1>> {
+  typedef Eigen::Matrix<scalar_type, rows, 1, options, max_rows, 1>
+      state_type;
+  typedef Eigen::Matrix<scalar_type, Eigen::Dynamic, 1> dynamic_type;
+
+  static state_type Zero(size_t n) {
+    return state_type::Zero(n);
+  }
+
+  static dynamic_type ZeroDynamic(size_t n) {
+    return dynamic_type::Zero(n);
+  }
+
+  static void Resize(state_type& x, size_t n) {
+    Eigen::Index old_size = x.size();
+    x.conservativeResize(n);
+    if (static_cast<Eigen::Index>(n) > old_size) {
+      x.tail(n - old_size).setZero();
+    }
+  }
+};
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_EIGEN_STATE_HPP_
@@ -0,0 +1,333 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_FAST_MATH_HPP_
+#define INCLUDE_SAM_HELPER_FAST_MATH_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace sam {
+
+/*!
+ * \brief Accuracy of the batched math functions.
+ */
+enum class MathAccuracy {
+  //! The functions of the standard library, one element at a time.
+  kStandard,
+  //! Polynomial approximations with an absolute error below 1e-15.
+  kHigh,
+  //! Shorter polynomials with an absolute error below 1e-6.
+  kLow
+};
+
+/*!
+ * \brief Calculate the sine and cosine of n values.
+ *
+ * For kHigh and kLow the loop has no branches and no calls, so the compiler
+ * vectorizes it. The argument is reduced with a three part Cody-Waite
+ * reduction, values with a magnitude above 1e5 are calculated with the
+ * standard library. The rounding relies on IEEE arithmetic, so it must not be
+ * compiled with -ffast-math. GCC only vectorizes the selects of the kernels
+ * with -fno-trapping-math, which is safe for them, and the loops with a sqrt
+ * with -fno-math-errno, see bench/CMakeLists.txt.
+ */
+inline void SinCos(const double* x, double* sin, double* cos, size_t n,
+                   MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Calculate atan2(y, x) of n values in the range [-pi, pi].
+ *
+ * For kHigh and kLow the loop is vectorized, atan2(0, 0) is 0.
+ */
+inline void Atan2(const double* y, const double* x, double* angle, size_t n,
+                  MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Calculate acos(x) of n values in [-1, 1].
+ */
+inline void Acos(const double* x, double* angle, size_t n,
+                 MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Transform n points in 2d into polar coordinates.
+ *
+ * The points are stored as (x_0, y_0, x_1, y_1, ...) and are transformed
+ * into (r_0, phi_0, r_1, phi_1, ...) with phi in [0, 2 pi), the same
+ * convention as CartesianToSpherical. cartesian and polar may be the same.
+ */
+inline void CartesianToPolar(const double* cartesian, double* polar,
+                             size_t n,
+                             MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Transform n points in d > 2 dimensions into hyperspherical
+ * coordinates.
+ *
+ * The result is the same as CartesianToSpherical for every point, but the
+ * angles are calculated with Acos over blocks of points, so the loops are
+ * vectorized. The ratios are clamped to [-1, 1] against rounding. The points
+ * can be of another type, e.g. float, they are calculated in double
+ * precision. cartesian and spherical must not overlap.
+ */
+template<typename value_type>
+void CartesianToHyperspherical(const value_type* cartesian,
+                               value_type* spherical, size_t n, size_t d,
+                               MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Calculate the sine and cosine of n values of another type, e.g.
+ * float.
+ *
+ * The values are converted to double in blocks, so single precision states
+ * get the same accuracy as above.
+ */
+template<typename value_type>
+void SinCos(const value_type* x, double* sin, double* cos, size_t n,
+            MathAccuracy accuracy = MathAccuracy::kHigh);
+
+/*!
+ * \brief Transform n points in 2d of another type, e.g. float, into polar
+ * coordinates. They are calculated in double precision in blocks.
+ */
+template<typename value_type>
+void CartesianToPolar(const value_type* cartesian, value_type* polar,
+                      size_t n, MathAccuracy accuracy = MathAccuracy::kHigh);
+
+// Implementation
+
+// Size of the blocks that are processed with buffers on the stack.
+constexpr size_t kMathBlockSize = 128;
+
+// Adding and subtracting 1.5*2^52 rounds to the nearest integer.
+constexpr double kRoundMagic = 6755399441055744.;
+// Above this the reduction loses precision.
+constexpr double kMaxReduction = 1e5;
+
+template<bool high>
+inline void SinCosKernel(const double* x, double* sin, double* cos,
+                         size_t n) {
+  // pi/2 in three parts, the first two have enough trailing zeros, that
+  // their product with k is exact
+  const double pi_half_1 = 1.57079632673412561417e+00;
+  const double pi_half_2 = 6.07710050630396597660e-11;
+  const double pi_half_3 = 2.02226624879595063154e-21;
+  // minimax coefficients of fdlibm for [-pi/4, pi/4]
+  const double S1 = -1.66666666666666324348e-01;
+  const double S2 = 8.33333333332248946124e-03;
+  const double S3 = -1.98412698298579493134e-04;
+  const double S4 = 2.75573137070700676789e-06;
+  const double S5 = -2.50507602534068634195e-08;
+  const double S6 = 1.58969099521155010221e-10;
+  const double C1 = 4.16666666666666019037e-02;
+  const double C2 = -1.38888888888741095749e-03;
+  const double C3 = 2.48015872894767294178e-05;
+  const double C4 = -2.75573143513906633035e-07;
+  const double C5 = 2.08757232129817482790e-09;
+  const double C6 = -1.13596475577881948265e-11;
+  for (size_t i = 0; i < n; ++i) {
+    const double k = (x[i]*M_2_PI + kRoundMagic) - kRoundMagic;
+    const double r = ((x[i] - k*pi_half_1) - k*pi_half_2) - k*pi_half_3;
+    const double z = r*r;
+    double sin_r, cos_r;
+    if (high) {
+      sin_r = r + r*z*(S1 + z*(S2 + z*(S3 + z*(S4 + z*(S5 + z*S6)))));
+      cos_r = 1. - 0.5*z + z*z*(C1 + z*(C2 + z*(C3 + z*(C4 + z*(C5
+                                                            + z*C6)))));
+    } else {
+      sin_r = r + r*z*(S1 + z*(S2 + z*S3));
+      cos_r = 1. - 0.5*z + z*z*(C1 + z*(C2 + z*C3));
+    }
+    // quadrant k mod 4, the shift avoids ties in the rounding
+    const double quadrant
+        = k - 4.*((0.25*k - 0.375 + kRoundMagic) - kRoundMagic);
+    // no short-circuit operators, so the loop has no branches
+    const bool odd = (quadrant == 1.) | (quadrant == 3.);
+    const double sin_sign = quadrant >= 2. ? -1. : 1.;
+    const double cos_sign = (quadrant == 1.) | (quadrant == 2.) ? -1. : 1.;
+    sin[i] = sin_sign*(odd ? cos_r : sin_r);
+    cos[i] = cos_sign*(odd ? sin_r : cos_r);
+  }
+}
+
+template<bool high>
+inline void Atan2Kernel(const double* y, const double* x, double* angle,
+                        size_t n) {
+  // minimax coefficients of fdlibm for |t| < 7/16
+  const double aT[] = {
+    3.33333333333329318027e-01, -1.99999999998764832476e-01,
+    1.42857142725034663711e-01, -1.11111104054623557880e-01,
+    9.09088713343650656196e-02, -7.69187620504482999495e-02,
+    6.66107313738753120669e-02, -5.83357013379057348645e-02,
+    4.97687799461593236017e-02, -3.65315727442169155270e-02,
+    1.62858201153657823623e-02};
+  const double tan_pi_8 = 0.41421356237309503;
+  for (size_t i = 0; i < n; ++i) {
+    const double ax = std::fabs(x[i]);
+    const double ay = std::fabs(y[i]);
+    const double larger = ax > ay ? ax : ay;
+    const double smaller = ax > ay ? ay : ax;
+    // reduce to a = tan(angle) in [0, 1] and then to t in [-tan(pi/8),
+    // tan(pi/8)] with atan(a) = pi/4 + atan((a - 1)/(a + 1))
+    // both divisions are always done, so the loop has no branches
+    const double a = smaller/(larger > 0. ? larger : 1.);
+    const bool shifted = a > tan_pi_8;
+    const double shifted_a = (a - 1.)/(a + 1.);
+    const double t = shifted ? shifted_a : a;
+    const double z = t*t;
+    const double w = z*z;
+    double s1, s2;
+    if (high) {
+      s1 = z*(aT[0] + w*(aT[2] + w*(aT[4] + w*(aT[6] + w*(aT[8]
+                                                         + w*aT[10])))));
+      s2 = w*(aT[1] + w*(aT[3] + w*(aT[5] + w*(aT[7] + w*aT[9]))));
+    } else {
+      s1 = z*(aT[0] + w*(aT[2] + w*aT[4]));
+      s2 = w*(aT[1] + w*aT[3]);
+    }
+    double result = (shifted ? M_PI_4 : 0.) + (t - t*(s1 + s2));
+    result = ay > ax ? M_PI_2 - result : result;
+    result = x[i] < 0. ? M_PI - result : result;
+    angle[i] = y[i] < 0. ? -result : result;
+  }
+}
+
+inline void SinCos(const double* x, double* sin, double* cos, size_t n,
+                   MathAccuracy accuracy) {
+  switch (accuracy) {
+    case MathAccuracy::kStandard:
+      for (size_t i = 0; i < n; ++i) {
+        sin[i] = std::sin(x[i]);
+        cos[i] = std::cos(x[i]);
+      }
+      return;
+    case MathAccuracy::kHigh:
+      SinCosKernel<true>(x, sin, cos, n);
+      break;
+    case MathAccuracy::kLow:
+      SinCosKernel<false>(x, sin, cos, n);
+      break;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (std::fabs(x[i]) > kMaxReduction) {
+      sin[i] = std::sin(x[i]);
+      cos[i] = std::cos(x[i]);
+    }
+  }
+}
+
+inline void Atan2(const double* y, const double* x, double* angle, size_t n,
+                  MathAccuracy accuracy) {
+  switch (accuracy) {
+    case MathAccuracy::kStandard:
+      for (size_t i = 0; i < n; ++i) {
+        angle[i] = std::atan2(y[i], x[i]);
+      }
+      break;
+    case MathAccuracy::kHigh:
+      Atan2Kernel<true>(y, x, angle, n);
+      break;
+    case MathAccuracy::kLow:
+      Atan2Kernel<false>(y, x, angle, n);
+      break;
+  }
+}
+
+inline void Acos(const double* x, double* angle, size_t n,
+                 MathAccuracy accuracy) {
+  if (accuracy == MathAccuracy::kStandard) {
+    for (size_t i = 0; i < n; ++i) {
+      angle[i] = std::acos(x[i]);
+    }
+    return;
+  }
+  // acos(x) = atan2(sqrt(1 - x^2), x), the factorization keeps the
+  // precision close to |x| = 1
+  double y[kMathBlockSize];
+  for (size_t start = 0; start < n; start += kMathBlockSize) {
+    const size_t size = std::min(kMathBlockSize, n - start);
+    for (size_t i = 0; i < size; ++i) {
+      y[i] = std::sqrt((1. - x[start + i])*(1. + x[start + i]));
+    }
+    Atan2(y, x + start, angle + start, size, accuracy);
+  }
+}
+
+inline void CartesianToPolar(const double* cartesian, double* polar,
+                             size_t n, MathAccuracy accuracy) {
+  double x[kMathBlockSize], y[kMathBlockSize], angle[kMathBlockSize];
+  for (size_t start = 0; start < n; start += kMathBlockSize) {
+    const size_t size = std::min(kMathBlockSize, n - start);
+    const double* block = cartesian + 2*start;
+    for (size_t i = 0; i < size; ++i) {
+      x[i] = block[2*i];
+      y[i] = block[2*i + 1];
+    }
+    Atan2(y, x, angle, size, accuracy);
+    double* output = polar + 2*start;
+    for (size_t i = 0; i < size; ++i) {
+      output[2*i] = std::sqrt(x[i]*x[i] + y[i]*y[i]);
+      output[2*i + 1] = angle[i] < 0. ? angle[i] + 2.*M_PI : angle[i];
+    }
+  }
+}
+
+template<typename value_type>
+void SinCos(const value_type* x, double* sin, double* cos, size_t n,
+            MathAccuracy accuracy) {
+  double block[kMathBlockSize];
+  for (size_t start = 0; start < n; start += kMathBlockSize) {
+    const size_t size = std::min(kMathBlockSize, n - start);
+    std::copy(x + start, x + start + size, block);
+    SinCos(block, sin + start, cos + start, size, accuracy);
+  }
+}
+
+template<typename value_type>
+void CartesianToPolar(const value_type* cartesian, value_type* polar,
+                      size_t n, MathAccuracy accuracy) {
+  double block[2*kMathBlockSize];
+  for (size_t start = 0; start < n; start += kMathBlockSize) {
+    const size_t size = std::min(kMathBlockSize, n - start);
+    std::copy(cartesian + 2*start, cartesian + 2*(start + size), block);
+    CartesianToPolar(block, block, size, accuracy);
+    std::copy(block, block + 2*size, polar + 2*start);
+  }
+}
+
+template<typename value_type>
+void CartesianToHyperspherical(const value_type* cartesian,
+                               value_type* spherical, size_t n, size_t d,
+                               MathAccuracy accuracy) {
+  // sum = sum(x_i**2) - x_0**2 - ... - x_{j-1}**2 for the j-th angle
+  double sum[kMathBlockSize], ratio[kMathBlockSize], angle[kMathBlockSize];
+  for (size_t start = 0; start < n; start += kMathBlockSize) {
+    const size_t size = std::min(kMathBlockSize, n - start);
+    const value_type* x = cartesian + d*start;
+    value_type* output = spherical + d*start;
+    for (size_t i = 0; i < size; ++i) {
+      sum[i] = 0.;
+      for (size_t j = 0; j < d; ++j) {
+        sum[i] += static_cast<double>(x[i*d + j])*x[i*d + j];
+      }
+      output[i*d] = std::sqrt(sum[i]);
+    }
+    for (size_t j = 0; j + 1 < d; ++j) {
+      for (size_t i = 0; i < size; ++i) {
+        const double x_j = x[i*d + j];
+        ratio[i] = std::fmin(1., std::fmax(-1., x_j/std::sqrt(sum[i])));
+        sum[i] -= x_j*x_j;
+      }
+      Acos(ratio, angle, size, accuracy);
+      for (size_t i = 0; i < size; ++i) {
+        // the last angle covers the full circle
+        output[i*d + j + 1] = j + 2 == d && x[i*d + d - 1] < 0
+                              ? 2.*M_PI - angle[i] : angle[i];
+      }
+    }
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_FAST_MATH_HPP_
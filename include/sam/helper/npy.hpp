@@ -0,0 +1,76 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_NPY_HPP_
+#define INCLUDE_SAM_HELPER_NPY_HPP_
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sam {
+
+/*!
+ * \brief Write a dense array of doubles in the NumPy .npy format.
+ *
+ * The data is stored in row-major order, the last index changes fastest. The
+ * file can be loaded directly with numpy.load and e.g. plotted with
+ * matplotlib.pyplot.imshow.
+ *
+ * @param filename The name of the file, it is overwritten.
+ * @param data The values, the number has to be the product of the shape.
+ * @param shape The size of every dimension.
+ *
+ * @throws std::length_error If the size does not match the shape.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+inline void WriteNpy(const std::string& filename,
+                     const std::vector<double>& data,
+                     const std::vector<size_t>& shape);
+
+// Implementation
+
+inline void WriteNpy(const std::string& filename,
+                     const std::vector<double>& data,
+                     const std::vector<size_t>& shape) {
+  size_t size = 1;
+  std::string shape_text = "(";
+  for (size_t n : shape) {
+    size *= n;
+    shape_text += std::to_string(n) + ", ";
+  }
+  // a tuple with one element needs the trailing comma
+  if (shape.size() > 1) shape_text.resize(shape_text.size() - 2);
+  shape_text += ")";
+  if (size != data.size()) {
+    throw std::length_error("The data does not match the shape of the "
+                            "array.");
+  }
+  const int one = 1;
+  const bool little_endian = *reinterpret_cast<const char*>(&one) == 1;
+  std::string header = std::string("{'descr': '") + (little_endian ? "<" : ">")
+                       + "f8', 'fortran_order': False, 'shape': "
+                       + shape_text + ", }";
+  // magic, version and the length of the header take 10 bytes, the data
+  // starts at a multiple of 64 bytes and the header ends with a newline
+  const size_t total = (10 + header.size() + 1 + 63)/64*64;
+  header.append(total - 10 - header.size() - 1, ' ');
+  header += '\n';
+  const unsigned short header_size = header.size();  // NOLINT(runtime/int)
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write("\x93NUMPY\x01\x00", 8);
+  const char length[2] = {static_cast<char>(header_size & 0xff),
+                          static_cast<char>(header_size >> 8)};
+  file.write(length, 2);
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char*>(data.data()),
+             data.size()*sizeof(double));
+  if (!file) {
+    throw std::runtime_error("Cannot write the array to " + filename + ".");
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_NPY_HPP_
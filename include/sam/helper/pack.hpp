@@ -0,0 +1,175 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_PACK_HPP_
+#define INCLUDE_SAM_HELPER_PACK_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace sam {
+
+// The width of the SIMD registers of the target in bytes.
+#if defined(__AVX512F__)
+#define SAM_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define SAM_SIMD_BYTES 32
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(_M_X64)
+#define SAM_SIMD_BYTES 16
+#else
+#define SAM_SIMD_BYTES 8
+#endif
+
+/*!
+ * \brief The alignment of a pack, the size of the pack if it is a power of
+ * two up to SAM_SIMD_BYTES, otherwise the alignment of a single value.
+ */
+template<typename T, unsigned int lanes>
+constexpr size_t PackAlignment() {
+  return (sizeof(T)*lanes & (sizeof(T)*lanes - 1)) == 0
+         && sizeof(T)*lanes <= SAM_SIMD_BYTES ? sizeof(T)*lanes : alignof(T);
+}
+
+/*!
+ * \brief A fixed number of values that are processed together.
+ *
+ * A pack holds one value per lane and all arithmetic is done lane by lane in
+ * short loops of constant length, which the compiler turns into SIMD
+ * instructions. A pack is aligned to its size, see PackAlignment, so vectors
+ * of packs need an AlignedAllocator. It can be used like a scalar in an ODE,
+ * a scalar is implicitly broadcast to all lanes. The math functions are found
+ * by argument dependent lookup, so an ODE that should work with scalars and
+ * packs has to call them unqualified, e.g. `using std::sin; sin(x[0]);`.
+ */
+template<typename T, unsigned int lanes>
+struct alignas(PackAlignment<T, lanes>()) Pack {
+  T value_[lanes];
+
+  Pack() = default;
+
+  Pack(T scalar) {  // NOLINT(runtime/explicit)
+    for (unsigned int i = 0; i < lanes; ++i) value_[i] = scalar;
+  }
+
+  static constexpr unsigned int size() { return lanes; }
+
+  T& operator[](unsigned int i) { return value_[i]; }
+
+  const T& operator[](unsigned int i) const { return value_[i]; }
+
+  Pack& operator+=(const Pack& other) {
+    for (unsigned int i = 0; i < lanes; ++i) value_[i] += other.value_[i];
+    return *this;
+  }
+
+  Pack& operator-=(const Pack& other) {
+    for (unsigned int i = 0; i < lanes; ++i) value_[i] -= other.value_[i];
+    return *this;
+  }
+
+  Pack& operator*=(const Pack& other) {
+    for (unsigned int i = 0; i < lanes; ++i) value_[i] *= other.value_[i];
+    return *this;
+  }
+
+  Pack& operator/=(const Pack& other) {
+    for (unsigned int i = 0; i < lanes; ++i) value_[i] /= other.value_[i];
+    return *this;
+  }
+
+  // the operators are friends, so a scalar on either side is converted
+  friend Pack operator+(Pack a, const Pack& b) { return a += b; }
+  friend Pack operator-(Pack a, const Pack& b) { return a -= b; }
+  friend Pack operator*(Pack a, const Pack& b) { return a *= b; }
+  friend Pack operator/(Pack a, const Pack& b) { return a /= b; }
+
+  friend Pack operator-(Pack a) {
+    for (unsigned int i = 0; i < lanes; ++i) a.value_[i] = -a.value_[i];
+    return a;
+  }
+};
+
+/*!
+ * \brief The pack that fills one SIMD register of the target.
+ */
+template<typename T>
+using NativePack = Pack<T, (SAM_SIMD_BYTES/sizeof(T) > 1
+                            ? SAM_SIMD_BYTES/sizeof(T) : 1)>;
+
+/*!
+ * \brief An allocator that respects the alignment of over-aligned types like
+ * Pack, which the default allocator does not before C++17.
+ *
+ * The memory is over-allocated and the original pointer is stored in front
+ * of the aligned block.
+ */
+template<typename T>
+struct AlignedAllocator {
+  typedef T value_type;
+
+  AlignedAllocator() = default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) {}  // NOLINT(runtime/explicit)
+
+  T* allocate(size_t n) {
+    const size_t alignment = alignof(T) > alignof(void*) ? alignof(T)
+                                                         : alignof(void*);
+    char* raw = static_cast<char*>(::operator new(n*sizeof(T) + alignment
+                                                  + sizeof(void*)));
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw)
+                             + sizeof(void*);
+    address = (address + alignment - 1) & ~(alignment - 1);
+    void** aligned = reinterpret_cast<void**>(address);
+    aligned[-1] = raw;
+    return reinterpret_cast<T*>(aligned);
+  }
+
+  void deallocate(T* p, size_t n) {
+    ::operator delete(reinterpret_cast<void**>(p)[-1]);
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return false;
+}
+
+// Apply a scalar function to every lane.
+#define SAM_PACK_FUNCTION(name)                                     \
+  template<typename T, unsigned int lanes>                          \
+  Pack<T, lanes> name(Pack<T, lanes> a) {                           \
+    for (unsigned int i = 0; i < lanes; ++i) {                      \
+      a.value_[i] = std::name(a.value_[i]);                         \
+    }                                                               \
+    return a;                                                       \
+  }
+
+SAM_PACK_FUNCTION(sin)
+SAM_PACK_FUNCTION(cos)
+SAM_PACK_FUNCTION(tan)
+SAM_PACK_FUNCTION(exp)
+SAM_PACK_FUNCTION(log)
+SAM_PACK_FUNCTION(sqrt)
+SAM_PACK_FUNCTION(fabs)
+SAM_PACK_FUNCTION(abs)
+
+#undef SAM_PACK_FUNCTION
+
+template<typename T, unsigned int lanes>
+Pack<T, lanes> pow(Pack<T, lanes> a, const Pack<T, lanes>& b) {
+  for (unsigned int i = 0; i < lanes; ++i) {
+    a.value_[i] = std::pow(a.value_[i], b.value_[i]);
+  }
+  return a;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_PACK_HPP_
@@ -0,0 +1,239 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_RAGGED_ARRAY_HPP_
+#define INCLUDE_SAM_HELPER_RAGGED_ARRAY_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "./state_traits.hpp"
+#include "./state_view.hpp"
+
+namespace sam {
+
+/*!
+ * \brief A read-only view of rows of different length in one contiguous
+ * buffer.
+ *
+ * Row i consists of the elements [offsets[i], offsets[i+1]) of the buffer,
+ * e.g. the nodes of a GenericNetwork with its node indices as offsets.
+ * Neither the buffer nor the offsets are copied, so the view is only valid
+ * as long as both exist and are not resized.
+ */
+template<typename value_type>
+class RaggedView {
+ public:
+  RaggedView(const value_type* data, const unsigned int* offsets,
+             size_t number_rows);
+
+  /*!
+   * \brief Return a view of row i.
+   */
+  StateView<value_type> operator[](size_t i) const;
+
+  /*!
+   * \brief Return the number of rows.
+   */
+  size_t size() const;
+
+  size_t RowSize(size_t i) const;
+
+  /*!
+   * \brief Return the beginning of the buffer, the first row starts at
+   * data() + offsets[0].
+   */
+  const value_type* data() const;
+
+ private:
+  const value_type* data_;
+  const unsigned int* offsets_;
+  size_t number_rows_;
+};
+
+/*!
+ * \brief Rows of different length stored in one contiguous state.
+ *
+ * It owns the buffer and the offsets, the first offset is always 0. It is
+ * meant as an output buffer, that is reshaped by the functions writing to
+ * it, so the memory is only allocated once, if it is used repeatedly.
+ */
+template<typename state_type = std::vector<double>>
+class RaggedArray {
+ public:
+  typedef state_value_type<state_type> value_type;
+
+  RaggedArray();
+
+  /*!
+   * \brief Create rows with the given offsets, that are filled with zeros.
+   */
+  explicit RaggedArray(const std::vector<unsigned int>& offsets);
+
+  /*!
+   * \brief Change the rows to the given offsets, the first has to be 0.
+   */
+  void Reshape(const std::vector<unsigned int>& offsets);
+
+  /*!
+   * \brief Change to number_rows rows of size row_size.
+   */
+  void Reshape(size_t number_rows, size_t row_size);
+
+  StateView<value_type> operator[](size_t i) const;
+
+  /*!
+   * \brief Return a pointer to the beginning of row i for writing.
+   */
+  value_type* Row(size_t i);
+
+  size_t size() const;
+
+  size_t RowSize(size_t i) const;
+
+  /*!
+   * \brief Return the flat state of all rows.
+   */
+  const state_type& Flat() const;
+
+  /*!
+   * \brief Return the flat state of all rows for writing, the size must not
+   * be changed.
+   */
+  state_type& Flat();
+
+  const std::vector<unsigned int>& GetOffsets() const;
+
+  RaggedView<value_type> View() const;
+
+ private:
+  state_type data_;
+  std::vector<unsigned int> offsets_;
+};
+
+/*!
+ * \brief Copy the rows into separate states.
+ */
+template<typename state_type>
+std::vector<state_type> ToNested(const RaggedArray<state_type>& ragged);
+
+// Implementation
+
+template<typename value_type>
+RaggedView<value_type>::RaggedView(const value_type* data,
+                                   const unsigned int* offsets,
+                                   size_t number_rows)
+    : data_(data), offsets_(offsets), number_rows_(number_rows) {}
+
+template<typename value_type>
+StateView<value_type> RaggedView<value_type>::operator[](size_t i) const {
+  return StateView<value_type>(data_ + offsets_[i], RowSize(i));
+}
+
+template<typename value_type>
+size_t RaggedView<value_type>::size() const {
+  return number_rows_;
+}
+
+template<typename value_type>
+size_t RaggedView<value_type>::RowSize(size_t i) const {
+  return offsets_[i+1] - offsets_[i];
+}
+
+template<typename value_type>
+const value_type* RaggedView<value_type>::data() const {
+  return data_;
+}
+
+template<typename state_type>
+RaggedArray<state_type>::RaggedArray() : offsets_({0}) {
+  data_ = StateTraits<state_type>::Zero(0);
+}
+
+template<typename state_type>
+RaggedArray<state_type>::RaggedArray(const std::vector<unsigned int>& offsets)
+    : RaggedArray() {
+  Reshape(offsets);
+}
+
+template<typename state_type>
+void RaggedArray<state_type>::Reshape(
+    const std::vector<unsigned int>& offsets) {
+  offsets_ = offsets;
+  const size_t number_elements = offsets_.back();
+  if (static_cast<size_t>(data_.size()) != number_elements) {
+    StateTraits<state_type>::Resize(data_, number_elements);
+  }
+}
+
+template<typename state_type>
+void RaggedArray<state_type>::Reshape(size_t number_rows, size_t row_size) {
+  offsets_.resize(number_rows + 1);
+  for (size_t i = 0; i <= number_rows; ++i) {
+    offsets_[i] = i*row_size;
+  }
+  const size_t number_elements = number_rows*row_size;
+  if (static_cast<size_t>(data_.size()) != number_elements) {
+    StateTraits<state_type>::Resize(data_, number_elements);
+  }
+}
+
+template<typename state_type>
+StateView<typename RaggedArray<state_type>::value_type>
+    RaggedArray<state_type>::operator[](size_t i) const {
+  return StateView<value_type>(data_.data() + offsets_[i], RowSize(i));
+}
+
+template<typename state_type>
+typename RaggedArray<state_type>::value_type* RaggedArray<state_type>::Row(
+    size_t i) {
+  return data_.data() + offsets_[i];
+}
+
+template<typename state_type>
+size_t RaggedArray<state_type>::size() const {
+  return offsets_.size() - 1;
+}
+
+template<typename state_type>
+size_t RaggedArray<state_type>::RowSize(size_t i) const {
+  return offsets_[i+1] - offsets_[i];
+}
+
+template<typename state_type>
+const state_type& RaggedArray<state_type>::Flat() const {
+  return data_;
+}
+
+template<typename state_type>
+state_type& RaggedArray<state_type>::Flat() {
+  return data_;
+}
+
+template<typename state_type>
+const std::vector<unsigned int>& RaggedArray<state_type>::GetOffsets() const {
+  return offsets_;
+}
+
+template<typename state_type>
+RaggedView<typename RaggedArray<state_type>::value_type>
+    RaggedArray<state_type>::View() const {
+  return RaggedView<value_type>(data_.data(), offsets_.data(), size());
+}
+
+template<typename state_type>
+std::vector<state_type> ToNested(const RaggedArray<state_type>& ragged) {
+  std::vector<state_type> nested;
+  nested.reserve(ragged.size());
+  for (size_t i = 0; i < ragged.size(); ++i) {
+    StateView<state_value_type<state_type>> row = ragged[i];
+    nested.push_back(StateTraits<state_type>::Zero(row.size()));
+    for (size_t j = 0; j < row.size(); ++j) {
+      nested.back()[j] = row[j];
+    }
+  }
+  return nested;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_RAGGED_ARRAY_HPP_
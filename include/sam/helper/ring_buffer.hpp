@@ -0,0 +1,160 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_RING_BUFFER_HPP_
+#define INCLUDE_SAM_HELPER_RING_BUFFER_HPP_
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace sam {
+
+/*!
+ * \brief A fixed number of the latest states and their times.
+ *
+ * All states are allocated at construction as copies of a prototype. A new
+ * state is copied into the slot of the oldest one, so the memory stays
+ * constant and, for states with a fixed size, nothing is allocated after
+ * the construction.
+ */
+template<typename state_type>
+class RingBuffer {
+ public:
+  /*!
+   * @param capacity The maximal number of states.
+   * @param prototype A state of the size of the stored states.
+   *
+   * @throws std::invalid_argument If the capacity is 0.
+   */
+  RingBuffer(size_t capacity, const state_type& prototype);
+
+  /*!
+   * \brief Copy x into the buffer, the oldest state is overwritten if the
+   * buffer is full.
+   *
+   * @throws std::length_error If x has another size than the prototype.
+   */
+  void Push(const state_type& x, double t);
+
+  /*!
+   * \brief Add a state at time t and return it for writing, e.g. as output
+   * of GetDerivative. The oldest state is overwritten if the buffer is full.
+   */
+  state_type& Next(double t);
+
+  /*!
+   * \brief Return the i-th state, 0 is the oldest.
+   */
+  const state_type& GetState(size_t i) const;
+
+  /*!
+   * \brief Return the time of the i-th state, 0 is the oldest.
+   */
+  double GetTime(size_t i) const;
+
+  /*!
+   * \brief Return the number of stored states.
+   */
+  size_t size() const;
+
+  size_t capacity() const;
+
+  bool full() const;
+
+  /*!
+   * \brief Remove all states, the memory is kept.
+   */
+  void Clear();
+
+ private:
+  std::vector<state_type> states_;
+  std::vector<double> times_;
+  // index of the oldest state
+  size_t begin_;
+  size_t size_;
+
+  size_t Index(size_t i) const;
+};
+
+// Implementation
+
+template<typename state_type>
+RingBuffer<state_type>::RingBuffer(size_t capacity,
+                                   const state_type& prototype)
+    : states_(capacity, prototype), times_(capacity, 0.), begin_(0),
+      size_(0) {
+  if (capacity == 0) {
+    throw std::invalid_argument("The capacity of a ring buffer has to be "
+                                "positive.");
+  }
+}
+
+template<typename state_type>
+void RingBuffer<state_type>::Push(const state_type& x, double t) {
+  if (x.size() != states_[0].size()) {
+    throw std::length_error("The state does not match the size of the ring "
+                            "buffer.");
+  }
+  Next(t) = x;
+}
+
+template<typename state_type>
+state_type& RingBuffer<state_type>::Next(double t) {
+  size_t index;
+  if (size_ < states_.size()) {
+    index = Index(size_);
+    ++size_;
+  } else {
+    index = begin_;
+    begin_ = Index(1);
+  }
+  times_[index] = t;
+  return states_[index];
+}
+
+template<typename state_type>
+const state_type& RingBuffer<state_type>::GetState(size_t i) const {
+  if (i >= size_) {
+    throw std::out_of_range("The ring buffer has no state with this index.");
+  }
+  return states_[Index(i)];
+}
+
+template<typename state_type>
+double RingBuffer<state_type>::GetTime(size_t i) const {
+  if (i >= size_) {
+    throw std::out_of_range("The ring buffer has no state with this index.");
+  }
+  return times_[Index(i)];
+}
+
+template<typename state_type>
+size_t RingBuffer<state_type>::size() const {
+  return size_;
+}
+
+template<typename state_type>
+size_t RingBuffer<state_type>::capacity() const {
+  return states_.size();
+}
+
+template<typename state_type>
+bool RingBuffer<state_type>::full() const {
+  return size_ == states_.size();
+}
+
+template<typename state_type>
+void RingBuffer<state_type>::Clear() {
+  begin_ = 0;
+  size_ = 0;
+}
+
+template<typename state_type>
+size_t RingBuffer<state_type>::Index(size_t i) const {
+  i += begin_;
+  return i < states_.size() ? i : i - states_.size();
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_RING_BUFFER_HPP_
@@ -0,0 +1,95 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_STATE_TRAITS_HPP_
+#define INCLUDE_SAM_HELPER_STATE_TRAITS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sam {
+
+/*!
+ * \brief Creation and resizing of states.
+ *
+ * The systems only use the size(), resize() and operator[] of a state, every
+ * thing else goes through these traits. The default works for containers
+ * like std::vector, other types can specialize it, see eigen_state.hpp.
+ */
+template<typename state_type>
+struct StateTraits {
+  //! Type for states whose size is only known at runtime, e.g. mean fields.
+  typedef state_type dynamic_type;
+
+  /*!
+   *  \brief Return a state of size n that is filled with zeros.
+   */
+  static state_type Zero(size_t n) {
+    state_type x;
+    x.resize(n);
+    for (size_t i = 0; i < n; ++i) x[i] = 0;
+    return x;
+  }
+
+  /*!
+   *  \brief Return a state of size n that is filled with zeros.
+   */
+  static dynamic_type ZeroDynamic(size_t n) {
+    return Zero(n);
+  }
+
+  /*!
+   *  \brief Resize the state to size n, keeping the old values. New values
+   *  are zero.
+   */
+  static void Resize(state_type& x, size_t n) {
+    x.resize(n);
+  }
+};
+
+/*!
+ * \brief Creation of states with a size that is fixed at compile time.
+ *
+ * A std::array cannot be resized, so requesting any other size throws.
+ * Results with a size only known at runtime are stored in a std::vector.
+ */
+template<typename value_type, size_t size>
+struct StateTraits<std::array<value_type, size>> {
+  typedef std::array<value_type, size> state_type;
+  typedef std::vector<value_type> dynamic_type;
+
+  static state_type Zero(size_t n) {
+    CheckSize(n);
+    state_type x;
+    x.fill(0);
+    return x;
+  }
+
+  static dynamic_type ZeroDynamic(size_t n) {
+    return dynamic_type(n, 0);
+  }
+
+  static void Resize(state_type& x, size_t n) {
+    CheckSize(n);
+  }
+
+  static void CheckSize(size_t n) {
+    if (n != size) {
+      throw std::length_error("The size of a std::array cannot be changed.");
+    }
+  }
+};
+
+/*!
+ * \brief The type of the position of a system as returned by GetPosition().
+ */
+template<typename system_type>
+using system_state_type = typename std::decay<
+    decltype(std::declval<const system_type&>().GetPosition())>::type;
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_STATE_TRAITS_HPP_
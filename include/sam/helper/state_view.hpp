@@ -0,0 +1,106 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_STATE_VIEW_HPP_
+#define INCLUDE_SAM_HELPER_STATE_VIEW_HPP_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace sam {
+
+/*!
+ * \brief The type of the elements of a state.
+ */
+template<typename state_type>
+using state_value_type = typename std::decay<
+    decltype(*std::declval<const state_type&>().data())>::type;
+
+/*!
+ * \brief A read-only view of contiguous memory, e.g. the state of a system.
+ *
+ * The view does not own the data, it only stores a pointer and the size, so
+ * it can be copied for free. It stays valid as long as the state is not
+ * resized or destroyed and always shows the current values, e.g. after an
+ * integration. It provides the same read access as a std::vector, so it can
+ * be passed to most functions that take a state.
+ */
+template<typename value_type>
+class StateView {
+ public:
+  typedef const value_type* const_iterator;
+  typedef const_iterator iterator;
+
+  StateView(const value_type* data, size_t size);
+
+  const value_type& operator[](size_t i) const;
+
+  const value_type* data() const;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+ private:
+  const value_type* data_;
+  size_t size_;
+};
+
+/*!
+ * \brief Create a view of a state with data() and size().
+ */
+template<typename state_type>
+StateView<state_value_type<state_type>> MakeStateView(
+    const state_type& state);
+
+// Implementation
+
+template<typename value_type>
+StateView<value_type>::StateView(const value_type* data, size_t size)
+    : data_(data), size_(size) {}
+
+template<typename value_type>
+const value_type& StateView<value_type>::operator[](size_t i) const {
+  return data_[i];
+}
+
+template<typename value_type>
+const value_type* StateView<value_type>::data() const {
+  return data_;
+}
+
+template<typename value_type>
+size_t StateView<value_type>::size() const {
+  return size_;
+}
+
+template<typename value_type>
+bool StateView<value_type>::empty() const {
+  return size_ == 0;
+}
+
+template<typename value_type>
+typename StateView<value_type>::const_iterator StateView<value_type>::begin()
+    const {
+  return data_;
+}
+
+template<typename value_type>
+typename StateView<value_type>::const_iterator StateView<value_type>::end()
+    const {
+  return data_ + size_;
+}
+
+template<typename state_type>
+StateView<state_value_type<state_type>> MakeStateView(
+    const state_type& state) {
+  return StateView<state_value_type<state_type>>(state.data(), state.size());
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_STATE_VIEW_HPP_
@@ -0,0 +1,167 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_HELPER_THREAD_POOL_HPP_
+#define INCLUDE_SAM_HELPER_THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sam {
+
+/*!
+ * \brief A persistent pool of worker threads.
+ *
+ * The threads are started once at construction and wait for work until the
+ * pool is destroyed, so repeatedly distributing small amounts of work, e.g.
+ * once per timestep, does not pay for the creation of threads. The calling
+ * thread takes part in the work, so a pool with one thread runs everything
+ * sequentially without any synchronization.
+ */
+class ThreadPool {
+ public:
+  /*!
+   * @param number_threads The total number of threads including the calling
+   *  thread. If it is 0, the number of hardware threads is used.
+   */
+  explicit ThreadPool(unsigned int number_threads = 0);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  /*!
+   *  \brief Return the number of threads including the calling thread.
+   */
+  unsigned int GetNumberThreads() const;
+
+  /*!
+   * \brief Call task(i) for all i in [0, number_tasks) and wait until all of
+   * them are finished.
+   *
+   * The tasks are handed out dynamically, so the order in which they are
+   * processed is not defined. If a task throws, the remaining tasks are
+   * skipped and the first exception is rethrown in the calling thread.
+   */
+  template<typename task_type>
+  void ParallelFor(size_t number_tasks, task_type&& task);
+
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  std::function<void(size_t)> task_;
+  std::atomic<size_t> next_task_;
+  size_t number_tasks_;
+  unsigned int generation_;
+  unsigned int active_workers_;
+  bool stop_;
+  std::exception_ptr exception_;
+
+  void WorkerLoop();
+
+  void ProcessTasks();
+};
+
+// Implementation
+
+inline ThreadPool::ThreadPool(unsigned int number_threads)
+    : next_task_(0), number_tasks_(0), generation_(0), active_workers_(0),
+      stop_(false) {
+  if (number_threads == 0) {
+    number_threads = std::thread::hardware_concurrency();
+  }
+  for (unsigned int i = 1; i < number_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+inline unsigned int ThreadPool::GetNumberThreads() const {
+  return workers_.size() + 1;
+}
+
+template<typename task_type>
+void ThreadPool::ParallelFor(size_t number_tasks, task_type&& task) {
+  if (workers_.empty() || number_tasks < 2) {
+    for (size_t i = 0; i < number_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = std::ref(task);
+    number_tasks_ = number_tasks;
+    next_task_ = 0;
+    exception_ = nullptr;
+    active_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  ProcessTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return active_workers_ == 0; });
+  task_ = nullptr;
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+}
+
+inline void ThreadPool::WorkerLoop() {
+  unsigned int seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, seen_generation] {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+    ProcessTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --active_workers_;
+    }
+    work_done_.notify_one();
+  }
+}
+
+inline void ThreadPool::ProcessTasks() {
+  size_t i;
+  while ((i = next_task_++) < number_tasks_) {
+    try {
+      task_(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!exception_) {
+        exception_ = std::current_exception();
+      }
+      next_task_ = number_tasks_;
+    }
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_HELPER_THREAD_POOL_HPP_
@@ -0,0 +1,51 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_OBSERVER_BINARY_TRAJECTORY_OBSERVER_HPP_
+#define INCLUDE_SAM_OBSERVER_BINARY_TRAJECTORY_OBSERVER_HPP_
+
+#include <memory>
+
+#include "../helper/binary_trajectory.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Observer that streams the position and time into a binary file.
+ *
+ * In contrast to PositionObserver the trajectory is not kept in memory, it
+ * is written by a BinaryTrajectoryWriter and can be read with a
+ * BinaryTrajectoryReader. The writer is shared, because odeint copies the
+ * observer, e.g.
+ * \code
+ * auto writer = std::make_shared<sam::BinaryTrajectoryWriter>(
+ *     "trajectory.bin", std::vector<unsigned int>({N}), d, dt);
+ * system.Integrate(dt, steps,
+ *                  sam::BinaryTrajectoryObserver<state_type>(writer));
+ * writer->Close();
+ * \endcode
+ */
+template<typename state_type>
+struct BinaryTrajectoryObserver {
+  std::shared_ptr<BinaryTrajectoryWriter> writer_;
+
+  explicit BinaryTrajectoryObserver(
+      std::shared_ptr<BinaryTrajectoryWriter> writer);
+
+  void operator()(const state_type& x, double t) const;
+};
+
+// Implementation
+
+template<typename state_type>
+BinaryTrajectoryObserver<state_type>::BinaryTrajectoryObserver(
+    std::shared_ptr<BinaryTrajectoryWriter> writer) : writer_(writer) {}
+
+template<typename state_type>
+void BinaryTrajectoryObserver<state_type>::operator()(const state_type& x,
+                                                      double t) const {
+  writer_->Write(x, t);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_OBSERVER_BINARY_TRAJECTORY_OBSERVER_HPP_
@@ -18,6 +18,13 @@ struct DerivativeObserver {
                               std::vector<double>& time);
 
   void operator()(const state_type& x, double t) const;
+
+  /*!
+   * \brief Save the derivative dxdt that is passed by
+   * IntegrateWithDerivative, the ODE is not evaluated.
+   */
+  void operator()(const state_type& x, const state_type& dxdt, double t)
+      const;
 };
 
 // Implementation
@@ -35,6 +42,13 @@ void DerivativeObserver<system_type, state_type>::operator()(
   time_.push_back(t);
 }
 
+template<typename system_type, typename state_type>
+void DerivativeObserver<system_type, state_type>::operator()(
+    const state_type& x, const state_type& dxdt, double t) const {
+  derivative_.push_back(dxdt);
+  time_.push_back(t);
+}
+
 }  // namespace sam
 
 #endif  // INCLUDE_SAM_OBSERVER_DERIVATIVE_OBSERVER_HPP_
@@ -0,0 +1,45 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_OBSERVER_POINCARE_OBSERVER_HPP_
+#define INCLUDE_SAM_OBSERVER_POINCARE_OBSERVER_HPP_
+
+#include "../analysis/poincare.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Observer that records the crossings of a Poincare section.
+ *
+ * The section is kept outside of the observer, because odeint copies the
+ * observer, e.g.
+ * \code
+ * sam::PoincareSection<system_type> section(system, params);
+ * system.Integrate(dt, steps,
+ *                  sam::PoincareObserver<system_type>(section));
+ * \endcode
+ */
+template<typename system_type,
+         typename state_type = system_state_type<system_type>>
+struct PoincareObserver {
+  PoincareSection<system_type, state_type>& section_;
+
+  explicit PoincareObserver(PoincareSection<system_type, state_type>& section);
+
+  void operator()(const state_type& x, double t) const;
+};
+
+// Implementation
+
+template<typename system_type, typename state_type>
+PoincareObserver<system_type, state_type>::PoincareObserver(
+    PoincareSection<system_type, state_type>& section) : section_(section) {}
+
+template<typename system_type, typename state_type>
+void PoincareObserver<system_type, state_type>::operator()(const state_type& x,
+                                                           double t) const {
+  section_.Observe(x, t);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_OBSERVER_POINCARE_OBSERVER_HPP_
@@ -3,16 +3,24 @@
 #ifndef INCLUDE_SAM_OBSERVER_POS_DERIV_OBSERVER_HPP_
 #define INCLUDE_SAM_OBSERVER_POS_DERIV_OBSERVER_HPP_
 
-#include <memory>
 #include <vector>
 
-#include "./position_observer.hpp"
-#include "./derivative_observer.hpp"
-
 namespace sam {
 
+/*!
+ * \brief Observer for the position, the derivative and the time.
+ *
+ * Called as observer(x, t) the derivative is calculated by the system. With
+ * IntegrateWithDerivative it is called as observer(x, dxdt, t) and the
+ * derivative of the stepper is saved without evaluating the ODE again.
+ */
 template<typename system_type, typename state_type>
 struct PosDerivObserver {
+  system_type& system_;
+  std::vector<state_type>& position_;
+  std::vector<state_type>& derivative_;
+  std::vector<double>& time_;
+
   explicit PosDerivObserver(system_type& system,
                             std::vector<state_type>& position,
                             std::vector<state_type>& derivative,
@@ -20,11 +28,8 @@ struct PosDerivObserver {
 
   void operator()(const state_type& x, double t) const;
 
- protected:
-  std::shared_ptr<sam::PositionObserver<state_type>> position_observer_;
-  std::shared_ptr<sam::DerivativeObserver<system_type, state_type>>
-      derivative_observer_;
-  std::vector<double> dummy_time_;
+  void operator()(const state_type& x, const state_type& dxdt, double t)
+      const;
 };
 
 // Implementation
@@ -32,19 +37,24 @@ struct PosDerivObserver {
 template<typename system_type, typename state_type>
 PosDerivObserver<system_type, state_type>::PosDerivObserver(system_type& system,
     std::vector<state_type>& position, std::vector<state_type>& derivative,
-    std::vector<double>& time) {
-  position_observer_ = std::make_shared<sam::PositionObserver<state_type>>(
-      position, time);
-  derivative_observer_ = std::make_shared<sam::DerivativeObserver<system_type,
-                                                                  state_type>>(
-      system, derivative, dummy_time_);
-}
+    std::vector<double>& time)
+    : system_(system), position_(position), derivative_(derivative),
+      time_(time) {}
 
 template<typename system_type, typename state_type>
 void PosDerivObserver<system_type, state_type>::operator()(const state_type& x,
                                                            double t) const {
-    position_observer_->operator()(x, t);
-    derivative_observer_->operator()(x, t);
+  position_.push_back(x);
+  derivative_.push_back(system_.GetDerivative());
+  time_.push_back(t);
+}
+
+template<typename system_type, typename state_type>
+void PosDerivObserver<system_type, state_type>::operator()(
+    const state_type& x, const state_type& dxdt, double t) const {
+  position_.push_back(x);
+  derivative_.push_back(dxdt);
+  time_.push_back(t);
 }
 
 }  // namespace sam
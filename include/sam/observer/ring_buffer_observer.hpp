@@ -0,0 +1,82 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_OBSERVER_RING_BUFFER_OBSERVER_HPP_
+#define INCLUDE_SAM_OBSERVER_RING_BUFFER_OBSERVER_HPP_
+
+#include "../helper/ring_buffer.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Observer that keeps the last positions in a RingBuffer.
+ *
+ * In contrast to PositionObserver the memory is constant and allocated
+ * before the integration, e.g. to keep the last samples before a crossing.
+ */
+template<typename state_type>
+struct RingBufferObserver {
+  RingBuffer<state_type>& buffer_;
+
+  explicit RingBufferObserver(RingBuffer<state_type>& buffer);
+
+  void operator()(const state_type& x, double t) const;
+};
+
+/*!
+ * \brief Observer that keeps the last derivatives in a RingBuffer.
+ *
+ * The derivative is written directly into the buffer with
+ * GetDerivative(state_type&), so nothing is allocated during the
+ * integration.
+ */
+template<typename system_type, typename state_type>
+struct DerivativeRingBufferObserver {
+  system_type& system_;
+  RingBuffer<state_type>& buffer_;
+
+  explicit DerivativeRingBufferObserver(system_type& system,
+                                        RingBuffer<state_type>& buffer);
+
+  void operator()(const state_type& x, double t) const;
+
+  /*!
+   * \brief Keep the derivative dxdt that is passed by
+   * IntegrateWithDerivative.
+   */
+  void operator()(const state_type& x, const state_type& dxdt, double t)
+      const;
+};
+
+// Implementation
+
+template<typename state_type>
+RingBufferObserver<state_type>::RingBufferObserver(
+    RingBuffer<state_type>& buffer) : buffer_(buffer) {}
+
+template<typename state_type>
+void RingBufferObserver<state_type>::operator()(const state_type& x,
+                                                double t) const {
+  buffer_.Push(x, t);
+}
+
+template<typename system_type, typename state_type>
+DerivativeRingBufferObserver<system_type, state_type>::
+    DerivativeRingBufferObserver(system_type& system,
+                                 RingBuffer<state_type>& buffer)
+    : system_(system), buffer_(buffer) {}
+
+template<typename system_type, typename state_type>
+void DerivativeRingBufferObserver<system_type, state_type>::operator()(
+    const state_type& x, double t) const {
+  system_.GetDerivative(buffer_.Next(t));
+}
+
+template<typename system_type, typename state_type>
+void DerivativeRingBufferObserver<system_type, state_type>::operator()(
+    const state_type& x, const state_type& dxdt, double t) const {
+  buffer_.Push(dxdt, t);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_OBSERVER_RING_BUFFER_OBSERVER_HPP_
@@ -0,0 +1,76 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_OBSERVER_STRIDE_OBSERVER_HPP_
+#define INCLUDE_SAM_OBSERVER_STRIDE_OBSERVER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace sam {
+
+/*!
+ * \brief Observer that only passes every stride-th observation to another
+ * observer.
+ *
+ * The first observation is passed on. The counter is shared between copies,
+ * so the decimation continues over several calls of Integrate, which copy
+ * the observer, e.g.
+ * \code
+ * auto observer = sam::MakeStrideObserver(
+ *     sam::PositionObserver<state_type>(x, t), 10);
+ * \endcode
+ */
+template<typename observer_type>
+struct StrideObserver {
+  mutable observer_type observer_;
+  unsigned int stride_;
+  std::shared_ptr<size_t> counter_;
+
+  /*!
+   * @throws std::invalid_argument If the stride is 0.
+   */
+  explicit StrideObserver(observer_type observer, unsigned int stride);
+
+  template<typename state_type>
+  void operator()(const state_type& x, double t) const;
+};
+
+template<typename observer_type>
+StrideObserver<observer_type> MakeStrideObserver(observer_type observer,
+                                                 unsigned int stride);
+
+// Implementation
+
+template<typename observer_type>
+StrideObserver<observer_type>::StrideObserver(observer_type observer,
+                                              unsigned int stride)
+    : observer_(observer), stride_(stride),
+      counter_(std::make_shared<size_t>(0)) {
+  if (stride == 0) {
+    throw std::invalid_argument("The stride has to be positive.");
+  }
+}
+
+template<typename observer_type>
+template<typename state_type>
+void StrideObserver<observer_type>::operator()(const state_type& x,
+                                               double t) const {
+  if (*counter_ == 0) {
+    observer_(x, t);
+  }
+  ++(*counter_);
+  if (*counter_ == stride_) {
+    *counter_ = 0;
+  }
+}
+
+template<typename observer_type>
+StrideObserver<observer_type> MakeStrideObserver(observer_type observer,
+                                                 unsigned int stride) {
+  return StrideObserver<observer_type>(observer, stride);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_OBSERVER_STRIDE_OBSERVER_HPP_
@@ -0,0 +1,57 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_OBSERVER_TIME_WINDOW_OBSERVER_HPP_
+#define INCLUDE_SAM_OBSERVER_TIME_WINDOW_OBSERVER_HPP_
+
+#include <limits>
+
+namespace sam {
+
+/*!
+ * \brief Observer that only passes the observations in the time window
+ * [t_start, t_end] to another observer, e.g. to skip a transient.
+ */
+template<typename observer_type>
+struct TimeWindowObserver {
+  mutable observer_type observer_;
+  double t_start_;
+  double t_end_;
+
+  explicit TimeWindowObserver(
+      observer_type observer, double t_start,
+      double t_end = std::numeric_limits<double>::infinity());
+
+  template<typename state_type>
+  void operator()(const state_type& x, double t) const;
+};
+
+template<typename observer_type>
+TimeWindowObserver<observer_type> MakeTimeWindowObserver(
+    observer_type observer, double t_start,
+    double t_end = std::numeric_limits<double>::infinity());
+
+// Implementation
+
+template<typename observer_type>
+TimeWindowObserver<observer_type>::TimeWindowObserver(
+    observer_type observer, double t_start, double t_end)
+    : observer_(observer), t_start_(t_start), t_end_(t_end) {}
+
+template<typename observer_type>
+template<typename state_type>
+void TimeWindowObserver<observer_type>::operator()(const state_type& x,
+                                                   double t) const {
+  if (t >= t_start_ && t <= t_end_) {
+    observer_(x, t);
+  }
+}
+
+template<typename observer_type>
+TimeWindowObserver<observer_type> MakeTimeWindowObserver(
+    observer_type observer, double t_start, double t_end) {
+  return TimeWindowObserver<observer_type>(observer, t_start, t_end);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_OBSERVER_TIME_WINDOW_OBSERVER_HPP_
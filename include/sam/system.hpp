@@ -5,6 +5,9 @@
 
 #include <sam/system/generic_system.hpp>
 #include <sam/system/euler_system.hpp>
+#include <sam/system/heun_system.hpp>
 #include <sam/system/rk4_system.hpp>
+#include <sam/system/dopri5_system.hpp>
+#include <sam/system/fixed_system.hpp>
 
 #endif  // INCLUDE_SAM_SYSTEM_HPP_
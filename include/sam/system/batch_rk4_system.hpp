@@ -0,0 +1,345 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_BATCH_RK4_SYSTEM_HPP_
+#define INCLUDE_SAM_SYSTEM_BATCH_RK4_SYSTEM_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/numeric/odeint/stepper/runge_kutta4.hpp>
+#include <boost/ref.hpp>
+
+#include "../helper/pack.hpp"
+#include "./ensemble.hpp"
+
+namespace sam {
+
+/*! \brief An ensemble of systems with the same ODE that is integrated in SIMD
+ * lanes with a 4th order Runge-Kutta method.
+ *
+ * The members of the ensemble differ only in the parameters of the ODE.
+ * They are grouped into batches of pack_type::size() members, which are
+ * stored interleaved, so the member index is the innermost index. Every
+ * coordinate of the state is a pack that holds the coordinate of all
+ * members in the batch, so every operation of the Runge-Kutta stages is done
+ * for all members of a batch at once.
+ *
+ * The ODE is constructed once per batch with every parameter given as a pack,
+ * so it has to work with pack_type as value type, e.g.
+ * \code
+ * template<typename value_type>
+ * struct ODE {
+ *   value_type omega_;
+ *   explicit ODE(value_type omega): omega_(omega) {}
+ *   template<typename state_type>
+ *   void operator()(const state_type& x, state_type& dx, double t) {...}
+ * };
+ * \endcode
+ * If the number of members is not a multiple of the number of lanes, the
+ * last batch is filled up with copies of the last member. By default the
+ * number of lanes fills one SIMD register of the target, see NativePack.
+ */
+template<typename ODE, typename pack_type = NativePack<double>>
+class BatchRK4System {
+ public:
+  typedef std::vector<double> state_type;
+  typedef std::vector<pack_type, AlignedAllocator<pack_type>>
+      batch_state_type;
+
+  /*!
+   * @param system_size Number of elements in every member.
+   * @param dimension Number of ODEs per element.
+   * @param parameters The parameters of the ODE for every member.
+   */
+  template<typename... Ts>
+  explicit BatchRK4System(unsigned int system_size, unsigned int dimension,
+                          const std::vector<std::tuple<Ts...>>& parameters);
+
+  /*!
+   *  \brief Return the number of members in the ensemble.
+   */
+  size_t GetNumberMembers() const;
+
+  /*!
+   *  \brief Return the position in the state space of one member.
+   *
+   *  @throws std::out_of_range
+   */
+  state_type GetPosition(size_t member) const;
+
+  /*!
+   *  \brief Set the position in the state space of one member.
+   *
+   *  @throws std::out_of_range
+   *  @throws std::length_error
+   */
+  void SetPosition(size_t member, const state_type& new_position);
+
+  /*!
+   *  \brief Set the same position in the state space for all members.
+   *
+   *  @throws std::length_error
+   */
+  void SetPosition(const state_type& new_position);
+
+  /*!
+   *  \brief Return the derivative of one member at its current position.
+   *
+   *  @throws std::out_of_range
+   */
+  state_type GetDerivative(size_t member) const;
+
+  /*!
+   *  \brief Get the time of the system.
+   */
+  double GetTime() const;
+
+  /*!
+   *  \brief Set the current time for the system.
+   */
+  void SetTime(double t);
+
+  /*!
+   *  \brief Return the dimensionality of every member.
+   *
+   *  Get the dimensionality as a pair in the form
+   *  (number of oscillators, dimensionality of the oscillator).
+   */
+  std::pair<unsigned int, unsigned int> GetDimension() const;
+
+  /*!
+   * \brief Integrate all members.
+   *
+   * Every member has its own observer like in Ensemble, it is called with the
+   * position of the member as state_type, so all observers of a single
+   * system can be used. The batches are integrated one after the other and
+   * the positions are only extracted from the batches, if the observers are
+   * not null_observer.
+   *
+   * @param dt Timestep for the integration.
+   * @param number_steps The total number of timesteps.
+   * @param observer_factory A callable that takes the index of a member and
+   *  returns the observer for its integration. It is called once per member
+   *  and integration.
+   */
+  template<typename observer_factory_type = NullObserverFactory>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_factory_type observer_factory
+                     = NullObserverFactory());
+
+ private:
+  unsigned int N_, d_;
+  size_t number_members_;
+  std::vector<ODE, AlignedAllocator<ODE>> ode_;
+  std::vector<batch_state_type> x_;
+  double t_;
+  boost::numeric::odeint::runge_kutta4<batch_state_type, double,
+                                       batch_state_type, double> stepper_;
+
+  template<typename parameter_type, size_t... indices>
+  void AddBatch(const parameter_type& parameters, size_t first_member,
+                std::index_sequence<indices...>);
+
+  template<size_t index, typename parameter_type>
+  pack_type GatherParameter(const parameter_type& parameters,
+                            size_t first_member) const;
+
+  void CheckMember(size_t member) const;
+
+  template<typename observer_factory_type>
+  double IntegrateBatch(size_t b, double dt, unsigned int number_steps,
+                        observer_factory_type& observer_factory,
+                        std::true_type null_observers);
+
+  template<typename observer_factory_type>
+  double IntegrateBatch(size_t b, double dt, unsigned int number_steps,
+                        observer_factory_type& observer_factory,
+                        std::false_type null_observers);
+};
+
+// Implementation
+
+template<typename ODE, typename pack_type>
+template<typename... Ts>
+BatchRK4System<ODE, pack_type>::BatchRK4System(
+    unsigned int system_size, unsigned int dimension,
+    const std::vector<std::tuple<Ts...>>& parameters) {
+  if (parameters.empty()) {
+    throw std::length_error("BatchRK4System needs at least one member.");
+  }
+  N_ = system_size;
+  d_ = dimension;
+  number_members_ = parameters.size();
+  t_ = 0.;
+  for (size_t first = 0; first < number_members_; first += pack_type::size()) {
+    AddBatch(parameters, first, std::index_sequence_for<Ts...>());
+    x_.push_back(batch_state_type(N_*d_, pack_type(0.)));
+  }
+}
+
+template<typename ODE, typename pack_type>
+template<typename parameter_type, size_t... indices>
+void BatchRK4System<ODE, pack_type>::AddBatch(
+    const parameter_type& parameters, size_t first_member,
+    std::index_sequence<indices...>) {
+  ode_.emplace_back(GatherParameter<indices>(parameters, first_member)...);
+}
+
+template<typename ODE, typename pack_type>
+template<size_t index, typename parameter_type>
+pack_type BatchRK4System<ODE, pack_type>::GatherParameter(
+    const parameter_type& parameters, size_t first_member) const {
+  pack_type pack;
+  for (unsigned int lane = 0; lane < pack_type::size(); ++lane) {
+    size_t member = std::min(first_member + lane, parameters.size() - 1);
+    pack[lane] = std::get<index>(parameters[member]);
+  }
+  return pack;
+}
+
+template<typename ODE, typename pack_type>
+void BatchRK4System<ODE, pack_type>::CheckMember(size_t member) const {
+  if (member >= number_members_) {
+    throw std::out_of_range("The member is not in the ensemble!");
+  }
+}
+
+template<typename ODE, typename pack_type>
+size_t BatchRK4System<ODE, pack_type>::GetNumberMembers() const {
+  return number_members_;
+}
+
+template<typename ODE, typename pack_type>
+std::vector<double> BatchRK4System<ODE, pack_type>::GetPosition(
+    size_t member) const {
+  CheckMember(member);
+  const batch_state_type& batch = x_[member/pack_type::size()];
+  unsigned int lane = member%pack_type::size();
+  state_type position(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    position[i] = batch[i][lane];
+  }
+  return position;
+}
+
+template<typename ODE, typename pack_type>
+void BatchRK4System<ODE, pack_type>::SetPosition(
+    size_t member, const state_type& new_position) {
+  CheckMember(member);
+  if (new_position.size() != N_*d_) {
+    throw std::length_error("Trying to set new position of wrong length!");
+  }
+  batch_state_type& batch = x_[member/pack_type::size()];
+  unsigned int lane = member%pack_type::size();
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i][lane] = new_position[i];
+  }
+}
+
+template<typename ODE, typename pack_type>
+void BatchRK4System<ODE, pack_type>::SetPosition(
+    const state_type& new_position) {
+  if (new_position.size() != N_*d_) {
+    throw std::length_error("Trying to set new position of wrong length!");
+  }
+  for (size_t b = 0; b < x_.size(); ++b) {
+    for (size_t i = 0; i < x_[b].size(); ++i) {
+      x_[b][i] = pack_type(new_position[i]);
+    }
+  }
+}
+
+template<typename ODE, typename pack_type>
+std::vector<double> BatchRK4System<ODE, pack_type>::GetDerivative(
+    size_t member) const {
+  CheckMember(member);
+  size_t b = member/pack_type::size();
+  unsigned int lane = member%pack_type::size();
+  batch_state_type intermediate(x_[b].size());
+  ODE ode = ode_[b];
+  ode(x_[b], intermediate, t_);
+  state_type derivative(intermediate.size());
+  for (size_t i = 0; i < intermediate.size(); ++i) {
+    derivative[i] = intermediate[i][lane];
+  }
+  return derivative;
+}
+
+template<typename ODE, typename pack_type>
+double BatchRK4System<ODE, pack_type>::GetTime() const {
+  return t_;
+}
+
+template<typename ODE, typename pack_type>
+void BatchRK4System<ODE, pack_type>::SetTime(double t) {
+  t_ = t;
+}
+
+template<typename ODE, typename pack_type>
+std::pair<unsigned int, unsigned int> BatchRK4System<ODE, pack_type>::
+    GetDimension() const {
+  return std::make_pair(N_, d_);
+}
+
+template<typename ODE, typename pack_type>
+template<typename observer_factory_type>
+void BatchRK4System<ODE, pack_type>::Integrate(
+    double dt, unsigned int number_steps,
+    observer_factory_type observer_factory) {
+  typedef decltype(observer_factory(size_t(0))) observer_type;
+  typedef std::is_same<observer_type, boost::numeric::odeint::null_observer>
+      null_observers;
+  double t_end = t_;
+  for (size_t b = 0; b < x_.size(); ++b) {
+    t_end = IntegrateBatch(b, dt, number_steps, observer_factory,
+                           null_observers());
+  }
+  t_ = t_end;
+}
+
+template<typename ODE, typename pack_type>
+template<typename observer_factory_type>
+double BatchRK4System<ODE, pack_type>::IntegrateBatch(
+    size_t b, double dt, unsigned int number_steps,
+    observer_factory_type& observer_factory, std::true_type null_observers) {
+  return boost::numeric::odeint::integrate_n_steps(
+      boost::ref(stepper_), boost::ref(ode_[b]), x_[b], t_, dt, number_steps,
+      boost::numeric::odeint::null_observer());
+}
+
+template<typename ODE, typename pack_type>
+template<typename observer_factory_type>
+double BatchRK4System<ODE, pack_type>::IntegrateBatch(
+    size_t b, double dt, unsigned int number_steps,
+    observer_factory_type& observer_factory, std::false_type null_observers) {
+  const size_t first = b*pack_type::size();
+  const size_t lanes = std::min<size_t>(pack_type::size(),
+                                        number_members_ - first);
+  std::vector<decltype(observer_factory(first))> observers;
+  for (size_t lane = 0; lane < lanes; ++lane) {
+    observers.push_back(observer_factory(first + lane));
+  }
+  state_type position(N_*d_);
+  auto observer = [&](const batch_state_type& x, double t) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      for (size_t i = 0; i < x.size(); ++i) {
+        position[i] = x[i][lane];
+      }
+      observers[lane](position, t);
+    }
+  };
+  return boost::numeric::odeint::integrate_n_steps(
+      boost::ref(stepper_), boost::ref(ode_[b]), x_[b], t_, dt, number_steps,
+      observer);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_BATCH_RK4_SYSTEM_HPP_
@@ -0,0 +1,153 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_DOPRI5_SYSTEM_HPP_
+#define INCLUDE_SAM_SYSTEM_DOPRI5_SYSTEM_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/numeric/odeint/integrate/integrate_adaptive.hpp>
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/numeric/odeint/stepper/generation.hpp>
+#include <boost/numeric/odeint/stepper/runge_kutta_dopri5.hpp>
+#include <boost/ref.hpp>
+
+#include "./generic_system.hpp"
+
+namespace sam {
+
+/*! \brief A system that is integrated with an adaptive Dormand-Prince method.
+ *
+ * A system that is integrated with the embedded Runge-Kutta-Dormand-Prince
+ * method of order 5(4). The stepsize is controlled by the error estimate of
+ * the embedded method and intermediate points are calculated with the dense
+ * output of the stepper, so the observer can still be called on an
+ * equidistant grid. The integrator is implemented by the odeint library in
+ * boost
+ * (https://www.boost.org/doc/libs/1_72_0/libs/numeric/odeint/doc/html/index.html).
+ */
+template<typename ODE, typename state_type = std::vector<double>>
+class DOPRI5System: public GenericSystem<ODE, state_type> {
+ public:
+  template<typename... Ts>
+  explicit DOPRI5System(unsigned int system_size, unsigned int dimension,
+                        Ts... parameters);
+
+  /*!
+   * \brief Integrate the system and observe it on an equidistant grid.
+   *
+   * The internal steps are chosen adaptively, the observer is called with the
+   * dense output at the times t_0 + i*dt for i = 0, ..., number_steps.
+   *
+   * @param dt Timestep between two calls of the observer.
+   * @param number_steps The total number of observed timesteps.
+   * @param observer The observer of the integration.
+   */
+  template<typename observer_type = boost::numeric::odeint::null_observer>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_type observer
+                     = boost::numeric::odeint::null_observer());
+
+  /*!
+   * \brief Integrate the system up to the time t_end.
+   *
+   * The observer is called after every internal adaptive step, so the times
+   * at which it is called are not equidistant.
+   *
+   * @param t_end The time at which the integration stops.
+   * @param observer The observer of the integration.
+   *
+   * @returns The number of adaptive steps that were taken.
+   */
+  template<typename observer_type = boost::numeric::odeint::null_observer>
+  size_t IntegrateUntil(double t_end,
+                        observer_type observer
+                            = boost::numeric::odeint::null_observer());
+
+  /*!
+   *  \brief Set the absolute and relative error tolerance for the stepsize
+   *  control.
+   */
+  void SetTolerance(double absolute_error, double relative_error);
+
+  /*!
+   *  \brief Return the last stepsize chosen by the stepsize control.
+   */
+  double GetStepSize() const;
+
+ private:
+  typedef boost::numeric::odeint::runge_kutta_dopri5<state_type> error_stepper;
+  typedef typename boost::numeric::odeint::result_of::make_dense_output<
+      error_stepper>::type dense_stepper;
+
+  double absolute_error_ = 1e-6;
+  double relative_error_ = 1e-6;
+  double dt_ = 0.01;
+  dense_stepper stepper_;
+
+  // keep the last stepsize of the controller as initial guess for the next
+  // integration, the final step is shortened to hit the end time exactly
+  void UpdateStepSize();
+};
+
+// Implementation
+
+template<typename ODE, typename state_type>
+template<typename... Ts>
+DOPRI5System<ODE, state_type>::DOPRI5System(unsigned int system_size,
+                                            unsigned int dimension,
+                                            Ts... parameters)
+    : GenericSystem<ODE, state_type>(system_size, dimension, parameters...) {
+  SetTolerance(absolute_error_, relative_error_);
+}
+
+template<typename ODE, typename state_type>
+template<typename observer_type>
+void DOPRI5System<ODE, state_type>::Integrate(double dt,
+                                              unsigned int number_steps,
+                                              observer_type observer) {
+  this->t_ = boost::numeric::odeint::integrate_n_steps(
+      boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_, dt,
+      number_steps, observer);
+  // odeint leaves the state at the last but one observation point
+  stepper_.calc_state(this->t_, this->x_);
+  UpdateStepSize();
+}
+
+template<typename ODE, typename state_type>
+template<typename observer_type>
+size_t DOPRI5System<ODE, state_type>::IntegrateUntil(double t_end,
+                                                     observer_type observer) {
+  size_t steps = boost::numeric::odeint::integrate_adaptive(
+      boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_,
+      t_end, dt_, observer);
+  this->t_ = t_end;
+  UpdateStepSize();
+  return steps;
+}
+
+template<typename ODE, typename state_type>
+void DOPRI5System<ODE, state_type>::SetTolerance(double absolute_error,
+                                                 double relative_error) {
+  absolute_error_ = absolute_error;
+  relative_error_ = relative_error;
+  stepper_ = boost::numeric::odeint::make_dense_output(
+      absolute_error_, relative_error_, error_stepper());
+}
+
+template<typename ODE, typename state_type>
+double DOPRI5System<ODE, state_type>::GetStepSize() const {
+  return dt_;
+}
+
+template<typename ODE, typename state_type>
+void DOPRI5System<ODE, state_type>::UpdateStepSize() {
+  if (stepper_.current_time_step() > 0.) {
+    dt_ = stepper_.current_time_step();
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_DOPRI5_SYSTEM_HPP_
@@ -0,0 +1,166 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_ENSEMBLE_HPP_
+#define INCLUDE_SAM_SYSTEM_ENSEMBLE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+
+#include "../helper/thread_pool.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Observer factory that returns a null_observer for every member.
+ */
+struct NullObserverFactory {
+  boost::numeric::odeint::null_observer operator()(size_t member) const {
+    return boost::numeric::odeint::null_observer();
+  }
+};
+
+/*!
+ * \brief An ensemble of copies of a system that only differ in the parameters
+ * of the ODE.
+ *
+ * Every member of the ensemble is a copy of the prototype system, including
+ * its position and time, for which SetParameters was called with one entry of
+ * the parameter grid. The members are integrated in parallel on a thread
+ * pool. The order of the members is always the order of the parameter grid,
+ * independent of the number of threads.
+ */
+template<typename system_type>
+class Ensemble {
+ public:
+  /*!
+   * @param prototype The system that is copied for every member.
+   * @param parameters The parameters for every member, they are passed to
+   *  SetParameters of the member.
+   * @param number_threads The number of threads for the integration, if it is
+   *  0 the number of hardware threads is used.
+   */
+  template<typename... Ts>
+  explicit Ensemble(const system_type& prototype,
+                    const std::vector<std::tuple<Ts...>>& parameters,
+                    unsigned int number_threads = 0);
+
+  /*!
+   *  \brief Return the number of members in the ensemble.
+   */
+  size_t GetSize() const;
+
+  /*!
+   *  \brief Return the member at position i of the parameter grid.
+   */
+  system_type& GetMember(size_t i);
+
+  const system_type& GetMember(size_t i) const;
+
+  /*!
+   *  \brief Return the positions of all members in the order of the
+   *  parameter grid.
+   */
+  auto GetPositions() const
+      -> std::vector<decltype(std::declval<const system_type&>()
+                                  .GetPosition())>;
+
+  /*!
+   *  \brief Set the time of all members.
+   */
+  void SetTime(double t);
+
+  /*!
+   * \brief Integrate all members in parallel.
+   *
+   * @param dt Timestep for the integration.
+   * @param number_steps The total number of timesteps.
+   * @param observer_factory A callable that takes the index of a member and
+   *  returns the observer for its integration. It is called once per member
+   *  and call of Integrate, possibly from different threads.
+   */
+  template<typename observer_factory_type = NullObserverFactory>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_factory_type observer_factory
+                     = NullObserverFactory());
+
+ private:
+  std::vector<system_type> members_;
+  std::unique_ptr<ThreadPool> pool_;
+};
+
+// Implementation
+
+template<typename system_type, typename parameter_type, size_t... indices>
+void SetParametersFromTuple(system_type& system,
+                            const parameter_type& parameters,
+                            std::index_sequence<indices...>) {
+  system.SetParameters(std::get<indices>(parameters)...);
+}
+
+template<typename system_type>
+template<typename... Ts>
+Ensemble<system_type>::Ensemble(
+    const system_type& prototype,
+    const std::vector<std::tuple<Ts...>>& parameters,
+    unsigned int number_threads) {
+  members_.reserve(parameters.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    members_.push_back(prototype);
+    SetParametersFromTuple(members_.back(), parameters[i],
+                           std::index_sequence_for<Ts...>());
+  }
+  pool_ = std::make_unique<ThreadPool>(number_threads);
+}
+
+template<typename system_type>
+size_t Ensemble<system_type>::GetSize() const {
+  return members_.size();
+}
+
+template<typename system_type>
+system_type& Ensemble<system_type>::GetMember(size_t i) {
+  return members_[i];
+}
+
+template<typename system_type>
+const system_type& Ensemble<system_type>::GetMember(size_t i) const {
+  return members_[i];
+}
+
+template<typename system_type>
+auto Ensemble<system_type>::GetPositions() const
+    -> std::vector<decltype(std::declval<const system_type&>()
+                                .GetPosition())> {
+  std::vector<decltype(std::declval<const system_type&>().GetPosition())>
+      positions;
+  positions.reserve(members_.size());
+  for (size_t i = 0; i < members_.size(); ++i) {
+    positions.push_back(members_[i].GetPosition());
+  }
+  return positions;
+}
+
+template<typename system_type>
+void Ensemble<system_type>::SetTime(double t) {
+  for (size_t i = 0; i < members_.size(); ++i) {
+    members_[i].SetTime(t);
+  }
+}
+
+template<typename system_type>
+template<typename observer_factory_type>
+void Ensemble<system_type>::Integrate(double dt, unsigned int number_steps,
+                                      observer_factory_type observer_factory) {
+  pool_->ParallelFor(members_.size(), [&](size_t i) {
+    members_[i].Integrate(dt, number_steps, observer_factory(i));
+  });
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_ENSEMBLE_HPP_
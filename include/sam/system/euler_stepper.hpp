@@ -0,0 +1,119 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_EULER_STEPPER_HPP_
+#define INCLUDE_SAM_SYSTEM_EULER_STEPPER_HPP_
+
+#include <cstddef>
+
+#include <boost/numeric/odeint/stepper/stepper_categories.hpp>
+#include <boost/numeric/odeint/util/unwrap_reference.hpp>
+
+namespace sam {
+
+/*!
+ * \brief Calculate y = y + a*x in a single loop.
+ */
+template<typename state_type>
+void Axpy(double a, const state_type& x, state_type& y) {
+  const size_t n = y.size();
+  for (size_t i = 0; i < n; ++i) y[i] += a*x[i];
+}
+
+/*! \brief Stepper for the Euler method of order O(dt).
+ *
+ * The stepper owns the buffer for the derivative, so after the first step no
+ * memory is allocated anymore as long as the size of the state does not
+ * change. It fulfills the stepper concept of odeint, so it can be used with
+ * the integrate functions of odeint. The ODE can be passed with boost::ref to
+ * avoid a copy.
+ */
+template<typename state>
+class EulerStepper {
+ public:
+  typedef state state_type;
+  typedef state deriv_type;
+  typedef double value_type;
+  typedef double time_type;
+  typedef unsigned short order_type;  // NOLINT(runtime/int)
+  typedef boost::numeric::odeint::stepper_tag stepper_category;
+
+  static order_type order() { return 1; }
+
+  /*!
+   *  \brief Do one step x_{n+1} = x_n + f(x_n, t_n) dt.
+   */
+  template<typename system_type>
+  void do_step(system_type system, state_type& x, double t, double dt);
+
+ protected:
+  state_type dx_;
+
+  void ResizeBuffer(state_type& buffer, const state_type& x) const;
+};
+
+/*! \brief Stepper for the Heun method of order O(dt^2).
+ *
+ * The Heun method is the trapezoidal rule with an Euler predictor,
+ * \f[ \tilde{x} = x_n + f(x_n, t_n) dt, \f]
+ * \f[ x_{n+1} = x_n + \frac{dt}{2} (f(x_n, t_n)
+ *               + f(\tilde{x}, t_n + dt)). \f]
+ * It uses the derivative buffer of the Euler stepper for the first stage.
+ */
+template<typename state>
+class HeunStepper: public EulerStepper<state> {
+ public:
+  using typename EulerStepper<state>::state_type;
+  using typename EulerStepper<state>::order_type;
+
+  static order_type order() { return 2; }
+
+  template<typename system_type>
+  void do_step(system_type system, state_type& x, double t, double dt);
+
+ protected:
+  state_type x_predictor_;
+  state_type dx_predictor_;
+};
+
+// Implementation
+
+template<typename state>
+template<typename system_type>
+void EulerStepper<state>::do_step(system_type system, state_type& x, double t,
+                                  double dt) {
+  typename boost::numeric::odeint::unwrap_reference<system_type>::type& ode
+      = system;
+  ResizeBuffer(dx_, x);
+  ode(x, dx_, t);
+  Axpy(dt, dx_, x);
+}
+
+template<typename state>
+void EulerStepper<state>::ResizeBuffer(state_type& buffer,
+                                       const state_type& x) const {
+  if (buffer.size() != x.size()) {
+    buffer.resize(x.size());
+  }
+}
+
+template<typename state>
+template<typename system_type>
+void HeunStepper<state>::do_step(system_type system, state_type& x, double t,
+                                 double dt) {
+  typename boost::numeric::odeint::unwrap_reference<system_type>::type& ode
+      = system;
+  this->ResizeBuffer(this->dx_, x);
+  this->ResizeBuffer(x_predictor_, x);
+  this->ResizeBuffer(dx_predictor_, x);
+  ode(x, this->dx_, t);
+  const size_t n = x.size();
+  for (size_t i = 0; i < n; ++i) x_predictor_[i] = x[i] + dt*this->dx_[i];
+  ode(x_predictor_, dx_predictor_, t + dt);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] += 0.5*dt*(this->dx_[i] + dx_predictor_[i]);
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_EULER_STEPPER_HPP_
@@ -5,8 +5,11 @@
 
 #include <vector>
 
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
 #include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/ref.hpp>
 
+#include "./euler_stepper.hpp"
 #include "./generic_system.hpp"
 
 namespace sam {
@@ -16,7 +19,9 @@ namespace sam {
  * A system that is integrated with an Euler method of order O(dt). The Euler
  * method is defined as
  * \f[ x_{n+1} = x_{n} + f_n dt, \f]
- * where \f$ f_n \f$ is the derivative at timestep \f$ n \f$.
+ * where \f$ f_n \f$ is the derivative at timestep \f$ n \f$. The buffer for
+ * the derivative is kept between the steps, so no memory is allocated during
+ * the integration.
  */
 template<typename ODE, typename state_type = std::vector<double>>
 class EulerSystem: public GenericSystem<ODE, state_type> {
@@ -31,9 +36,7 @@ class EulerSystem: public GenericSystem<ODE, state_type> {
                      = boost::numeric::odeint::null_observer());
 
  private:
-  template<typename system_type, typename observer_type>
-  double EulerMethod(system_type system, state_type& x, double t, double dt,
-                     unsigned int number_steps, observer_type observer);
+  EulerStepper<state_type> stepper_;
 };
 
 // Implementation
@@ -50,28 +53,9 @@ template<typename observer_type>
 void EulerSystem<ODE, state_type>::Integrate(double dt,
                                              unsigned int number_steps,
                                              observer_type observer) {
-    this->t_ = EulerMethod(*(this->ode_), this->x_, this->t_, dt, number_steps,
-                           observer);
-}
-
-template<typename ODE, typename state_type>
-template<typename system_type, typename observer_type>
-double EulerSystem<ODE, state_type>::EulerMethod(system_type system,
-                                                 state_type& x, double t,
-                                                 double dt,
-                                                 unsigned int number_steps,
-                                                 observer_type observer) {
-  observer(x, t);
-  for (unsigned int i = 0; i < number_steps; ++i) {
-    // TODO(boundter): copy the value? how to best initialize?
-    state_type dx = x;
-    system(x, dx, t);
-    // TODO(boundter): Rather use iterators
-    for (size_t j = 0; j < x.size(); ++j) x[j] += dx[j]*dt;
-    t += dt;
-    observer(x, t);
-  }
-  return t;
+    this->t_ = boost::numeric::odeint::integrate_n_steps(
+        boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_,
+        dt, number_steps, observer);
 }
 
 }  // namespace sam
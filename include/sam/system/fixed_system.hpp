@@ -0,0 +1,391 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_FIXED_SYSTEM_HPP_
+#define INCLUDE_SAM_SYSTEM_FIXED_SYSTEM_HPP_
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <utility>
+
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/numeric/odeint/stepper/stepper_categories.hpp>
+#include <boost/numeric/odeint/util/unwrap_reference.hpp>
+#include <boost/ref.hpp>
+
+#include "../helper/coordinate_helper.hpp"
+#include "../helper/fast_math.hpp"
+#include "../helper/state_view.hpp"
+#include "./integrate_with_derivative.hpp"
+
+namespace sam {
+
+/*!
+ * \brief Call f(0), f(1), ..., f(n-1) for the indices of the sequence.
+ *
+ * The calls are expanded by the compiler, so the loop is fully unrolled and
+ * every index is a constant.
+ */
+template<typename function_type, size_t... indices>
+inline void UnrolledFor(function_type&& f, std::index_sequence<indices...>) {
+  int expand[] = {0, (f(indices), 0)...};
+  static_cast<void>(expand);
+}
+
+/*! \brief 4th order Runge-Kutta stepper for a std::array state.
+ *
+ * The stages are kept in std::arrays in the stepper and all loops over the
+ * state are unrolled at compile time, so it should only be used for small
+ * states. It fulfills the stepper concept of odeint.
+ */
+template<typename state>
+class FixedRK4Stepper {
+ public:
+  typedef state state_type;
+  typedef state deriv_type;
+  typedef double value_type;
+  typedef double time_type;
+  typedef unsigned short order_type;  // NOLINT(runtime/int)
+  typedef boost::numeric::odeint::stepper_tag stepper_category;
+
+  static order_type order() { return 4; }
+
+  /*!
+   *  \brief Do one step of the classical Runge-Kutta method.
+   */
+  template<typename system_type>
+  void do_step(system_type system, state_type& x, double t, double dt);
+
+  /*!
+   *  \brief Do one step with the known derivative dxdt at (x, t), it is used
+   *  as the first stage.
+   */
+  template<typename system_type>
+  void do_step(system_type system, state_type& x, const deriv_type& dxdt,
+               double t, double dt);
+
+ private:
+  typedef std::make_index_sequence<std::tuple_size<state>::value> indices;
+
+  state_type k1_, k2_, k3_, k4_, x_tmp_;
+
+  template<typename ode_type>
+  void DoStages(ode_type& ode, state_type& x, const deriv_type& dxdt,
+                double t, double dt);
+};
+
+/*! \brief A system of N oscillators of dimension D known at compile time,
+ * that is integrated with a 4th order Runge-Kutta method.
+ *
+ * The state is a std::array, the ODE is stored by value and the loops of the
+ * Runge-Kutta stages are unrolled, so no memory is allocated during the
+ * integration and copying the system is cheap. It is meant for small systems
+ * that are integrated very often, e.g. the many short trajectories of a phase
+ * response computation. It provides the same interface as GenericSystem, so
+ * it can be used with the analysis functions. The ODE has to accept a
+ * std::array<double, N*D> as state, e.g. with a template operator().
+ */
+template<typename ODE, unsigned int N, unsigned int D>
+class FixedSystem {
+ public:
+  typedef std::array<double, N*D> state_type;
+  typedef std::array<double, D> mean_field_type;
+  //! For D = 1 the oscillators are wrapped around the unit circle, so the
+  //! spherical mean field has radius and phase.
+  typedef std::array<double, (D == 1 ? 2 : D)> spherical_mean_field_type;
+  typedef StateView<double> view_type;
+
+  /*!
+   *  @param parameters All the parameters that need to be passed to the ODE.
+   */
+  template<typename... Ts>
+  explicit FixedSystem(Ts... parameters);
+
+  /*!
+   *  \brief Return the position in the state space for all elements.
+   */
+  state_type GetPosition() const;
+
+  /*!
+   *  \brief Return a read-only view of the position without copying it.
+   */
+  view_type GetPositionView() const;
+
+  /*!
+   *  \brief Set the position in the state space.
+   */
+  void SetPosition(const state_type& new_position);
+
+  /*!
+   *  \brief Get the time of the system.
+   */
+  double GetTime() const;
+
+  /*!
+   *  \brief Set the current time for the system.
+   */
+  void SetTime(double t);
+
+  /*!
+   *  \brief Return the derivative at the current position at time.
+   */
+  state_type GetDerivative() const;
+
+  /*!
+   *  \brief Write the derivative at the current position into derivative.
+   */
+  void GetDerivative(state_type& derivative) const;
+
+  /*!
+   *  \brief Write the derivative at the position x and time t into dx,
+   *  without using the state of the system.
+   */
+  void EvaluateDerivative(const state_type& x, state_type& dx,
+                          double t) const;
+
+  /*!
+   *  \brief Return the dimensionality of the system as (N, D).
+   */
+  std::pair<unsigned int, unsigned int> GetDimension() const;
+
+  /*!
+   *  \brief Set the parameters for the ODE, this constructs a new ODE.
+   */
+  template<typename... Ts>
+  void SetParameters(Ts... parameters);
+
+  /*!
+   * \brief Integrate the system whith an observer.
+   *
+   * @param dt Timestep for the integration.
+   * @param number_steps The total number of timesteps.
+   * @param observer The observer of the integration.
+   */
+  template<typename observer_type = boost::numeric::odeint::null_observer>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_type observer
+                     = boost::numeric::odeint::null_observer());
+
+  /*!
+   * \brief Integrate the system and pass the position and its derivative to
+   * the observer as observer(x, dxdt, t), see
+   * RK4System::IntegrateWithDerivative.
+   */
+  template<typename observer_type>
+  void IntegrateWithDerivative(double dt, unsigned int number_steps,
+                               observer_type observer);
+
+  /*!
+   * \brief Transform cartesian coordinates into hyperspherical ones, see
+   * GenericSystem::GetPositionSpherical.
+   */
+  state_type GetPositionSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
+
+  /*!
+   *  \brief Returns the average position of all elements in the state
+   *  space.
+   */
+  mean_field_type CalculateMeanField() const;
+
+  /*!
+   * \brief Returns the mean field in hyperspherical coordinates, see
+   * GenericSystem::CalculateMeanFieldSpherical.
+   */
+  spherical_mean_field_type CalculateMeanFieldSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
+
+ private:
+  // the operator() of an ODE is usually not const
+  mutable ODE ode_;
+  state_type x_;
+  double t_;
+  FixedRK4Stepper<state_type> stepper_;
+  state_type derivative_;
+};
+
+// Implementation
+
+template<typename state>
+template<typename system_type>
+void FixedRK4Stepper<state>::do_step(system_type system, state_type& x,
+                                     double t, double dt) {
+  typename boost::numeric::odeint::unwrap_reference<system_type>::type& ode
+      = system;
+  ode(x, k1_, t);
+  DoStages(ode, x, k1_, t, dt);
+}
+
+template<typename state>
+template<typename system_type>
+void FixedRK4Stepper<state>::do_step(system_type system, state_type& x,
+                                     const deriv_type& dxdt, double t,
+                                     double dt) {
+  typename boost::numeric::odeint::unwrap_reference<system_type>::type& ode
+      = system;
+  DoStages(ode, x, dxdt, t, dt);
+}
+
+template<typename state>
+template<typename ode_type>
+void FixedRK4Stepper<state>::DoStages(ode_type& ode, state_type& x,
+                                      const deriv_type& dxdt, double t,
+                                      double dt) {
+  const double dt_half = 0.5*dt;
+  UnrolledFor([&](size_t i) { x_tmp_[i] = x[i] + dt_half*dxdt[i]; },
+              indices());
+  ode(x_tmp_, k2_, t + dt_half);
+  UnrolledFor([&](size_t i) { x_tmp_[i] = x[i] + dt_half*k2_[i]; },
+              indices());
+  ode(x_tmp_, k3_, t + dt_half);
+  UnrolledFor([&](size_t i) { x_tmp_[i] = x[i] + dt*k3_[i]; }, indices());
+  ode(x_tmp_, k4_, t + dt);
+  const double dt_sixth = dt/6.;
+  UnrolledFor([&](size_t i) {
+      x[i] += dt_sixth*(dxdt[i] + 2.*k2_[i] + 2.*k3_[i] + k4_[i]);
+    }, indices());
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+template<typename... Ts>
+FixedSystem<ODE, N, D>::FixedSystem(Ts... parameters)
+    : ode_(parameters...), t_(0.) {
+  x_.fill(0.);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+std::array<double, N*D> FixedSystem<ODE, N, D>::GetPosition() const {
+  return x_;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+StateView<double> FixedSystem<ODE, N, D>::GetPositionView() const {
+  return MakeStateView(x_);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+void FixedSystem<ODE, N, D>::SetPosition(const state_type& new_position) {
+  x_ = new_position;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+double FixedSystem<ODE, N, D>::GetTime() const {
+  return t_;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+void FixedSystem<ODE, N, D>::SetTime(double t) {
+  t_ = t;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+std::array<double, N*D> FixedSystem<ODE, N, D>::GetDerivative() const {
+  state_type derivative{};
+  ode_(x_, derivative, t_);
+  return derivative;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+void FixedSystem<ODE, N, D>::GetDerivative(state_type& derivative) const {
+  derivative.fill(0.);
+  ode_(x_, derivative, t_);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+void FixedSystem<ODE, N, D>::EvaluateDerivative(const state_type& x,
+                                                state_type& dx,
+                                                double t) const {
+  dx.fill(0.);
+  ode_(x, dx, t);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+std::pair<unsigned int, unsigned int> FixedSystem<ODE, N, D>::GetDimension()
+    const {
+  return std::make_pair(N, D);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+template<typename... Ts>
+void FixedSystem<ODE, N, D>::SetParameters(Ts... parameters) {
+  ode_ = ODE(parameters...);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+template<typename observer_type>
+void FixedSystem<ODE, N, D>::Integrate(double dt, unsigned int number_steps,
+                                       observer_type observer) {
+  t_ = boost::numeric::odeint::integrate_n_steps(
+      boost::ref(stepper_), boost::ref(ode_), x_, t_, dt, number_steps,
+      observer);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+template<typename observer_type>
+void FixedSystem<ODE, N, D>::IntegrateWithDerivative(
+    double dt, unsigned int number_steps, observer_type observer) {
+  t_ = IntegrateNStepsWithDerivative(stepper_, ode_, x_, derivative_, t_, dt,
+                                     number_steps, observer);
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+std::array<double, N*D> FixedSystem<ODE, N, D>::GetPositionSpherical(
+    MathAccuracy accuracy) const {
+  if (D == 1) {
+    return x_;
+  }
+  state_type spherical;
+  if (D == 2 && accuracy != MathAccuracy::kStandard) {
+    CartesianToPolar(x_.data(), spherical.data(), N, accuracy);
+    return spherical;
+  }
+  if (accuracy != MathAccuracy::kStandard) {
+    CartesianToHyperspherical(x_.data(), spherical.data(), N, D, accuracy);
+    return spherical;
+  }
+  for (unsigned int i = 0; i < N; ++i) {
+    CartesianToSpherical(x_.data() + i*D, x_.data() + (i+1)*D,
+                         spherical.data() + i*D);
+  }
+  return spherical;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+std::array<double, D> FixedSystem<ODE, N, D>::CalculateMeanField() const {
+  mean_field_type mean_field;
+  mean_field.fill(0.);
+  for (unsigned int i = 0; i < N; ++i) {
+    for (unsigned int j = 0; j < D; ++j) {
+      mean_field[j] += x_[i*D + j];
+    }
+  }
+  for (unsigned int j = 0; j < D; ++j) {
+    mean_field[j] /= static_cast<double>(N);
+  }
+  return mean_field;
+}
+
+template<typename ODE, unsigned int N, unsigned int D>
+typename FixedSystem<ODE, N, D>::spherical_mean_field_type
+    FixedSystem<ODE, N, D>::CalculateMeanFieldSpherical(
+        MathAccuracy accuracy) const {
+  spherical_mean_field_type spherical_mean_field;
+  // for D = 1 wrap around unit circle
+  if (D == 1) {
+    std::complex<double> order = OrderParameter(x_.begin(), x_.end(),
+                                                accuracy);
+    spherical_mean_field[0] = std::abs(order);
+    spherical_mean_field[1] = std::arg(order);
+  } else {
+    mean_field_type mean_field = CalculateMeanField();
+    CartesianToSpherical(mean_field.data(), mean_field.data() + D,
+                         spherical_mean_field.data());
+  }
+  return spherical_mean_field;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_FIXED_SYSTEM_HPP_
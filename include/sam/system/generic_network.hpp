@@ -3,13 +3,21 @@
 #ifndef INCLUDE_SAM_SYSTEM_GENERIC_NETWORK_HPP_
 #define INCLUDE_SAM_SYSTEM_GENERIC_NETWORK_HPP_
 
-// TODO(boundter): Possible without dependence on vector?
 // TODO(boundter): Increase test coverage
 // TODO(boundter): Derivative and Spherical in matrix form
 
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
 #include <utility>
 #include <vector>
 
+#include "../helper/compensated_sum.hpp"
+#include "../helper/coordinate_helper.hpp"
+#include "../helper/fast_math.hpp"
+#include "../helper/ragged_array.hpp"
+#include "../helper/state_traits.hpp"
 #include "./generic_system.hpp"
 
 namespace sam {
@@ -19,15 +27,25 @@ namespace sam {
  *  A network consists of linked nodes, where each node can consists of
  *  multiple oscillators. There is no limitation as to the type of oscillator,
  *  it can be a phase oscillator or a general limit cycle one. For now it is
- *  limited to a use of oscillators of the same dimensionality.
+ *  limited to a use of oscillators of the same dimensionality. The flattened
+ *  state is stored in a vector_type, which can be changed to e.g.
+ *  Eigen::VectorXd, see GenericSystem. With float as data_type the state
+ *  needs half the memory, the mean fields are still summed in double
+ *  precision.
  */
-template<typename ODE, typename data_type = double>
+template<typename ODE, typename data_type = double,
+         typename vector_type = std::vector<data_type>>
 class GenericNetwork:
-    protected GenericSystem<ODE, std::vector<data_type>> {
+    protected GenericSystem<ODE, vector_type> {
  public:
-  typedef std::vector<data_type> state_type;
+  typedef vector_type state_type;
   typedef std::vector<unsigned int> node_size_type;
   typedef std::vector<state_type> matrix_type;
+  typedef typename GenericSystem<ODE, vector_type>::view_type view_type;
+  //! Read-only view of the nodes, see GetNodesView().
+  typedef RaggedView<data_type> node_view_type;
+  //! Flat storage of one row per node, used as output buffer.
+  typedef RaggedArray<vector_type> ragged_type;
 
   /*!
    * The network is initialized to a zero state.
@@ -40,7 +58,8 @@ class GenericNetwork:
   explicit GenericNetwork(node_size_type node_sizes, unsigned int dimension,
                  Ts... parameters);
 
-  GenericNetwork(const GenericNetwork<ODE, data_type>& other_network);
+  GenericNetwork(
+      const GenericNetwork<ODE, data_type, vector_type>& other_network);
 
   /*!
    * Sets the state of the system using a flattened representation of the form
@@ -54,6 +73,12 @@ class GenericNetwork:
    */
   state_type GetPosition() const;
 
+  /*!
+   * Gets a read-only view of the flattened state without copying it, see
+   * GenericSystem::GetPositionView().
+   */
+  view_type GetPositionView() const;
+
   /*!
    * Gets the indices of the beginning of every new node + (the last index + 1)
    * of the flattened representation.
@@ -66,23 +91,58 @@ class GenericNetwork:
    */
   matrix_type GetNodes() const;
 
+  /*!
+   *  Gets a read-only view of the nodes without copying the state, the rows
+   *  are the nodes in the flattened state. It is valid until the network is
+   *  resized or destroyed.
+   */
+  node_view_type GetNodesView() const;
+
   /*!
    *  Gets the state as a vector of vector representation
    *  state = {{node_1x_1, node_1x_2, ....}, {node_2x_1, ...}, ...},
    * where the coordinates are spherical like in GetPositionSpherical().
    */
-  matrix_type GetNodesSpherical() const;
+  matrix_type GetNodesSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
+
+  /*!
+   *  Writes the nodes in spherical coordinates into nodes, which is reshaped
+   *  to the node indices.
+   */
+  void GetNodesSpherical(
+      ragged_type& nodes,
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
   /*!
    *  Gets the derivative in a flattened representation.
    */
   state_type GetDerivative() const;
 
+  /*!
+   *  Writes the derivative in a flattened representation into derivative,
+   *  see GenericSystem::GetDerivative(state_type&).
+   */
+  void GetDerivative(state_type& derivative) const;
+
+  /*!
+   *  Writes the derivative at the flattened position x and time t into dx,
+   *  see GenericSystem::EvaluateDerivative.
+   */
+  void EvaluateDerivative(const state_type& x, state_type& dx,
+                          double t) const;
+
   /*!
    *  Gets the derivative in a node representation.
    */
   matrix_type GetDerivativeNodes() const;
 
+  /*!
+   *  Writes the derivative into nodes, which is reshaped to the node
+   *  indices.
+   */
+  void GetDerivativeNodes(ragged_type& nodes) const;
+
   /*!
    * \brief Return the position in the state space in phases for all elements.
    *
@@ -91,9 +151,11 @@ class GenericNetwork:
    * around the unit circle as phases, otherise the first coordinate of every
    * element is the radius and the later ones are the phases.
    * Careful: in 3-d this is not the same as spherical coordinates with polar
-   * angle and azimuth!
+   * angle and azimuth! See GenericSystem::GetPositionSpherical for the
+   * accuracy.
    */
-  state_type GetPositionSpherical() const;
+  state_type GetPositionSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
   /*!
    * Gets the time of the system.
@@ -165,11 +227,38 @@ class GenericNetwork:
    * ones are the phases. Careful: in 3-d this is not the same as spherical
    * coordinates with polar angle and azimuth!
    */
-  state_type CalculateMeanFieldSpherical() const;
+  state_type CalculateMeanFieldSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
+  /*!
+   * \brief Returns the mean field of every node, see CalculateMeanField().
+   */
   matrix_type CalculateNodesMeanField() const;
 
-  matrix_type CalculateNodesMeanFieldSpherical() const;
+  /*!
+   * \brief Writes the mean field of every node into mean_field, one row of
+   * size dimension per node. All nodes are calculated in a single pass over
+   * the state.
+   */
+  void CalculateNodesMeanField(ragged_type& mean_field) const;
+
+  /*!
+   * \brief Returns the mean field of every node in spherical coordinates, see
+   * CalculateMeanFieldSpherical().
+   */
+  matrix_type CalculateNodesMeanFieldSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
+
+  /*!
+   * \brief Writes the spherical mean field of every node into mean_field.
+   *
+   * The rows have the size of the dimension, for dimension 1 they have size
+   * 2 and contain the magnitude and phase of the order parameter. All nodes
+   * are calculated in a single pass over the state.
+   */
+  void CalculateNodesMeanFieldSpherical(
+      ragged_type& mean_field,
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
 
  protected:
@@ -184,9 +273,9 @@ class GenericNetwork:
 
 // Implementation
 
-template<typename ODE, typename data_type>
+template<typename ODE, typename data_type, typename vector_type>
 template<typename ...Ts>
-GenericNetwork<ODE, data_type>::GenericNetwork(
+GenericNetwork<ODE, data_type, vector_type>::GenericNetwork(
     node_size_type node_sizes, unsigned int dimension,
     Ts... parameters)
     : GenericSystem<ODE, state_type>(0, dimension, parameters...) {
@@ -195,17 +284,17 @@ GenericNetwork<ODE, data_type>::GenericNetwork(
   Resize(node_sizes_);
 }
 
-template<typename ODE, typename data_type>
-GenericNetwork<ODE, data_type>::GenericNetwork(
-    const GenericNetwork<ODE, data_type>& other_network)
+template<typename ODE, typename data_type, typename vector_type>
+GenericNetwork<ODE, data_type, vector_type>::GenericNetwork(
+    const GenericNetwork<ODE, data_type, vector_type>& other_network)
     : GenericSystem<ODE, state_type>(other_network) {
   node_indices_ = other_network.node_indices_;
   node_sizes_ = other_network.node_sizes_;
 }
 
-template<typename ODE, typename data_type>
-std::vector<unsigned int> GenericNetwork<ODE, data_type>::CalculateNodeIndices(
-    const node_size_type& node_sizes) const {
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<unsigned int> GenericNetwork<ODE, data_type, vector_type>::
+    CalculateNodeIndices(const node_size_type& node_sizes) const {
   node_size_type node_indices = {0};
   unsigned int offset = 0;
   for (size_t i = 0; i < node_sizes.size(); ++i) {
@@ -215,9 +304,9 @@ std::vector<unsigned int> GenericNetwork<ODE, data_type>::CalculateNodeIndices(
   return node_indices;
 }
 
-template<typename ODE, typename data_type>
-unsigned int GenericNetwork<ODE, data_type>::CalculateNumberOscillators(
-    const node_size_type& node_sizes) const {
+template<typename ODE, typename data_type, typename vector_type>
+unsigned int GenericNetwork<ODE, data_type, vector_type>::
+    CalculateNumberOscillators(const node_size_type& node_sizes) const {
   unsigned int N = 0;
   for (size_t i = 0; i < node_sizes.size(); ++i) {
     N += node_sizes[i];
@@ -225,143 +314,256 @@ unsigned int GenericNetwork<ODE, data_type>::CalculateNumberOscillators(
   return N;
 }
 
-template<typename ODE, typename data_type>
-void GenericNetwork<ODE, data_type>::SetPosition(const state_type& new_state) {
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::SetPosition(
+    const state_type& new_state) {
   GenericSystem<ODE, state_type>::SetPosition(new_state);
 }
 
-template<typename ODE, typename data_type>
-std::vector<data_type> GenericNetwork<ODE, data_type>::GetPosition() const {
+template<typename ODE, typename data_type, typename vector_type>
+vector_type GenericNetwork<ODE, data_type, vector_type>::GetPosition() const {
   return GenericSystem<ODE, state_type>::GetPosition();
 }
 
-template<typename ODE, typename data_type>
-std::vector<unsigned int> GenericNetwork<ODE, data_type>::GetNodeIndices()
-    const {
+template<typename ODE, typename data_type, typename vector_type>
+typename GenericNetwork<ODE, data_type, vector_type>::view_type
+    GenericNetwork<ODE, data_type, vector_type>::GetPositionView() const {
+  return GenericSystem<ODE, state_type>::GetPositionView();
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<unsigned int> GenericNetwork<ODE, data_type, vector_type>::
+    GetNodeIndices() const {
   return node_indices_;
 }
 
-template<typename ODE, typename data_type>
-std::vector<std::vector<data_type>> GenericNetwork<ODE, data_type>::GetNodes()
-    const {
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<vector_type> GenericNetwork<ODE, data_type, vector_type>::
+    GetNodes() const {
   matrix_type nodes;
+  nodes.reserve(node_indices_.size() - 1);
   for (size_t i = 0; i < node_indices_.size() - 1; ++i) {
-    nodes.push_back(state_type());
+    nodes.push_back(StateTraits<state_type>::Zero(node_indices_[i+1]
+                                                  - node_indices_[i]));
     for (unsigned int j = node_indices_[i]; j < node_indices_[i+1]; ++j) {
-      nodes.back().push_back(this->x_[j]);
+      nodes.back()[j - node_indices_[i]] = this->x_[j];
     }
   }
   return nodes;
 }
 
-template<typename ODE, typename data_type>
-std::vector<data_type> GenericNetwork<ODE, data_type>::GetDerivative() const {
+template<typename ODE, typename data_type, typename vector_type>
+RaggedView<data_type> GenericNetwork<ODE, data_type, vector_type>::
+    GetNodesView() const {
+  return RaggedView<data_type>(this->x_.data(), node_indices_.data(),
+                               node_indices_.size() - 1);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+vector_type GenericNetwork<ODE, data_type, vector_type>::GetDerivative()
+    const {
   return GenericSystem<ODE, state_type>::GetDerivative();
 }
 
-template<typename ODE, typename data_type>
-std::vector<std::vector<data_type>> GenericNetwork<ODE, data_type>::
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::GetDerivative(
+    state_type& derivative) const {
+  GenericSystem<ODE, state_type>::GetDerivative(derivative);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::EvaluateDerivative(
+    const state_type& x, state_type& dx, double t) const {
+  GenericSystem<ODE, state_type>::EvaluateDerivative(x, dx, t);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<vector_type> GenericNetwork<ODE, data_type, vector_type>::
     GetDerivativeNodes() const {
-  state_type deriv = GenericSystem<ODE, state_type>::GetDerivative();
-  matrix_type nodes;
-  for (size_t i = 0; i < node_indices_.size() - 1; ++i) {
-    nodes.push_back(state_type(deriv.begin() + node_indices_[i],
-                               deriv.begin() + node_indices_[i+1]));
-  }
-  return nodes;
+  ragged_type nodes;
+  GetDerivativeNodes(nodes);
+  return ToNested(nodes);
 }
 
-template<typename ODE, typename data_type>
-std::vector<data_type> GenericNetwork<ODE, data_type>::GetPositionSpherical()
-    const {
-  return GenericSystem<ODE, state_type>::GetPositionSpherical();
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::GetDerivativeNodes(
+    ragged_type& nodes) const {
+  nodes.Reshape(node_indices_);
+  GenericSystem<ODE, state_type>::GetDerivative(nodes.Flat());
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+vector_type GenericNetwork<ODE, data_type, vector_type>::
+    GetPositionSpherical(MathAccuracy accuracy) const {
+  return GenericSystem<ODE, state_type>::GetPositionSpherical(accuracy);
 }
 
-template<typename ODE, typename data_type>
-double GenericNetwork<ODE, data_type>::GetTime() const {
+template<typename ODE, typename data_type, typename vector_type>
+double GenericNetwork<ODE, data_type, vector_type>::GetTime() const {
   return GenericSystem<ODE, state_type>::GetTime();
 }
 
-template<typename ODE, typename data_type>
-void GenericNetwork<ODE, data_type>::SetTime(double t) {
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::SetTime(double t) {
   return GenericSystem<ODE, state_type>::SetTime(t);
 }
 
-template<typename ODE, typename data_type>
+template<typename ODE, typename data_type, typename vector_type>
 template<typename... Ts>
-void GenericNetwork<ODE, data_type>::SetParameters(Ts... parameters) {
+void GenericNetwork<ODE, data_type, vector_type>::SetParameters(
+    Ts... parameters) {
   GenericSystem<ODE, state_type>::SetParameters(parameters...);
 }
 
-template<typename ODE, typename data_type>
-std::pair<unsigned int, unsigned int> GenericNetwork<ODE, data_type>::
+template<typename ODE, typename data_type, typename vector_type>
+std::pair<unsigned int, unsigned int> GenericNetwork<ODE, data_type,
+                                                     vector_type>::
     GetDimension() const {
   return GenericSystem<ODE, state_type>::GetDimension();
 }
 
-template<typename ODE, typename data_type>
-void GenericNetwork<ODE, data_type>::Resize(node_size_type node_sizes) {
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::Resize(
+    node_size_type node_sizes) {
   node_sizes_ = node_sizes;
   node_indices_ = CalculateNodeIndices(node_sizes_);
   GenericSystem<ODE, state_type>::
       Resize(CalculateNumberOscillators(node_sizes_));
 }
 
-template<typename ODE, typename data_type>
-std::vector<std::vector<data_type>> GenericNetwork<ODE, data_type>::
-    GetNodesSpherical() const {
-  matrix_type nodes;
-  for (size_t i = 0; i < node_indices_.size() - 1; ++i) {
-    nodes.push_back(state_type());
-    for (size_t j = node_indices_[i]; j < node_indices_[i+1]; j += this->d_) {
-      if (this->d_ == 1) {
-        nodes.back().push_back(this->x_[j]);
-      } else {
-        state_type coord = CartesianToSpherical<state_type>(
-          this->x_.begin() + j, this->x_.begin() + j + this->d_);
-          nodes.back().insert(nodes.back().end(), coord.begin(), coord.end());
-      }
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<vector_type> GenericNetwork<ODE, data_type, vector_type>::
+    GetNodesSpherical(MathAccuracy accuracy) const {
+  ragged_type nodes;
+  GetNodesSpherical(nodes, accuracy);
+  return ToNested(nodes);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::GetNodesSpherical(
+    ragged_type& nodes, MathAccuracy accuracy) const {
+  nodes.Reshape(node_indices_);
+  const size_t size = this->x_.size();
+  data_type* spherical = nodes.Row(0);
+  if (this->d_ == 1) {
+    for (size_t i = 0; i < size; ++i) {
+      spherical[i] = this->x_[i];
+    }
+  } else if (this->d_ == 2 && accuracy != MathAccuracy::kStandard) {
+    CartesianToPolar(this->x_.data(), spherical, size/2, accuracy);
+  } else if (accuracy != MathAccuracy::kStandard) {
+    CartesianToHyperspherical(this->x_.data(), spherical, size/this->d_,
+                              this->d_, accuracy);
+  } else {
+    for (size_t i = 0; i < size; i += this->d_) {
+      CartesianToSpherical(this->x_.data() + i, this->x_.data() + i + this->d_,
+                           spherical + i);
     }
   }
-  return nodes;
 }
 
-template<typename ODE, typename data_type>
-std::vector<data_type> GenericNetwork<ODE, data_type>::CalculateMeanField()
+template<typename ODE, typename data_type, typename vector_type>
+vector_type GenericNetwork<ODE, data_type, vector_type>::CalculateMeanField()
     const {
   return GenericSystem<ODE, state_type>::CalculateMeanField();
 }
 
-template<typename ODE, typename data_type>
-std::vector<data_type> GenericNetwork<ODE, data_type>::
-    CalculateMeanFieldSpherical() const {
-  return GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical();
+template<typename ODE, typename data_type, typename vector_type>
+vector_type GenericNetwork<ODE, data_type, vector_type>::
+    CalculateMeanFieldSpherical(MathAccuracy accuracy) const {
+  return GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical(
+      accuracy);
 }
 
-template<typename ODE, typename data_type>
-std::vector<std::vector<data_type>> GenericNetwork<ODE, data_type>::
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<vector_type> GenericNetwork<ODE, data_type, vector_type>::
     CalculateNodesMeanField() const {
-  matrix_type mean_field;
-  for (size_t i = 0; i < node_indices_.size() - 1; ++i) {
-    mean_field.push_back(
-      GenericSystem<ODE, state_type>::CalculateMeanField(
-        this->x_.begin() + node_indices_[i],
-        this->x_.begin() + node_indices_[i+1]));
+  ragged_type mean_field;
+  CalculateNodesMeanField(mean_field);
+  return ToNested(mean_field);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::CalculateNodesMeanField(
+    ragged_type& mean_field) const {
+  const size_t number_nodes = node_indices_.size() - 1;
+  const size_t d = this->d_;
+  mean_field.Reshape(number_nodes, d);
+  std::vector<CompensatedSum> sums(d);
+  for (size_t node = 0; node < number_nodes; ++node) {
+    for (size_t j = 0; j < d; ++j) sums[j].Reset();
+    for (size_t i = node_indices_[node]; i < node_indices_[node+1]; i += d) {
+      for (size_t j = 0; j < d; ++j) {
+        sums[j].Add(this->x_[i + j]);
+      }
+    }
+    const double N = static_cast<double>(node_indices_[node+1]
+                                         - node_indices_[node])/d;
+    data_type* row = mean_field.Row(node);
+    for (size_t j = 0; j < d; ++j) row[j] = sums[j].Sum()/N;
   }
-  return mean_field;
 }
 
-template<typename ODE, typename data_type>
-std::vector<std::vector<data_type>> GenericNetwork<ODE, data_type>::
-    CalculateNodesMeanFieldSpherical() const {
-  matrix_type mean_field;
-  for (size_t i = 0; i < node_indices_.size() - 1; ++i) {
-    mean_field.push_back(
-      GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical(
-        this->x_.begin() + node_indices_[i],
-        this->x_.begin() + node_indices_[i+1]));
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<vector_type> GenericNetwork<ODE, data_type, vector_type>::
+    CalculateNodesMeanFieldSpherical(MathAccuracy accuracy) const {
+  ragged_type mean_field;
+  CalculateNodesMeanFieldSpherical(mean_field, accuracy);
+  return ToNested(mean_field);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void GenericNetwork<ODE, data_type, vector_type>::
+    CalculateNodesMeanFieldSpherical(ragged_type& mean_field,
+                                     MathAccuracy accuracy) const {
+  const size_t number_nodes = node_indices_.size() - 1;
+  if (this->d_ > 1) {
+    CalculateNodesMeanField(mean_field);
+    data_type* row = mean_field.Row(0);
+    if (this->d_ == 2 && accuracy != MathAccuracy::kStandard) {
+      CartesianToPolar(row, row, number_nodes, accuracy);
+    } else {
+      std::vector<double> cartesian(this->d_);
+      for (size_t node = 0; node < number_nodes; ++node) {
+        cartesian.assign(row, row + this->d_);
+        CartesianToSpherical(cartesian.begin(), cartesian.end(), row);
+        row += this->d_;
+      }
+    }
+    return;
+  }
+  // for d = 1 the phases are wrapped around the unit circle, the sines and
+  // cosines are calculated in blocks over the whole state
+  mean_field.Reshape(number_nodes, 2);
+  double sin[kMathBlockSize], cos[kMathBlockSize];
+  CompensatedSum sum_cos, sum_sin;
+  size_t node = 0;
+  const size_t size = this->x_.size();
+  auto finish_nodes = [&](size_t i) {
+    // complete every node that ends before index i
+    while (node < number_nodes && node_indices_[node+1] <= i) {
+      const size_t N = node_indices_[node+1] - node_indices_[node];
+      std::complex<double> order = N == 0 ? std::complex<double>(0., 0.)
+          : std::complex<double>(sum_cos.Sum(), sum_sin.Sum())
+            /static_cast<double>(N);
+      data_type* row = mean_field.Row(node);
+      row[0] = std::abs(order);
+      row[1] = std::arg(order);
+      sum_cos.Reset();
+      sum_sin.Reset();
+      ++node;
+    }
+  };
+  for (size_t start = 0; start < size; start += kMathBlockSize) {
+    const size_t block = std::min(kMathBlockSize, size - start);
+    SinCos(this->x_.data() + start, sin, cos, block, accuracy);
+    for (size_t j = 0; j < block; ++j) {
+      finish_nodes(start + j);
+      sum_cos.Add(cos[j]);
+      sum_sin.Add(sin[j]);
+    }
   }
-  return mean_field;
+  finish_nodes(size);
 }
 
 }  // namespace sam
@@ -3,22 +3,39 @@
 #ifndef INCLUDE_SAM_SYSTEM_GENERIC_SYSTEM_HPP_
 #define INCLUDE_SAM_SYSTEM_GENERIC_SYSTEM_HPP_
 
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
 #include <stdexcept>  // length_error,
 #include <utility>
 #include <vector>
 
+#include "../helper/compensated_sum.hpp"
 #include "../helper/coordinate_helper.hpp"
+#include "../helper/fast_math.hpp"
+#include "../helper/state_view.hpp"
+#include "../helper/state_traits.hpp"
 
 namespace sam {
 
 /*!
  * A wrapper for ODEs. It is especially useful for integrating coupled
  * differential equations. Be careful: Integration does not support
- * polymorphism.
+ * polymorphism. The state_type has to provide size(), resize(), data() and
+ * operator[], besides std::vector Eigen vectors can be used by including
+ * sam/helper/eigen_state.hpp. The elements can be float to halve the memory,
+ * the time and the sums of the mean fields are always in double precision.
  */
 template<typename ODE, typename state_type = std::vector<double>>
 class GenericSystem {
  public:
+  //! Type of the mean field, it only differs from state_type for fixed-size
+  //! states.
+  typedef typename StateTraits<state_type>::dynamic_type mean_field_type;
+  //! Read-only view of the state, see GetPositionView().
+  typedef StateView<state_value_type<state_type>> view_type;
+
   /*!
    *  Initialzer for the GenericSystem class.
    *  @param system_size Number of elements in the system.
@@ -36,6 +53,14 @@ class GenericSystem {
    */
   state_type GetPosition() const;
 
+  /*!
+   *  \brief Return a read-only view of the position without copying it.
+   *
+   *  The view always shows the current position and is valid until the
+   *  system is resized or destroyed.
+   */
+  view_type GetPositionView() const;
+
   /*!
    *  \brief Set the position in the state space.
    *
@@ -61,6 +86,25 @@ class GenericSystem {
    */
   state_type GetDerivative() const;
 
+  /*!
+   *  \brief Write the derivative at the current position and time into
+   *  derivative.
+   *
+   *  The derivative is only resized if it has the wrong size, so no memory
+   *  is allocated when the same buffer is used repeatedly.
+   */
+  void GetDerivative(state_type& derivative) const;
+
+  /*!
+   *  \brief Write the derivative at the position x and time t into dx.
+   *
+   *  The state of the system is not used or changed, so the ODE can be
+   *  evaluated at other points without copying the system. dx has to have
+   *  the size of x, it is not resized.
+   */
+  void EvaluateDerivative(const state_type& x, state_type& dx,
+                          double t) const;
+
   /*!
    *  \brief Return the dimensionality of the system.
    *
@@ -111,8 +155,14 @@ class GenericSystem {
    * around the unit circle. The first coordinate is the radius and the later
    * ones are the phases. Careful: in 3-d this is not the same as spherical
    * coordinates with polar angle and azimuth!
+   *
+   * @param accuracy The accuracy of the angles. kStandard transforms every
+   *  element with CartesianToSpherical, kHigh and kLow use the vectorized
+   *  CartesianToPolar in 2d and CartesianToHyperspherical in higher
+   *  dimensions, which differ in the last digits and at the origin.
    */
-  state_type GetPositionSpherical() const;
+  state_type GetPositionSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
   /*!
    *  \brief Returns the average position of all elements in the state
@@ -123,7 +173,7 @@ class GenericSystem {
    *
    * @returns A position in state space that is the average of all units.
    */
-  state_type CalculateMeanField() const;
+  mean_field_type CalculateMeanField() const;
 
 
   /*!
@@ -132,8 +182,12 @@ class GenericSystem {
    * around the unit circle. The first coordinate is the radius and the later
    * ones are the phases. Careful: in 3-d this is not the same as spherical
    * coordinates with polar angle and azimuth!
+   *
+   * @param accuracy The accuracy of the sine and cosine of the phases for
+   *  dimension 1, see OrderParameter.
    */
-  state_type CalculateMeanFieldSpherical() const;
+  mean_field_type CalculateMeanFieldSpherical(
+      MathAccuracy accuracy = MathAccuracy::kStandard) const;
 
  protected:
   std::unique_ptr<ODE> ode_;
@@ -148,18 +202,15 @@ class GenericSystem {
   explicit GenericSystem(unsigned int system_size, unsigned int dimension);
 
 
-  // Calculate the mean field using iterators to allow easy calculation of the
-  // mean field in a network
-  state_type CalculateMeanField(
-    const typename state_type::const_iterator start,
-    const typename state_type::const_iterator end) const;
+  // Calculate the mean field of the elements in the index range [start, end)
+  // of the state to allow easy calculation of the mean field in a network
+  mean_field_type CalculateMeanField(size_t start, size_t end) const;
 
 
-  // Calculate the mean field using iterators to allow easy calculation of the
-  // mean field in a network
-  state_type CalculateMeanFieldSpherical(
-    const typename state_type::const_iterator start,
-    const typename state_type::const_iterator end) const;
+  // Calculate the mean field of the elements in the index range [start, end)
+  // of the state to allow easy calculation of the mean field in a network
+  mean_field_type CalculateMeanFieldSpherical(size_t start, size_t end,
+                                              MathAccuracy accuracy) const;
 };
 
 // Implementation
@@ -171,7 +222,7 @@ GenericSystem<ODE, state_type>::GenericSystem(unsigned int system_size,
                                               Ts... parameters) {
   N_ = system_size;
   d_ = dimension;
-  x_.resize(N_*d_);
+  x_ = StateTraits<state_type>::Zero(N_*d_);
   t_ = 0.;
   ode_ = std::make_unique<ODE>(parameters...);
 }
@@ -192,7 +243,7 @@ GenericSystem<ODE, state_type>::GenericSystem(unsigned int system_size,
                                               unsigned int dimension) {
   N_ = system_size;
   d_ = dimension;
-  x_.resize(N_*d_);
+  x_ = StateTraits<state_type>::Zero(N_*d_);
   t_ = 0.;
 }
 
@@ -201,6 +252,12 @@ state_type GenericSystem<ODE, state_type>::GetPosition() const {
   return x_;
 }
 
+template<typename ODE, typename state_type>
+typename GenericSystem<ODE, state_type>::view_type
+    GenericSystem<ODE, state_type>::GetPositionView() const {
+  return MakeStateView(x_);
+}
+
 template<typename ODE, typename state_type>
 void GenericSystem<ODE, state_type>::SetPosition(
       const state_type& new_position) {
@@ -222,11 +279,30 @@ void GenericSystem<ODE, state_type>::SetTime(double t) {
 
 template<typename ODE, typename state_type>
 state_type GenericSystem<ODE, state_type>::GetDerivative() const {
-  state_type intermediate(x_.size());
+  state_type intermediate = StateTraits<state_type>::Zero(x_.size());
   ode_->operator()(x_, intermediate, t_);
   return intermediate;
 }
 
+template<typename ODE, typename state_type>
+void GenericSystem<ODE, state_type>::GetDerivative(state_type& derivative)
+    const {
+  const size_t size = x_.size();
+  if (static_cast<size_t>(derivative.size()) != size) {
+    StateTraits<state_type>::Resize(derivative, size);
+  }
+  EvaluateDerivative(x_, derivative, t_);
+}
+
+template<typename ODE, typename state_type>
+void GenericSystem<ODE, state_type>::EvaluateDerivative(const state_type& x,
+                                                        state_type& dx,
+                                                        double t) const {
+  const size_t size = x.size();
+  for (size_t i = 0; i < size; ++i) dx[i] = 0;
+  ode_->operator()(x, dx, t);
+}
+
 template<typename ODE, typename state_type>
 std::pair<unsigned int, unsigned int> GenericSystem<ODE, state_type>::
     GetDimension() const {
@@ -239,7 +315,7 @@ std::pair<unsigned int, unsigned int> GenericSystem<ODE, state_type>::
 template<typename ODE, typename state_type>
 void GenericSystem<ODE, state_type>::Resize(unsigned int N) {
   N_ = N;
-  x_.resize(N_*d_);
+  StateTraits<state_type>::Resize(x_, N_*d_);
 }
 
 template<typename ODE, typename state_type>
@@ -249,73 +325,81 @@ void GenericSystem<ODE, state_type>::SetParameters(Ts... parameters) {
 }
 
 template<typename ODE, typename state_type>
-state_type GenericSystem<ODE, state_type>::GetPositionSpherical() const {
+state_type GenericSystem<ODE, state_type>::GetPositionSpherical(
+    MathAccuracy accuracy) const {
   if (d_ == 1) {
     return x_;
+  } else if (d_ == 2 && accuracy != MathAccuracy::kStandard) {
+    state_type spherical = StateTraits<state_type>::Zero(x_.size());
+    CartesianToPolar(x_.data(), spherical.data(), N_, accuracy);
+    return spherical;
+  } else if (accuracy != MathAccuracy::kStandard) {
+    state_type spherical = StateTraits<state_type>::Zero(x_.size());
+    CartesianToHyperspherical(x_.data(), spherical.data(), N_, d_, accuracy);
+    return spherical;
   } else {
-    state_type spherical;
+    state_type spherical = StateTraits<state_type>::Zero(x_.size());
     for (unsigned int i = 0; i < N_; ++i) {
-      state_type coord = CartesianToSpherical<state_type>(
-          x_.begin() + i*d_, x_.begin() + (i+1)*d_);
-      spherical.insert(spherical.end(), coord.begin(), coord.end());
+      CartesianToSpherical(x_.data() + i*d_, x_.data() + (i+1)*d_,
+                           spherical.data() + i*d_);
     }
     return spherical;
   }
 }
 
 template<typename ODE, typename state_type>
-state_type GenericSystem<ODE, state_type>::CalculateMeanField() const {
-  return CalculateMeanField(x_.begin(), x_.end());
+typename GenericSystem<ODE, state_type>::mean_field_type
+    GenericSystem<ODE, state_type>::CalculateMeanField() const {
+  return CalculateMeanField(0, x_.size());
 }
 
 template<typename ODE, typename state_type>
-state_type GenericSystem<ODE, state_type>::CalculateMeanField(
-    const typename state_type::const_iterator start,
-    const typename state_type::const_iterator end) const {
+typename GenericSystem<ODE, state_type>::mean_field_type
+    GenericSystem<ODE, state_type>::CalculateMeanField(size_t start,
+                                                       size_t end) const {
   double N = static_cast<double>(end-start)/static_cast<double>(d_);
   if (N != static_cast<unsigned int>(N)) {
     throw std::length_error("Mean Field cannot be calculated, if not all "
                             "oscillators are given.");
   }
-  state_type mean_field(d_);
+  mean_field_type mean_field = StateTraits<state_type>::ZeroDynamic(d_);
   // TODO(boundter): Check size
-  for (typename state_type::const_iterator i = start; i < end; i += d_) {
-    for (typename state_type::const_iterator j = i; j < i + d_; ++j) {
-      mean_field[j-i] += (*j);
+  std::vector<CompensatedSum> sums(d_);
+  for (size_t i = start; i < end; i += d_) {
+    for (size_t j = 0; j < d_; ++j) {
+      sums[j].Add(x_[i + j]);
     }
   }
-  for (typename state_type::iterator i = mean_field.begin();
-       i != mean_field.end(); ++i) {
-    (*i) /= static_cast<double>(N);
+  for (size_t j = 0; j < d_; ++j) {
+    mean_field[j] = sums[j].Sum()/N;
   }
   return mean_field;
 }
 
 template<typename ODE, typename state_type>
-state_type GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical() const {
-  return CalculateMeanFieldSpherical(x_.begin(), x_.end());
+typename GenericSystem<ODE, state_type>::mean_field_type
+    GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical(
+        MathAccuracy accuracy) const {
+  return CalculateMeanFieldSpherical(0, x_.size(), accuracy);
 }
 
 template<typename ODE, typename state_type>
-state_type GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical(
-    const typename state_type::const_iterator start,
-    const typename state_type::const_iterator end) const {
+typename GenericSystem<ODE, state_type>::mean_field_type
+    GenericSystem<ODE, state_type>::CalculateMeanFieldSpherical(
+        size_t start, size_t end, MathAccuracy accuracy) const {
   double N = static_cast<double>(end-start)/static_cast<double>(d_);
   if (N != static_cast<unsigned int>(N)) {
     throw std::length_error("Mean Field cannot be calculated, if not all "
                             "oscillators are given.");
   }
   // for d = 1 wrap around unit circle
-  state_type spherical_mean_field;
+  mean_field_type spherical_mean_field;
   if (d_ == 1) {
-    double x = 0, y = 0;
-    for (typename state_type::const_iterator i = start; i != end; ++i) {
-      x += cos((*i));
-      y += sin((*i));
-    }
-    spherical_mean_field.resize(2);
-    spherical_mean_field[0] = 1./N*sqrt(x*x + y*y);
-    spherical_mean_field[1] = atan2(y, x);
+    std::complex<double> order = OrderParameter(x_.data() + start,
+                                                x_.data() + end, accuracy);
+    spherical_mean_field = StateTraits<state_type>::ZeroDynamic(2);
+    spherical_mean_field[0] = std::abs(order);
+    spherical_mean_field[1] = std::arg(order);
   } else {
     spherical_mean_field = CartesianToSpherical(CalculateMeanField(start,
                                                                     end));
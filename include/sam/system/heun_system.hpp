@@ -0,0 +1,62 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_HEUN_SYSTEM_HPP_
+#define INCLUDE_SAM_SYSTEM_HEUN_SYSTEM_HPP_
+
+#include <vector>
+
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/ref.hpp>
+
+#include "./euler_stepper.hpp"
+#include "./generic_system.hpp"
+
+namespace sam {
+
+/*! \brief A system that is integrated with a Heun method of order O(dt^2).
+ *
+ * A system that is integrated with a Heun method of order O(dt^2). The Heun
+ * method is defined as
+ * \f[ x_{n+1} = x_{n} + \frac{dt}{2} (f_n + f(x_n + f_n dt, t_n + dt)), \f]
+ * where \f$ f_n \f$ is the derivative at timestep \f$ n \f$. It needs two
+ * evaluations of the ODE per step, the buffers are kept between the steps.
+ */
+template<typename ODE, typename state_type = std::vector<double>>
+class HeunSystem: public GenericSystem<ODE, state_type> {
+ public:
+  template<typename... Ts>
+  explicit HeunSystem(unsigned int system_size, unsigned int dimension,
+                      Ts... parameters);
+
+  template<typename observer_type = boost::numeric::odeint::null_observer>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_type observer
+                     = boost::numeric::odeint::null_observer());
+
+ private:
+  HeunStepper<state_type> stepper_;
+};
+
+// Implementation
+
+template<typename ODE, typename state_type>
+template<typename... Ts>
+HeunSystem<ODE, state_type>::HeunSystem(unsigned int system_size,
+                                        unsigned int dimension,
+                                        Ts... parameters)
+      : GenericSystem<ODE, state_type>(system_size, dimension, parameters...) {}
+
+template<typename ODE, typename state_type>
+template<typename observer_type>
+void HeunSystem<ODE, state_type>::Integrate(double dt,
+                                            unsigned int number_steps,
+                                            observer_type observer) {
+    this->t_ = boost::numeric::odeint::integrate_n_steps(
+        boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_,
+        dt, number_steps, observer);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_HEUN_SYSTEM_HPP_
@@ -0,0 +1,76 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_INTEGRATE_WITH_DERIVATIVE_HPP_
+#define INCLUDE_SAM_SYSTEM_INTEGRATE_WITH_DERIVATIVE_HPP_
+
+#include <boost/ref.hpp>
+
+#include <cstddef>
+
+namespace sam {
+
+/*!
+ * \brief Integrate number_steps steps and call observer(x, dxdt, t) at the
+ * start and after every step.
+ *
+ * The derivative at the new point is both passed to the observer and used
+ * as the first stage of the next step (first same as last), so the ODE is
+ * evaluated number_steps*(stages) + 1 times, e.g. 4 per step for the
+ * classical Runge-Kutta method instead of 5, if the derivative is
+ * calculated again by the observer. The stepper has to provide
+ * do_step(system, x, dxdt, t, dt) like the explicit steppers of odeint.
+ * The times are calculated like in odeint's integrate_n_steps. dxdt is set
+ * to zero before every evaluation of the ODE like in
+ * GenericSystem::EvaluateDerivative, so the ODE may add to it.
+ *
+ * @param stepper The stepper.
+ * @param ode The ODE, it is passed by reference to the stepper.
+ * @param x The state, it is integrated in place.
+ * @param dxdt Buffer for the derivative with the size of x.
+ * @param t The start time.
+ * @param dt The timestep.
+ * @param number_steps The number of steps.
+ * @param observer The observer, called as observer(x, dxdt, t).
+ *
+ * @returns The time at the end of the integration.
+ */
+template<typename stepper_type, typename ode_type, typename state_type,
+         typename observer_type>
+double IntegrateNStepsWithDerivative(stepper_type& stepper, ode_type& ode,
+                                     state_type& x, state_type& dxdt,
+                                     double t, double dt,
+                                     unsigned int number_steps,
+                                     observer_type observer);
+
+// Implementation
+
+template<typename state_type>
+void ZeroDerivative(state_type& dxdt) {
+  const size_t size = dxdt.size();
+  for (size_t i = 0; i < size; ++i) dxdt[i] = 0;
+}
+
+template<typename stepper_type, typename ode_type, typename state_type,
+         typename observer_type>
+double IntegrateNStepsWithDerivative(stepper_type& stepper, ode_type& ode,
+                                     state_type& x, state_type& dxdt,
+                                     double t, double dt,
+                                     unsigned int number_steps,
+                                     observer_type observer) {
+  const double start_time = t;
+  ZeroDerivative(dxdt);
+  ode(x, dxdt, t);
+  observer(x, dxdt, t);
+  for (unsigned int step = 0; step < number_steps; ++step) {
+    stepper.do_step(boost::ref(ode), x, dxdt, t, dt);
+    t = start_time + static_cast<double>(step + 1)*dt;
+    ZeroDerivative(dxdt);
+    ode(x, dxdt, t);
+    observer(x, dxdt, t);
+  }
+  return t;
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_INTEGRATE_WITH_DERIVATIVE_HPP_
@@ -0,0 +1,183 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_KURAMOTO_ODE_HPP_
+#define INCLUDE_SAM_SYSTEM_KURAMOTO_ODE_HPP_
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "../helper/fast_math.hpp"
+
+namespace sam {
+
+/*!
+ * \brief ODE of globally coupled phase oscillators (Kuramoto-Sakaguchi
+ * model).
+ *
+ * The phases follow
+ * \f[ \dot{\varphi}_i = \omega_i + \frac{K}{N} \sum_j
+ *     \sin(\varphi_j - \varphi_i - \alpha)
+ *     = \omega_i + K R \sin(\Psi - \varphi_i - \alpha), \f]
+ * where \f$ Z = R e^{i \Psi} \f$ is the order parameter, see OrderParameter.
+ * The order parameter is calculated once per evaluation, so the cost is O(N)
+ * instead of O(N^2) for the pairwise sum. The sine and cosine of every phase
+ * are calculated with SinCos and kept between the two passes in buffers of
+ * the ODE.
+ */
+class KuramotoODE {
+ public:
+  /*!
+   * @param frequencies The natural frequencies of the oscillators.
+   * @param coupling The coupling strength K.
+   * @param phase_lag The phase lag alpha.
+   */
+  explicit KuramotoODE(const std::vector<double>& frequencies,
+                       double coupling, double phase_lag = 0.);
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t);
+
+ private:
+  std::vector<double> frequencies_;
+  double coupling_;
+  // e^{-i alpha}
+  std::complex<double> rotation_;
+  std::vector<double> cos_, sin_;
+};
+
+/*!
+ * \brief ODE of populations of phase oscillators, that are coupled through
+ * the order parameters of the populations.
+ *
+ * An oscillator i in population a follows
+ * \f[ \dot{\varphi}_i = \omega_i + \sum_b K_{ab} R_b
+ *     \sin(\Psi_b - \varphi_i - \alpha_{ab}), \f]
+ * where \f$ R_b e^{i \Psi_b} \f$ is the order parameter of population b.
+ * The populations are the nodes of a GenericNetwork, so the node sizes are
+ * the same as for the network. The cost is O(N + P^2) for P populations.
+ */
+class PopulationKuramotoODE {
+ public:
+  typedef std::vector<std::vector<double>> matrix_type;
+
+  /*!
+   * @param node_sizes The number of oscillators in every population.
+   * @param frequencies The natural frequencies of all oscillators.
+   * @param coupling The coupling K_ab of population a to population b.
+   * @param phase_lag The phase lags alpha_ab, if empty all are 0.
+   *
+   * @throws std::length_error if the sizes do not match.
+   */
+  explicit PopulationKuramotoODE(const std::vector<unsigned int>& node_sizes,
+                                 const std::vector<double>& frequencies,
+                                 const matrix_type& coupling,
+                                 const matrix_type& phase_lag = matrix_type());
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t);
+
+ private:
+  std::vector<size_t> node_indices_;
+  std::vector<double> frequencies_;
+  // K_ab e^{-i alpha_ab}, so the coupling of a population is one sum
+  std::vector<std::vector<std::complex<double>>> coupling_;
+  std::vector<std::complex<double>> order_parameters_;
+  std::vector<double> cos_, sin_;
+};
+
+// Implementation
+
+inline KuramotoODE::KuramotoODE(const std::vector<double>& frequencies,
+                                double coupling, double phase_lag)
+    : frequencies_(frequencies), coupling_(coupling),
+      rotation_(std::polar(1., -phase_lag)), cos_(frequencies.size()),
+      sin_(frequencies.size()) {}
+
+template<typename state_type>
+void KuramotoODE::operator()(const state_type& x, state_type& dx, double t) {
+  const size_t N = frequencies_.size();
+  if (x.size() != N) {
+    throw std::length_error("The number of phases does not match the number "
+                            "of frequencies.");
+  }
+  SinCos(x.data(), sin_.data(), cos_.data(), N);
+  double sum_cos = 0., sum_sin = 0.;
+  for (size_t i = 0; i < N; ++i) {
+    sum_cos += cos_[i];
+    sum_sin += sin_[i];
+  }
+  // K Z e^{-i alpha}, Im(W e^{-i phi}) = W_y cos(phi) - W_x sin(phi)
+  std::complex<double> W = coupling_/static_cast<double>(N)
+                           *std::complex<double>(sum_cos, sum_sin)*rotation_;
+  for (size_t i = 0; i < N; ++i) {
+    dx[i] = frequencies_[i] + W.imag()*cos_[i] - W.real()*sin_[i];
+  }
+}
+
+inline PopulationKuramotoODE::PopulationKuramotoODE(
+    const std::vector<unsigned int>& node_sizes,
+    const std::vector<double>& frequencies, const matrix_type& coupling,
+    const matrix_type& phase_lag)
+    : node_indices_({0}), frequencies_(frequencies),
+      order_parameters_(node_sizes.size()), cos_(frequencies.size()),
+      sin_(frequencies.size()) {
+  const size_t P = node_sizes.size();
+  for (size_t a = 0; a < P; ++a) {
+    node_indices_.push_back(node_indices_.back() + node_sizes[a]);
+  }
+  if (node_indices_.back() != frequencies_.size()) {
+    throw std::length_error("The number of frequencies does not match the "
+                            "sizes of the nodes.");
+  }
+  if (coupling.size() != P || (!phase_lag.empty() && phase_lag.size() != P)) {
+    throw std::length_error("The coupling needs one row per node.");
+  }
+  coupling_.resize(P);
+  for (size_t a = 0; a < P; ++a) {
+    if (coupling[a].size() != P
+        || (!phase_lag.empty() && phase_lag[a].size() != P)) {
+      throw std::length_error("The coupling needs one column per node.");
+    }
+    for (size_t b = 0; b < P; ++b) {
+      double alpha = phase_lag.empty() ? 0. : phase_lag[a][b];
+      coupling_[a].push_back(std::polar(coupling[a][b], -alpha));
+    }
+  }
+}
+
+template<typename state_type>
+void PopulationKuramotoODE::operator()(const state_type& x, state_type& dx,
+                                       double t) {
+  if (x.size() != frequencies_.size()) {
+    throw std::length_error("The number of phases does not match the number "
+                            "of frequencies.");
+  }
+  const size_t P = order_parameters_.size();
+  SinCos(x.data(), sin_.data(), cos_.data(), frequencies_.size());
+  for (size_t b = 0; b < P; ++b) {
+    double sum_cos = 0., sum_sin = 0.;
+    for (size_t i = node_indices_[b]; i < node_indices_[b+1]; ++i) {
+      sum_cos += cos_[i];
+      sum_sin += sin_[i];
+    }
+    size_t size = node_indices_[b+1] - node_indices_[b];
+    order_parameters_[b] = size == 0 ? std::complex<double>(0., 0.)
+        : std::complex<double>(sum_cos, sum_sin)/static_cast<double>(size);
+  }
+  for (size_t a = 0; a < P; ++a) {
+    std::complex<double> W(0., 0.);
+    for (size_t b = 0; b < P; ++b) {
+      W += coupling_[a][b]*order_parameters_[b];
+    }
+    for (size_t i = node_indices_[a]; i < node_indices_[a+1]; ++i) {
+      dx[i] = frequencies_[i] + W.imag()*cos_[i] - W.real()*sin_[i];
+    }
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_KURAMOTO_ODE_HPP_
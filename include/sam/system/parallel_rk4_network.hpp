@@ -0,0 +1,319 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_PARALLEL_RK4_NETWORK_HPP_
+#define INCLUDE_SAM_SYSTEM_PARALLEL_RK4_NETWORK_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
+#include <boost/numeric/odeint/integrate/null_observer.hpp>
+#include <boost/numeric/odeint/stepper/stepper_categories.hpp>
+#include <boost/numeric/odeint/util/unwrap_reference.hpp>
+#include <boost/ref.hpp>
+
+#include "../helper/thread_pool.hpp"
+#include "./generic_network.hpp"
+
+namespace sam {
+
+/*! \brief 4th order Runge-Kutta stepper that splits the state into
+ * partitions, which are processed in parallel.
+ *
+ * The ODE is called as ode(x, dx, t, begin, end) and has to calculate the
+ * derivative only in the index range [begin, end), it may read all of x. In
+ * the same task the partition of the next stage is updated, so every stage
+ * needs only one synchronization of the threads. The ODE is called
+ * concurrently from different threads and has to be thread-safe for disjoint
+ * ranges.
+ */
+template<typename state>
+class ParallelRK4Stepper {
+ public:
+  typedef state state_type;
+  typedef state deriv_type;
+  typedef double value_type;
+  typedef double time_type;
+  typedef unsigned short order_type;  // NOLINT(runtime/int)
+  typedef boost::numeric::odeint::stepper_tag stepper_category;
+
+  static order_type order() { return 4; }
+
+  /*!
+   * \brief Set the thread pool and the partitions of the state.
+   *
+   * @param pool The pool that does the work, it has to outlive the stepper.
+   * @param partition_indices The first index of every partition and the
+   *  size of the state as the last entry.
+   */
+  void SetPartitions(ThreadPool* pool,
+                     const std::vector<size_t>& partition_indices);
+
+  /*!
+   *  \brief Do one step of the classical Runge-Kutta method.
+   */
+  template<typename system_type>
+  void do_step(system_type system, state_type& x, double t, double dt);
+
+ private:
+  ThreadPool* pool_ = nullptr;
+  std::vector<size_t> partition_indices_;
+  state_type k1_, k2_, k3_, k4_;
+  // the stages alternate between the two buffers, so a partition can be
+  // updated while the other partitions still read the previous stage
+  state_type x_a_, x_b_;
+
+  void ResizeBuffers(const state_type& x);
+};
+
+/*! \brief A network that is integrated with a 4th order Runge-Kutta method,
+ * where the ODE is evaluated in parallel.
+ *
+ * The state is split into partitions that never cross the boundary of a
+ * node and contain only whole oscillators. Every partition is evaluated as
+ * a separate task on a persistent thread pool, so large networks can use
+ * all cores. The ODE has to provide
+ * \code
+ * void operator()(const state_type& x, state_type& dx, double t,
+ *                 size_t begin, size_t end);
+ * \endcode
+ * which calculates dx in the range [begin, end) and is thread-safe, see
+ * ParallelRK4Stepper. GetDerivativeNodes() additionally needs the usual
+ * operator()(x, dx, t).
+ */
+template<typename ODE, typename data_type = double,
+         typename vector_type = std::vector<data_type>>
+class ParallelRK4Network: public GenericNetwork<ODE, data_type, vector_type> {
+ public:
+  using typename GenericNetwork<ODE, data_type, vector_type>::node_size_type;
+  using typename GenericNetwork<ODE, data_type, vector_type>::state_type;
+  using typename GenericNetwork<ODE, data_type, vector_type>::matrix_type;
+
+  /*!
+   * @param node_sizes a vector containing the size of every single node
+   * @param dimension the dimensionality of the oscillators
+   * @param number_threads The number of threads including the calling one,
+   *  if it is 0 the number of hardware threads is used.
+   * @param parameters parameters for the ODE
+   */
+  template<typename... Ts>
+  explicit ParallelRK4Network(node_size_type node_sizes,
+                              unsigned int dimension,
+                              unsigned int number_threads, Ts... parameters);
+
+  ParallelRK4Network(
+      const ParallelRK4Network<ODE, data_type, vector_type>& other_network);
+
+  /*!
+   *  \brief Return the derivative at the current position, it is
+   *  calculated in parallel.
+   */
+  state_type GetDerivative() const;
+
+  /*!
+   *  \brief Write the derivative at the current position into derivative,
+   *  it is calculated in parallel.
+   */
+  void GetDerivative(state_type& derivative) const;
+
+  /*!
+   *  \brief Write the derivative at the position x and time t into dx, it
+   *  is calculated in parallel, see GenericSystem::EvaluateDerivative.
+   */
+  void EvaluateDerivative(const state_type& x, state_type& dx,
+                          double t) const;
+
+  /*!
+   * \brief Change the sizes of the nodes, the partitions are recalculated.
+   */
+  void Resize(node_size_type node_sizes);
+
+  /*!
+   *  \brief Return the number of threads including the calling thread.
+   */
+  unsigned int GetNumberThreads() const;
+
+  /*!
+   * \brief Return the first index of every partition and the size of the
+   * state as last entry.
+   */
+  std::vector<size_t> GetPartitionIndices() const;
+
+  template<typename observer_type = boost::numeric::odeint::null_observer>
+  void Integrate(double dt, unsigned int number_steps,
+                 observer_type observer
+                     = boost::numeric::odeint::null_observer());
+
+ private:
+  // a few partitions per thread even out differences in the work per task
+  static constexpr unsigned int partitions_per_thread_ = 4;
+
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<size_t> partition_indices_;
+  ParallelRK4Stepper<state_type> stepper_;
+
+  void UpdatePartitions();
+};
+
+// Implementation
+
+template<typename state>
+void ParallelRK4Stepper<state>::SetPartitions(
+    ThreadPool* pool, const std::vector<size_t>& partition_indices) {
+  pool_ = pool;
+  partition_indices_ = partition_indices;
+}
+
+template<typename state>
+void ParallelRK4Stepper<state>::ResizeBuffers(const state_type& x) {
+  if (k1_.size() != x.size()) {
+    k1_.resize(x.size());
+    k2_.resize(x.size());
+    k3_.resize(x.size());
+    k4_.resize(x.size());
+    x_a_.resize(x.size());
+    x_b_.resize(x.size());
+  }
+}
+
+template<typename state>
+template<typename system_type>
+void ParallelRK4Stepper<state>::do_step(system_type system, state_type& x,
+                                        double t, double dt) {
+  typename boost::numeric::odeint::unwrap_reference<system_type>::type& ode
+      = system;
+  ResizeBuffers(x);
+  const size_t number_partitions = partition_indices_.size() - 1;
+  const double dt_half = 0.5*dt;
+  const double dt_sixth = dt/6.;
+  pool_->ParallelFor(number_partitions, [&](size_t p) {
+    const size_t begin = partition_indices_[p];
+    const size_t end = partition_indices_[p+1];
+    ode(x, k1_, t, begin, end);
+    for (size_t i = begin; i < end; ++i) x_a_[i] = x[i] + dt_half*k1_[i];
+  });
+  pool_->ParallelFor(number_partitions, [&](size_t p) {
+    const size_t begin = partition_indices_[p];
+    const size_t end = partition_indices_[p+1];
+    ode(x_a_, k2_, t + dt_half, begin, end);
+    for (size_t i = begin; i < end; ++i) x_b_[i] = x[i] + dt_half*k2_[i];
+  });
+  pool_->ParallelFor(number_partitions, [&](size_t p) {
+    const size_t begin = partition_indices_[p];
+    const size_t end = partition_indices_[p+1];
+    ode(x_b_, k3_, t + dt_half, begin, end);
+    for (size_t i = begin; i < end; ++i) x_a_[i] = x[i] + dt*k3_[i];
+  });
+  pool_->ParallelFor(number_partitions, [&](size_t p) {
+    const size_t begin = partition_indices_[p];
+    const size_t end = partition_indices_[p+1];
+    ode(x_a_, k4_, t + dt, begin, end);
+    for (size_t i = begin; i < end; ++i) {
+      x[i] += dt_sixth*(k1_[i] + 2.*k2_[i] + 2.*k3_[i] + k4_[i]);
+    }
+  });
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+template<typename... Ts>
+ParallelRK4Network<ODE, data_type, vector_type>::ParallelRK4Network(
+    node_size_type node_sizes, unsigned int dimension,
+    unsigned int number_threads, Ts... parameters)
+    : GenericNetwork<ODE, data_type, vector_type>(node_sizes, dimension,
+                                                  parameters...),
+      pool_(new ThreadPool(number_threads)) {
+  UpdatePartitions();
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+ParallelRK4Network<ODE, data_type, vector_type>::ParallelRK4Network(
+    const ParallelRK4Network<ODE, data_type, vector_type>& other_network)
+    : GenericNetwork<ODE, data_type, vector_type>(other_network),
+      pool_(new ThreadPool(other_network.GetNumberThreads())) {
+  UpdatePartitions();
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+typename ParallelRK4Network<ODE, data_type, vector_type>::state_type
+    ParallelRK4Network<ODE, data_type, vector_type>::GetDerivative() const {
+  state_type derivative = StateTraits<state_type>::Zero(this->x_.size());
+  GetDerivative(derivative);
+  return derivative;
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void ParallelRK4Network<ODE, data_type, vector_type>::GetDerivative(
+    state_type& derivative) const {
+  const size_t size = this->x_.size();
+  if (static_cast<size_t>(derivative.size()) != size) {
+    StateTraits<state_type>::Resize(derivative, size);
+  }
+  EvaluateDerivative(this->x_, derivative, this->t_);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void ParallelRK4Network<ODE, data_type, vector_type>::EvaluateDerivative(
+    const state_type& x, state_type& dx, double t) const {
+  pool_->ParallelFor(partition_indices_.size() - 1, [&](size_t p) {
+    for (size_t i = partition_indices_[p]; i < partition_indices_[p+1]; ++i) {
+      dx[i] = 0;
+    }
+    (*(this->ode_))(x, dx, t, partition_indices_[p], partition_indices_[p+1]);
+  });
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void ParallelRK4Network<ODE, data_type, vector_type>::Resize(
+    node_size_type node_sizes) {
+  GenericNetwork<ODE, data_type, vector_type>::Resize(node_sizes);
+  UpdatePartitions();
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+unsigned int ParallelRK4Network<ODE, data_type, vector_type>::
+    GetNumberThreads() const {
+  return pool_->GetNumberThreads();
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+std::vector<size_t> ParallelRK4Network<ODE, data_type, vector_type>::
+    GetPartitionIndices() const {
+  return partition_indices_;
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+void ParallelRK4Network<ODE, data_type, vector_type>::UpdatePartitions() {
+  const size_t number_oscillators = this->x_.size()/this->d_;
+  const size_t target = pool_->GetNumberThreads()*partitions_per_thread_;
+  // the number of oscillators in a partition, rounded up
+  const size_t chunk = std::max<size_t>(
+      1, (number_oscillators + target - 1)/target);
+  partition_indices_ = {0};
+  for (size_t k = 0; k + 1 < this->node_indices_.size(); ++k) {
+    size_t node_end = this->node_indices_[k+1];
+    for (size_t begin = this->node_indices_[k] + chunk*this->d_;
+         begin < node_end; begin += chunk*this->d_) {
+      partition_indices_.push_back(begin);
+    }
+    // empty nodes would produce empty partitions
+    if (node_end > partition_indices_.back()) {
+      partition_indices_.push_back(node_end);
+    }
+  }
+  stepper_.SetPartitions(pool_.get(), partition_indices_);
+}
+
+template<typename ODE, typename data_type, typename vector_type>
+template<typename observer_type>
+void ParallelRK4Network<ODE, data_type, vector_type>::Integrate(
+    double dt, unsigned int number_steps, observer_type observer) {
+  this->t_ = boost::numeric::odeint::integrate_n_steps(
+      boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_, dt,
+      number_steps, observer);
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_PARALLEL_RK4_NETWORK_HPP_
@@ -9,8 +9,10 @@
 #include <boost/numeric/odeint/integrate/integrate_n_steps.hpp>
 #include <boost/numeric/odeint/integrate/null_observer.hpp>
 #include <boost/numeric/odeint/stepper/runge_kutta4.hpp>
+#include <boost/ref.hpp>
 
 #include "./generic_system.hpp"
+#include "./integrate_with_derivative.hpp"
 
 namespace sam {
 
@@ -32,8 +34,21 @@ class RK4System: public GenericSystem<ODE, state_type> {
                  observer_type observer
                      = boost::numeric::odeint::null_observer());
 
+  /*!
+   * \brief Integrate the system and pass the position and its derivative to
+   * the observer as observer(x, dxdt, t), e.g. to PosDerivObserver.
+   *
+   * The derivative at the new point is reused as the first stage of the next
+   * step, so the ODE is evaluated 4 instead of 5 times per step compared to
+   * Integrate with a DerivativeObserver, see IntegrateNStepsWithDerivative.
+   */
+  template<typename observer_type>
+  void IntegrateWithDerivative(double dt, unsigned int number_steps,
+                               observer_type observer);
+
  private:
   boost::numeric::odeint::runge_kutta4<state_type> stepper_;
+  state_type derivative_;
 };
 
 // Implementation
@@ -50,8 +65,20 @@ template<typename observer_type>
 void RK4System<ODE, state_type>::Integrate(double dt, unsigned int number_steps,
                                            observer_type observer) {
       this->t_ = boost::numeric::odeint::integrate_n_steps(
-          stepper_, *(this->ode_), this->x_, this->t_, dt, number_steps,
-          observer);
+          boost::ref(stepper_), boost::ref(*(this->ode_)), this->x_, this->t_,
+          dt, number_steps, observer);
+}
+
+template<typename ODE, typename state_type>
+template<typename observer_type>
+void RK4System<ODE, state_type>::IntegrateWithDerivative(
+    double dt, unsigned int number_steps, observer_type observer) {
+  if (derivative_.size() != this->x_.size()) {
+    derivative_ = StateTraits<state_type>::Zero(this->x_.size());
+  }
+  this->t_ = IntegrateNStepsWithDerivative(stepper_, *(this->ode_), this->x_,
+                                           derivative_, this->t_, dt,
+                                           number_steps, observer);
 }
 
 }  // namespace sam
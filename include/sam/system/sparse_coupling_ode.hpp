@@ -0,0 +1,168 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#ifndef INCLUDE_SAM_SYSTEM_SPARSE_COUPLING_ODE_HPP_
+#define INCLUDE_SAM_SYSTEM_SPARSE_COUPLING_ODE_HPP_
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "../helper/edge_list.hpp"
+
+namespace sam {
+
+/*!
+ * \brief ODE of a network with diffusive coupling along the edges of a sparse
+ * adjacency matrix.
+ *
+ * The dynamics of unit i is
+ * \f[ \dot{x}_i = f(x_i, t) + \varepsilon \sum_j A_{ij} (x_j - x_i), \f]
+ * where f is given by the uncoupled local_ode_type, which is called for the
+ * whole state, e.g. HarmonicOscillatorODE. Every unit consists of
+ * x.size()/A.rows() coordinates, which are all coupled. The adjacency matrix
+ * is stored in CSR format, so the coupling is a sparse matrix-vector product
+ * that only touches the edges and reads the coordinates of a neighbour in one
+ * contiguous block. It can be used in RK4Network or any other system, e.g.
+ * \code
+ * sam::RK4Network<sam::SparseCouplingODE<ODE>> network(
+ *     {N}, d, sam::ReadEdgeList(file, N), coupling, ode_parameters...);
+ * \endcode
+ * If the local ODE can be evaluated for a range, the ODE can also be used in
+ * ParallelRK4Network.
+ */
+template<typename local_ode_type>
+class SparseCouplingODE {
+ public:
+  /*!
+   * @param adjacency The adjacency matrix of the network, see
+   *  BuildAdjacencyMatrix.
+   * @param coupling The strength of the coupling.
+   * @param local_parameters The parameters of the local ODE.
+   */
+  template<typename... Ts>
+  explicit SparseCouplingODE(const AdjacencyMatrix& adjacency,
+                             double coupling, Ts... local_parameters);
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t);
+
+  /*!
+   * \brief Calculate the derivative in the range [begin, end), which has to
+   * consist of whole units.
+   */
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t,
+                  size_t begin, size_t end);
+
+  double GetCoupling() const;
+
+  void SetCoupling(double coupling);
+
+  const AdjacencyMatrix& GetAdjacency() const;
+
+ private:
+  local_ode_type local_ode_;
+  AdjacencyMatrix adjacency_;
+  // sum_j A_ij, so the diffusive term is A x - degree x
+  std::vector<double> degree_;
+  double coupling_;
+
+  template<typename state_type>
+  size_t UnitDimension(const state_type& x) const;
+
+  template<typename state_type>
+  void AddCoupling(const state_type& x, state_type& dx, size_t first_unit,
+                   size_t last_unit, size_t dimension) const;
+};
+
+// Implementation
+
+template<typename local_ode_type>
+template<typename... Ts>
+SparseCouplingODE<local_ode_type>::SparseCouplingODE(
+    const AdjacencyMatrix& adjacency, double coupling,
+    Ts... local_parameters)
+    : local_ode_(local_parameters...), adjacency_(adjacency),
+      degree_(adjacency.rows(), 0.), coupling_(coupling) {
+  adjacency_.makeCompressed();
+  for (Eigen::Index i = 0; i < adjacency_.outerSize(); ++i) {
+    for (AdjacencyMatrix::InnerIterator it(adjacency_, i); it; ++it) {
+      degree_[i] += it.value();
+    }
+  }
+}
+
+template<typename local_ode_type>
+template<typename state_type>
+void SparseCouplingODE<local_ode_type>::operator()(const state_type& x,
+                                                   state_type& dx, double t) {
+  size_t dimension = UnitDimension(x);
+  local_ode_(x, dx, t);
+  AddCoupling(x, dx, 0, adjacency_.rows(), dimension);
+}
+
+template<typename local_ode_type>
+template<typename state_type>
+void SparseCouplingODE<local_ode_type>::operator()(const state_type& x,
+                                                   state_type& dx, double t,
+                                                   size_t begin, size_t end) {
+  size_t dimension = UnitDimension(x);
+  local_ode_(x, dx, t, begin, end);
+  AddCoupling(x, dx, begin/dimension, end/dimension, dimension);
+}
+
+template<typename local_ode_type>
+double SparseCouplingODE<local_ode_type>::GetCoupling() const {
+  return coupling_;
+}
+
+template<typename local_ode_type>
+void SparseCouplingODE<local_ode_type>::SetCoupling(double coupling) {
+  coupling_ = coupling;
+}
+
+template<typename local_ode_type>
+const AdjacencyMatrix& SparseCouplingODE<local_ode_type>::GetAdjacency()
+    const {
+  return adjacency_;
+}
+
+template<typename local_ode_type>
+template<typename state_type>
+size_t SparseCouplingODE<local_ode_type>::UnitDimension(const state_type& x)
+    const {
+  const size_t number_units = adjacency_.rows();
+  if (number_units == 0 || x.size() % number_units != 0) {
+    throw std::length_error("The state does not match the size of the "
+                            "adjacency matrix.");
+  }
+  return x.size()/number_units;
+}
+
+template<typename local_ode_type>
+template<typename state_type>
+void SparseCouplingODE<local_ode_type>::AddCoupling(
+    const state_type& x, state_type& dx, size_t first_unit, size_t last_unit,
+    size_t dimension) const {
+  typedef AdjacencyMatrix::StorageIndex index_type;
+  const index_type* outer = adjacency_.outerIndexPtr();
+  const index_type* inner = adjacency_.innerIndexPtr();
+  const double* values = adjacency_.valuePtr();
+  for (size_t i = first_unit; i < last_unit; ++i) {
+    const size_t offset = i*dimension;
+    for (size_t k = 0; k < dimension; ++k) {
+      dx[offset + k] -= coupling_*degree_[i]*x[offset + k];
+    }
+    for (index_type edge = outer[i]; edge < outer[i+1]; ++edge) {
+      const double weight = coupling_*values[edge];
+      const size_t neighbour = static_cast<size_t>(inner[edge])*dimension;
+      for (size_t k = 0; k < dimension; ++k) {
+        dx[offset + k] += weight*x[neighbour + k];
+      }
+    }
+  }
+}
+
+}  // namespace sam
+
+#endif  // INCLUDE_SAM_SYSTEM_SPARSE_COUPLING_ODE_HPP_
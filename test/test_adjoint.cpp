@@ -0,0 +1,116 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/analysis/adjoint.hpp"
+#include "include/sam/analysis/phase.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+typedef std::vector<double> state_type;
+
+namespace {
+
+class StuartLandauODE {
+ public:
+  explicit StuartLandauODE(double alpha, double omega)
+      : alpha_(alpha), omega_(omega) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    double R2 = x[0]*x[0] + x[1]*x[1];
+    dx[0] = x[0] - (omega_ + alpha_)*x[1] - R2*(x[0] - alpha_*x[1]);
+    dx[1] = x[1] + (omega_ + alpha_)*x[0] - R2*(x[1] + alpha_*x[0]);
+  }
+
+ private:
+  double alpha_;
+  double omega_;
+};
+
+class StuartLandauJacobian {
+ public:
+  explicit StuartLandauJacobian(double alpha, double omega)
+      : alpha_(alpha), omega_(omega) {}
+
+  void operator()(const state_type& x, Eigen::MatrixXd& J, double t) {
+    double R2 = x[0]*x[0] + x[1]*x[1];
+    J.resize(2, 2);
+    J(0, 0) = 1. - R2 - 2*x[0]*(x[0] - alpha_*x[1]);
+    J(0, 1) = -(omega_ + alpha_) + alpha_*R2 - 2*x[1]*(x[0] - alpha_*x[1]);
+    J(1, 0) = omega_ + alpha_ - alpha_*R2 - 2*x[0]*(x[1] + alpha_*x[0]);
+    J(1, 1) = 1. - R2 - 2*x[1]*(x[1] + alpha_*x[0]);
+  }
+
+ private:
+  double alpha_;
+  double omega_;
+};
+
+}  // namespace
+
+TEST_CASE("adjoint of the Stuart-Landau oscillator") {
+  // the phase is atan2(y, x) - alpha ln(r), so on the limit cycle r = 1 the
+  // iPRC is Z = (-y - alpha x, x - alpha y)
+  const double alpha = 0.3;
+  const double omega = 0.9;
+  const double T = 2*M_PI/omega;
+  sam::RK4System<StuartLandauODE> system(1, 2, alpha, omega);
+  system.SetPosition({std::cos(0.4), std::sin(0.4)});
+  sam::AdjointParameters params;
+  params.steps_per_period = 500;
+
+  auto check = [&](const sam::AdjointSolution<state_type>& solution) {
+    REQUIRE(solution.time.size() == 501);
+    REQUIRE(solution.orbit.size() == 501);
+    REQUIRE(solution.iprc.size() == 501);
+    CHECK(solution.time.back() == Approx(T));
+    for (size_t k = 0; k < solution.time.size(); k += 10) {
+      const state_type& x = solution.orbit[k];
+      CHECK(x[0] == Approx(std::cos(0.4 + omega*solution.time[k]))
+                    .margin(1e-8));
+      CHECK(solution.iprc[k][0] == Approx(-x[1] - alpha*x[0]).margin(1e-6));
+      CHECK(solution.iprc[k][1] == Approx(x[0] - alpha*x[1]).margin(1e-6));
+    }
+  };
+
+  SECTION("numerical Jacobian") {
+    check(sam::CalculateAdjoint(system, T, params));
+  }
+
+  SECTION("Jacobians recalculated every period") {
+    params.max_stored_entries = 0;
+    check(sam::CalculateAdjoint(system, T, params));
+  }
+
+  SECTION("analytical Jacobian") {
+    check(sam::CalculateAdjoint(system, T,
+                                StuartLandauJacobian(alpha, omega), params));
+  }
+
+  SECTION("agrees with perturbations of FindPhase") {
+    sam::AdjointSolution<state_type> solution = sam::CalculateAdjoint(
+        system, T, params);
+    sam::PhaseParameters phase_params;
+    auto upper_half = [](const state_type& x) { return x[1] > 0; };
+    const size_t k = 123;
+    const double eps = 1e-4;
+    state_type perturbed = solution.orbit[k];
+    perturbed[0] += eps;
+    double phase = sam::FindPhase(solution.orbit[k], T, system, upper_half,
+                                  phase_params);
+    double phase_perturbed = sam::FindPhase(perturbed, T, system, upper_half,
+                                            phase_params);
+    CHECK((phase_perturbed - phase)/eps
+          == Approx(solution.iprc[k][0]).margin(1e-3));
+  }
+
+  SECTION("no convergence") {
+    params.max_periods = 1;
+    CHECK_THROWS_AS(sam::CalculateAdjoint(system, T, params),
+                    std::runtime_error);
+  }
+}
@@ -0,0 +1,115 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/system/batch_rk4_system.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+template<typename value_type>
+class BatchHarmonicOscillatorODE {
+ public:
+  explicit BatchHarmonicOscillatorODE(value_type omega): omega_(omega) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    for (unsigned int i = 0; i < x.size()/2; ++i) {
+      dx[2*i] = x[2*i+1];
+      dx[2*i+1] = -omega_*omega_*x[2*i];
+    }
+  }
+
+ private:
+  value_type omega_;
+};
+
+TEST_CASE("integrate batch of harmonic oscillators") {
+  // for x(0)=0 and \dot{x}(0)=1 the solution is
+  // x = 1/omega*sin(omega*t), \dot{x} = cos(omega*t)
+  typedef sam::Pack<double, 4> pack_type;
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*static_cast<double>(n);
+  std::vector<std::tuple<double>> parameters;
+  // not a multiple of the number of lanes
+  for (unsigned int i = 0; i < 10; ++i) {
+    parameters.push_back(std::make_tuple(0.5 + 0.25*i));
+  }
+  sam::BatchRK4System<BatchHarmonicOscillatorODE<pack_type>, pack_type>
+      system(1, 2, parameters);
+  REQUIRE(system.GetNumberMembers() == parameters.size());
+  system.SetPosition({0., 1.});
+
+  SECTION("positions are set per member") {
+    system.SetPosition(3, {2., 3.});
+    CHECK(system.GetPosition(3) == std::vector<double>({2., 3.}));
+    CHECK(system.GetPosition(2) == std::vector<double>({0., 1.}));
+    CHECK(system.GetPosition(4) == std::vector<double>({0., 1.}));
+    CHECK_THROWS_AS(system.SetPosition(0, {1.}), std::length_error);
+  }
+
+  SECTION("members outside of the ensemble throw") {
+    // 10 and 11 are padding lanes of the last batch, 12 is past the end
+    for (size_t member : {10, 11, 12}) {
+      CHECK_THROWS_AS(system.GetPosition(member), std::out_of_range);
+      CHECK_THROWS_AS(system.SetPosition(member, {1., 0.}),
+                      std::out_of_range);
+      CHECK_THROWS_AS(system.GetDerivative(member), std::out_of_range);
+    }
+  }
+
+  SECTION("derivative uses the parameters of the member") {
+    system.SetPosition(5, {1., 0.});
+    double omega = std::get<0>(parameters[5]);
+    std::vector<double> derivative = system.GetDerivative(5);
+    CHECK(derivative[0] == Approx(0.));
+    CHECK(derivative[1] == Approx(-omega*omega));
+  }
+
+  SECTION("every member is integrated with its own parameter") {
+    system.Integrate(dt, n);
+    CHECK(system.GetTime() == Approx(t).margin(0.000001));
+    for (size_t i = 0; i < system.GetNumberMembers(); ++i) {
+      double omega = std::get<0>(parameters[i]);
+      std::vector<double> x = system.GetPosition(i);
+      CHECK(x[0] == Approx(1./omega*sin(omega*t)).margin(0.001));
+      CHECK(x[1] == Approx(cos(omega*t)).margin(0.001));
+    }
+  }
+
+  SECTION("every member has its own observer") {
+    typedef std::vector<double> state_type;
+    std::vector<std::vector<state_type>> positions(parameters.size());
+    std::vector<std::vector<double>> times(parameters.size());
+    system.Integrate(dt, n, [&](size_t member) {
+        return sam::PositionObserver<state_type>(positions[member],
+                                                 times[member]);
+      });
+    for (size_t i = 0; i < system.GetNumberMembers(); ++i) {
+      REQUIRE(positions[i].size() == n + 1);
+      REQUIRE(times[i].size() == n + 1);
+      CHECK(positions[i].front() == state_type({0., 1.}));
+      CHECK(positions[i].back() == system.GetPosition(i));
+      CHECK(times[i].back() == Approx(t).margin(0.000001));
+    }
+  }
+
+  SECTION("members agree with scalar integration") {
+    system.Integrate(dt, n);
+    for (size_t i = 0; i < system.GetNumberMembers(); ++i) {
+      sam::RK4System<HarmonicOscillatorODE> scalar(1, 2,
+                                                   std::get<0>(parameters[i]));
+      scalar.SetPosition({0., 1.});
+      scalar.Integrate(dt, n);
+      std::vector<double> x = system.GetPosition(i);
+      std::vector<double> x_scalar = scalar.GetPosition();
+      CHECK(x[0] == Approx(x_scalar[0]).margin(1e-12));
+      CHECK(x[1] == Approx(x_scalar[1]).margin(1e-12));
+    }
+  }
+}
@@ -0,0 +1,109 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <sys/resource.h>
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/binary_trajectory.hpp"
+
+TEST_CASE("write and read a trajectory") {
+  const std::string filename = "test_binary_trajectory.bin";
+  std::vector<unsigned int> node_sizes = {2, 1};
+  unsigned int dimension = 2;
+  double dt = 0.1;
+  // more records than the capacity and the buffers, so the file has to grow
+  size_t number_records = 1000;
+  {
+    sam::BinaryTrajectoryWriter writer(filename, node_sizes, dimension, dt,
+                                       100, 64);
+    std::vector<double> x(6);
+    for (size_t i = 0; i < number_records; ++i) {
+      for (size_t j = 0; j < x.size(); ++j) x[j] = i + 0.5*j;
+      writer.Write(x, dt*i);
+    }
+    CHECK(writer.GetNumberRecords() == number_records);
+    CHECK_THROWS_AS(writer.Write(std::vector<double>(5), 0.),
+                    std::length_error);
+    writer.Close();
+    CHECK_THROWS_AS(writer.Write(x, 0.), std::logic_error);
+  }
+
+  sam::BinaryTrajectoryReader reader(filename);
+  REQUIRE(reader.GetNumberRecords() == number_records);
+  CHECK(reader.GetNumberOscillators() == 3);
+  CHECK(reader.GetDimension() == dimension);
+  CHECK(reader.GetNodeSizes() == node_sizes);
+  CHECK(reader.GetTimestep() == dt);
+  for (size_t i = 0; i < number_records; ++i) {
+    CHECK(reader.GetTime(i) == dt*i);
+    sam::StateView<double> state = reader.GetState(i);
+    REQUIRE(state.size() == 6);
+    for (size_t j = 0; j < state.size(); ++j) {
+      CHECK(state[j] == i + 0.5*j);
+    }
+  }
+  CHECK_THROWS_AS(reader.GetState(number_records), std::out_of_range);
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("the destructor writes the buffered records") {
+  const std::string filename = "test_binary_trajectory_destructor.bin";
+  {
+    sam::BinaryTrajectoryWriter writer(filename, {1}, 1, 1.);
+    writer.Write(std::vector<double>({3.}), 2.);
+  }
+  sam::BinaryTrajectoryReader reader(filename);
+  REQUIRE(reader.GetNumberRecords() == 1);
+  CHECK(reader.GetTime(0) == 2.);
+  CHECK(reader.GetState(0)[0] == 3.);
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("writes after a failed flush throw") {
+  const std::string filename = "test_binary_trajectory_failed.bin";
+  // the file cannot grow beyond the capacity of one record
+  std::signal(SIGXFSZ, SIG_IGN);
+  struct rlimit limit;
+  getrlimit(RLIMIT_FSIZE, &limit);
+  const rlim_t previous = limit.rlim_cur;
+  {
+    sam::BinaryTrajectoryWriter writer(filename, {1}, 1, 1., 1, 1);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    limit.rlim_cur = static_cast<rlim_t>(file.tellg());
+    REQUIRE(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    std::vector<double> x({1.});
+    size_t written = 0;
+    try {
+      for (; written < 10; ++written) writer.Write(x, 0.);
+    } catch (const std::system_error&) {
+    }
+    CHECK(written < 10);
+    // the front buffer is full, it must not be written again
+    for (size_t i = 0; i < 3; ++i) {
+      CHECK_THROWS_AS(writer.Write(x, 0.), std::system_error);
+    }
+    CHECK_THROWS_AS(writer.Close(), std::system_error);
+  }
+  limit.rlim_cur = previous;
+  setrlimit(RLIMIT_FSIZE, &limit);
+  std::signal(SIGXFSZ, SIG_DFL);
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("reading a file that is not a trajectory throws") {
+  const std::string filename = "test_binary_trajectory_invalid.bin";
+  {
+    std::ofstream file(filename);
+    file << std::string(100, 'x');
+  }
+  CHECK_THROWS_AS(sam::BinaryTrajectoryReader(filename),
+                  std::invalid_argument);
+  std::remove(filename.c_str());
+  CHECK_THROWS_AS(sam::BinaryTrajectoryReader(filename), std::system_error);
+}
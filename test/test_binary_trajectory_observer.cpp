@@ -0,0 +1,44 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/observer/binary_trajectory_observer.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+TEST_CASE("binary trajectory observer matches PositionObserver") {
+  const std::string filename = "test_binary_trajectory_observer.bin";
+  typedef std::vector<double> state_type;
+  double dt = 0.01;
+  unsigned int steps = 500;
+  sam::RK4System<HarmonicOscillatorODE> system(2, 2, 1.);
+  system.SetPosition({1., 0., 0., 2.});
+  sam::RK4System<HarmonicOscillatorODE> copy(system);
+
+  std::vector<state_type> positions;
+  std::vector<double> times;
+  system.Integrate(dt, steps,
+                   sam::PositionObserver<state_type>(positions, times));
+
+  auto writer = std::make_shared<sam::BinaryTrajectoryWriter>(
+      filename, std::vector<unsigned int>({2}), 2, dt, 16, 8);
+  copy.Integrate(dt, steps, sam::BinaryTrajectoryObserver<state_type>(writer));
+  writer->Close();
+
+  sam::BinaryTrajectoryReader reader(filename);
+  REQUIRE(reader.GetNumberRecords() == positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    CHECK(reader.GetTime(i) == times[i]);
+    sam::StateView<double> state = reader.GetState(i);
+    REQUIRE(state.size() == positions[i].size());
+    for (size_t j = 0; j < state.size(); ++j) {
+      CHECK(state[j] == positions[i][j]);
+    }
+  }
+  std::remove(filename.c_str());
+}
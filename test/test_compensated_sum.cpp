@@ -0,0 +1,42 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <complex>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/compensated_sum.hpp"
+#include "include/sam/helper/coordinate_helper.hpp"
+
+TEST_CASE("compensated sum") {
+  sam::CompensatedSum sum;
+  CHECK(sum.Sum() == 0.);
+
+  SECTION("small values are not lost") {
+    sum.Add(1.);
+    for (size_t i = 0; i < 1000000; ++i) sum.Add(1e-16);
+    CHECK(sum.Sum() == Approx(1. + 1e-10).epsilon(1e-15));
+  }
+
+  SECTION("large values cancel") {
+    sum.Add(1e100);
+    sum.Add(1.);
+    sum.Add(-1e100);
+    CHECK(sum.Sum() == 1.);
+  }
+
+  SECTION("reset") {
+    sum.Add(2.5);
+    sum.Reset();
+    sum.Add(1.5);
+    CHECK(sum.Sum() == 1.5);
+  }
+}
+
+TEST_CASE("order parameter of many single precision phases") {
+  // all phases are the same, so the order parameter is exactly e^{i phi}
+  std::vector<float> phases(1000000, 0.5f);
+  std::complex<double> order = sam::OrderParameter(phases.begin(),
+                                                   phases.end());
+  CHECK(std::abs(order) == Approx(1.).epsilon(1e-14));
+  CHECK(std::arg(order) == Approx(0.5).epsilon(1e-7));
+}
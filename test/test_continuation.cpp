@@ -0,0 +1,185 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/analysis/continuation.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+typedef std::vector<double> state_type;
+
+namespace {
+
+// The limit cycle has the radius sqrt(mu) and the period 2 pi/omega, for
+// mu < 0 the origin is stable. With the shear alpha the angular velocity is
+// omega + alpha (mu - r^2), so the return times relax with the radius.
+class StuartLandauODE {
+ public:
+  explicit StuartLandauODE(double mu, double omega, double alpha = 0.)
+      : mu_(mu), omega_(omega), alpha_(alpha) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    double relaxation = mu_ - x[0]*x[0] - x[1]*x[1];
+    dx[0] = relaxation*(x[0] - alpha_*x[1]) - omega_*x[1];
+    dx[1] = relaxation*(x[1] + alpha_*x[0]) + omega_*x[0];
+  }
+
+ private:
+  double mu_;
+  double omega_;
+  double alpha_;
+};
+
+typedef sam::RK4System<StuartLandauODE> system_type;
+
+// Fails for mu < 0 like an ODE that is evaluated outside of its domain.
+class FailingODE : public StuartLandauODE {
+ public:
+  FailingODE(double mu, double omega) : StuartLandauODE(mu, omega), mu_(mu) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    if (mu_ < 0.) {
+      throw std::runtime_error("mu < 0");
+    }
+    StuartLandauODE::operator()(x, dx, t);
+  }
+
+ private:
+  double mu_;
+};
+
+void SetParameter(system_type& system, double mu) {
+  system.SetParameters(mu, 1. + mu);
+}
+
+void SetShearedParameter(system_type& system, double mu) {
+  system.SetParameters(mu, 1. + mu, 1.);
+}
+
+bool RightHalf(const state_type& x) {
+  return x[0] > 0;
+}
+
+}  // namespace
+
+TEST_CASE("continuation of the Stuart-Landau oscillator") {
+  system_type system(1, 2, 1., 1.);
+  system.SetPosition({0.5, 0.});
+  std::vector<double> parameters({0.5, 0.75, 1., 1.25, 1.5, 1.75});
+  sam::ContinuationParameters params;
+  params.dimension = 1;
+  const double dt = 0.01;
+
+  std::vector<sam::ContinuationPoint<state_type>> points = sam::ContinuePeriod(
+      system, parameters, SetParameter, dt, RightHalf, params, 1);
+  REQUIRE(points.size() == parameters.size());
+  for (size_t k = 0; k < points.size(); ++k) {
+    const double mu = parameters[k];
+    CHECK(points[k].parameter == mu);
+    CHECK(points[k].type == sam::PeriodType::kPeriodic);
+    CHECK(points[k].multiplicity == 1);
+    CHECK(points[k].period == Approx(2.*M_PI/(1. + mu)).margin(1e-6));
+    REQUIRE(points[k].amplitude.size() == 2);
+    CHECK(points[k].amplitude[0] == Approx(std::sqrt(mu)).margin(1e-3));
+    CHECK(points[k].amplitude[1] == Approx(std::sqrt(mu)).margin(1e-3));
+    CHECK(std::hypot(points[k].state[0], points[k].state[1])
+          == Approx(std::sqrt(mu)).margin(1e-6));
+  }
+  // the initial system is not changed
+  CHECK(system.GetTime() == 0.);
+
+  SECTION("parallel segments") {
+    params.segments = 3;
+    std::vector<sam::ContinuationPoint<state_type>> parallel =
+        sam::ContinuePeriod(system, parameters, SetParameter, dt, RightHalf,
+                            params, 3);
+    REQUIRE(parallel.size() == points.size());
+    for (size_t k = 0; k < points.size(); ++k) {
+      CHECK(parallel[k].parameter == points[k].parameter);
+      CHECK(parallel[k].period == Approx(points[k].period).margin(1e-6));
+      CHECK(parallel[k].amplitude[0] == Approx(points[k].amplitude[0])
+                                        .margin(1e-3));
+    }
+  }
+
+  SECTION("more segments than parameters") {
+    params.segments = 10;
+    std::vector<sam::ContinuationPoint<state_type>> parallel =
+        sam::ContinuePeriod(system, parameters, SetParameter, dt, RightHalf,
+                            params, 2);
+    REQUIRE(parallel.size() == points.size());
+    CHECK(parallel.back().period == Approx(points.back().period)
+                                    .margin(1e-6));
+  }
+
+  SECTION("the oscillation dies") {
+    // the section y = 0.1 is not reached for mu < 0, the points are lost, but
+    // the continuation goes on from the last limit cycle, the search is
+    // bounded by max_periods and not by the default max_iter
+    params.target = 0.1;
+    std::vector<double> hopf({0.5, 0.25, -0.25, -0.5, 0.25, 0.5});
+    std::vector<sam::ContinuationPoint<state_type>> crossed =
+        sam::ContinuePeriod(system, hopf, SetParameter, dt, RightHalf, params,
+                            1);
+    REQUIRE(crossed.size() == hopf.size());
+    for (size_t k : {2, 3}) {
+      CHECK(crossed[k].parameter == hopf[k]);
+      CHECK(crossed[k].type == sam::PeriodType::kNotConverged);
+      CHECK(crossed[k].period == -1.);
+      CHECK(crossed[k].crossings == 0);
+      CHECK(crossed[k].state == crossed[1].state);
+    }
+    for (size_t k : {0, 1, 4, 5}) {
+      CHECK(crossed[k].type == sam::PeriodType::kPeriodic);
+      CHECK(crossed[k].period == Approx(2.*M_PI/(1. + hopf[k])).margin(1e-6));
+      CHECK(crossed[k].amplitude[0] == Approx(std::sqrt(hopf[k]))
+                                       .margin(1e-3));
+    }
+  }
+
+  SECTION("warm start needs fewer crossings") {
+    std::vector<double> close({1., 1.1});
+    std::vector<sam::ContinuationPoint<state_type>> warm =
+        sam::ContinuePeriod(system, close, SetShearedParameter, dt, RightHalf,
+                            params, 1);
+    system_type cold(system);
+    SetShearedParameter(cold, close[1]);
+    sam::PeriodEstimate estimate = sam::EstimatePeriod(cold, dt, RightHalf,
+                                                       params);
+    CHECK(warm[1].period == Approx(estimate.period).margin(1e-6));
+    CHECK(warm[1].crossings == 3*params.max_multiplicity);
+    CHECK(warm[1].crossings < estimate.crossing_times.size());
+  }
+
+  SECTION("errors of the ODE are not taken as a dead oscillation") {
+    sam::RK4System<FailingODE> failing(1, 2, 1., 1.);
+    failing.SetPosition({0.5, 0.});
+    std::vector<double> hopf({0.5, -0.5});
+    CHECK_THROWS_AS(sam::ContinuePeriod(
+        failing, hopf, [](sam::RK4System<FailingODE>& s, double mu) {
+          s.SetParameters(mu, 1. + mu);
+        }, dt, RightHalf, params, 1), std::runtime_error);
+  }
+
+  SECTION("invalid parameters") {
+    params.window = 2;
+    CHECK_THROWS_AS(sam::ContinuePeriod(system, parameters, SetParameter, dt,
+                                        RightHalf, params, 2),
+                    std::invalid_argument);
+  }
+
+  SECTION("save the table") {
+    const std::string filename = "test_continuation.npy";
+    sam::SaveContinuation(filename, points);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    // the header and 6 rows of 6 doubles
+    CHECK(static_cast<size_t>(file.tellg()) == 128 + 6*6*sizeof(double));
+    file.close();
+    std::remove(filename.c_str());
+  }
+}
@@ -1,5 +1,7 @@
 // Copyright 2019 Erik Teichmann <kontakt.teichmann@gmail.com>
 
+#include <cmath>
+#include <complex>
 #include <vector>
 
 #include "test/catch.hpp"
@@ -81,4 +83,28 @@ TEST_CASE("cartesian to spherical for subvectors with iterators") {
   CHECK(spherical_3[1] == Approx(analytical_3[1]).margin(0.1));
   CHECK(spherical_3[2] == Approx(analytical_3[2]).margin(0.1));
 
-}
\ No newline at end of file
+}
+
+TEST_CASE("order parameter of phases") {
+  SECTION("synchronized phases") {
+    std::vector<double> phases(10, 0.5);
+    std::complex<double> order = sam::OrderParameter(phases.begin(),
+                                                     phases.end());
+    CHECK(std::abs(order) == Approx(1.));
+    CHECK(std::arg(order) == Approx(0.5));
+  }
+
+  SECTION("splay state") {
+    std::vector<double> phases;
+    for (int i = 0; i < 4; ++i) phases.push_back(i*M_PI/2.);
+    std::complex<double> order = sam::OrderParameter(phases.begin(),
+                                                     phases.end());
+    CHECK(std::abs(order) == Approx(0.).margin(1e-12));
+  }
+
+  SECTION("no phases") {
+    std::vector<double> phases;
+    CHECK(sam::OrderParameter(phases.begin(), phases.end())
+          == std::complex<double>(0., 0.));
+  }
+}
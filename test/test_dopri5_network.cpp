@@ -0,0 +1,53 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/system/dopri5_network.hpp"
+#include "include/sam/observer/position_observer.hpp"
+
+TEST_CASE("integrate two node system") {
+  // Analytic solution is x=A*sin(omega*t + phi)
+  // for x(0)=0 and \dot{x}(0)=1 the solution is
+  // x = 1/omega*sin(omega*t), \dot{x} = cos(omega*t)
+  double omega_1 = 2.;
+  double omega_2 = 4.;
+  double eps = 0.;
+  std::vector<unsigned int> N({1, 1});
+  unsigned int dimension = 2;
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*static_cast<double>(n);
+  std::vector<double> initial_condition({0., 1., 0., 1.});
+  sam::DOPRI5Network<CoupledHarmonicOscillatorODE> system(N, dimension,
+                                                          omega_1, omega_2,
+                                                          eps);
+  system.SetPosition(initial_condition);
+
+  SECTION("integrate with observer") {
+    std::vector<std::vector<double>> position;
+    std::vector<double> time;
+    system.Integrate(dt, n,
+                     sam::PositionObserver<std::vector<double>>(position,
+                                                                time));
+    REQUIRE(position.size() == n+1);
+    CHECK(system.GetTime() == Approx(t).margin(0.000001));
+    std::vector<double> numerical = system.GetPosition();
+    REQUIRE(numerical.size() == 4);
+    CHECK(numerical[0] == Approx(1./omega_1*sin(omega_1*t)).margin(0.0001));
+    CHECK(numerical[1] == Approx(cos(omega_1*t)).margin(0.0001));
+    CHECK(numerical[2] == Approx(1./omega_2*sin(omega_2*t)).margin(0.0001));
+    CHECK(numerical[3] == Approx(cos(omega_2*t)).margin(0.0001));
+  }
+
+  SECTION("integrate until end time") {
+    system.IntegrateUntil(t);
+    CHECK(system.GetTime() == Approx(t).margin(0.000001));
+    std::vector<std::vector<double>> nodes = system.GetNodes();
+    REQUIRE(nodes.size() == 2);
+    CHECK(nodes[0][0] == Approx(1./omega_1*sin(omega_1*t)).margin(0.0001));
+    CHECK(nodes[1][0] == Approx(1./omega_2*sin(omega_2*t)).margin(0.0001));
+  }
+}
@@ -0,0 +1,67 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/edge_list.hpp"
+
+TEST_CASE("build adjacency matrix") {
+  std::vector<sam::Edge> edges({sam::Edge(0, 1, 2.), sam::Edge(2, 0, 1.),
+                                sam::Edge(0, 1, 0.5)});
+
+  SECTION("directed") {
+    sam::AdjacencyMatrix adjacency = sam::BuildAdjacencyMatrix(3, edges);
+    REQUIRE(adjacency.rows() == 3);
+    REQUIRE(adjacency.cols() == 3);
+    CHECK(adjacency.nonZeros() == 2);
+    CHECK(adjacency.coeff(0, 1) == Approx(2.5));
+    CHECK(adjacency.coeff(1, 0) == 0.);
+    CHECK(adjacency.coeff(2, 0) == 1.);
+  }
+
+  SECTION("symmetric") {
+    sam::AdjacencyMatrix adjacency = sam::BuildAdjacencyMatrix(3, edges,
+                                                               true);
+    CHECK(adjacency.nonZeros() == 4);
+    CHECK(adjacency.coeff(1, 0) == Approx(2.5));
+    CHECK(adjacency.coeff(0, 2) == 1.);
+  }
+
+  SECTION("edge outside of network") {
+    edges.push_back(sam::Edge(3, 0, 1.));
+    CHECK_THROWS_AS(sam::BuildAdjacencyMatrix(3, edges),
+                    std::invalid_argument);
+  }
+}
+
+TEST_CASE("read edge list") {
+  SECTION("with and without weights") {
+    std::istringstream input("# comment\n0 1\n\n1 2 0.5\n  2 0 -1\n");
+    sam::AdjacencyMatrix adjacency = sam::ReadEdgeList(input, 3);
+    CHECK(adjacency.nonZeros() == 3);
+    CHECK(adjacency.coeff(0, 1) == 1.);
+    CHECK(adjacency.coeff(1, 2) == 0.5);
+    CHECK(adjacency.coeff(2, 0) == -1.);
+  }
+
+  SECTION("symmetric") {
+    std::istringstream input("0 1\n");
+    sam::AdjacencyMatrix adjacency = sam::ReadEdgeList(input, 2, true);
+    CHECK(adjacency.coeff(0, 1) == 1.);
+    CHECK(adjacency.coeff(1, 0) == 1.);
+  }
+
+  SECTION("malformed lines") {
+    std::istringstream missing_node("0\n");
+    CHECK_THROWS_AS(sam::ReadEdgeList(missing_node, 2),
+                    std::invalid_argument);
+    std::istringstream text("a b\n");
+    CHECK_THROWS_AS(sam::ReadEdgeList(text, 2), std::invalid_argument);
+    std::istringstream weight("0 1 w\n");
+    CHECK_THROWS_AS(sam::ReadEdgeList(weight, 2), std::invalid_argument);
+    std::istringstream outside("0 5\n");
+    CHECK_THROWS_AS(sam::ReadEdgeList(outside, 2), std::invalid_argument);
+  }
+}
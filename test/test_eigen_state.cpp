@@ -0,0 +1,201 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/eigen_state.hpp"
+#include "include/sam/analysis/henon.hpp"
+#include "include/sam/system/dopri5_system.hpp"
+#include "include/sam/system/euler_system.hpp"
+#include "include/sam/system/rk4_network.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+// Harmonic oscillators that work with any vector type.
+class GenericHarmonicOscillatorODE {
+ public:
+  double omega_;
+
+  explicit GenericHarmonicOscillatorODE(double omega): omega_(omega) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    for (unsigned int i = 0; i < x.size()/2; ++i) {
+      dx[2*i] = x[2*i+1];
+      dx[2*i+1] = -omega_*omega_*x[2*i];
+    }
+  }
+};
+
+TEST_CASE("state traits") {
+  SECTION("std::vector") {
+    std::vector<double> x = sam::StateTraits<std::vector<double>>::Zero(3);
+    REQUIRE(x.size() == 3);
+    REQUIRE(x[2] == 0.);
+    sam::StateTraits<std::vector<double>>::Resize(x, 5);
+    REQUIRE(x.size() == 5);
+  }
+
+  SECTION("dynamic Eigen vector") {
+    Eigen::VectorXd x = sam::StateTraits<Eigen::VectorXd>::Zero(3);
+    REQUIRE(x.size() == 3);
+    x[1] = 2.;
+    sam::StateTraits<Eigen::VectorXd>::Resize(x, 5);
+    REQUIRE(x.size() == 5);
+    REQUIRE(x[1] == 2.);
+    REQUIRE(x[4] == 0.);
+  }
+
+  SECTION("fixed Eigen vector") {
+    typedef sam::StateTraits<Eigen::Vector2d>::dynamic_type dynamic_type;
+    REQUIRE(std::is_same<dynamic_type, Eigen::VectorXd>::value);
+    Eigen::Vector2d x = sam::StateTraits<Eigen::Vector2d>::Zero(2);
+    REQUIRE(x[0] == 0.);
+  }
+}
+
+TEST_CASE("integrate system with Eigen vector") {
+  double omega = 2.;
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*n;
+
+  SECTION("RK4 with dynamic vector") {
+    sam::RK4System<GenericHarmonicOscillatorODE, Eigen::VectorXd> system(
+        2, 2, omega);
+    Eigen::VectorXd initial(4);
+    initial << 1., 0., 0., omega;
+    system.SetPosition(initial);
+    system.Integrate(dt, n);
+    Eigen::VectorXd x = system.GetPosition();
+    REQUIRE(system.GetTime() == Approx(t));
+    REQUIRE(x[0] == Approx(std::cos(omega*t)).margin(1e-6));
+    REQUIRE(x[1] == Approx(-omega*std::sin(omega*t)).margin(1e-6));
+    REQUIRE(x[2] == Approx(std::sin(omega*t)).margin(1e-6));
+    REQUIRE(x[3] == Approx(omega*std::cos(omega*t)).margin(1e-6));
+  }
+
+  SECTION("RK4 with fixed vector") {
+    sam::RK4System<GenericHarmonicOscillatorODE, Eigen::Vector2d> system(
+        1, 2, omega);
+    system.SetPosition(Eigen::Vector2d(1., 0.));
+    system.Integrate(dt, n);
+    Eigen::Vector2d x = system.GetPosition();
+    REQUIRE(x[0] == Approx(std::cos(omega*t)).margin(1e-6));
+    REQUIRE(x[1] == Approx(-omega*std::sin(omega*t)).margin(1e-6));
+  }
+
+  SECTION("Euler with dynamic vector") {
+    sam::EulerSystem<GenericHarmonicOscillatorODE, Eigen::VectorXd> system(
+        1, 2, omega);
+    Eigen::VectorXd initial(2);
+    initial << 1., 0.;
+    system.SetPosition(initial);
+    system.Integrate(0.0001, 10000);
+    Eigen::VectorXd x = system.GetPosition();
+    REQUIRE(x[0] == Approx(std::cos(omega)).margin(1e-3));
+    REQUIRE(x[1] == Approx(-omega*std::sin(omega)).margin(1e-3));
+  }
+
+  SECTION("DOPRI5 with dynamic vector") {
+    sam::DOPRI5System<GenericHarmonicOscillatorODE, Eigen::VectorXd> system(
+        1, 2, omega);
+    Eigen::VectorXd initial(2);
+    initial << 1., 0.;
+    system.SetPosition(initial);
+    system.Integrate(dt, n);
+    Eigen::VectorXd x = system.GetPosition();
+    REQUIRE(x[0] == Approx(std::cos(omega*t)).margin(1e-5));
+    REQUIRE(x[1] == Approx(-omega*std::sin(omega*t)).margin(1e-5));
+  }
+}
+
+TEST_CASE("mean field with Eigen vector") {
+  sam::RK4System<GenericHarmonicOscillatorODE, Eigen::VectorXd> system(
+      2, 2, 1.);
+  Eigen::VectorXd initial(4);
+  initial << 1., 0., 0., 1.;
+  system.SetPosition(initial);
+
+  SECTION("cartesian") {
+    Eigen::VectorXd mean_field = system.CalculateMeanField();
+    REQUIRE(mean_field.size() == 2);
+    REQUIRE(mean_field[0] == Approx(0.5));
+    REQUIRE(mean_field[1] == Approx(0.5));
+  }
+
+  SECTION("spherical") {
+    Eigen::VectorXd mean_field = system.CalculateMeanFieldSpherical();
+    REQUIRE(mean_field.size() == 2);
+    REQUIRE(mean_field[0] == Approx(std::sqrt(0.5)));
+    REQUIRE(mean_field[1] == Approx(M_PI/4.));
+  }
+
+  SECTION("position spherical") {
+    Eigen::VectorXd spherical = system.GetPositionSpherical();
+    REQUIRE(spherical[0] == Approx(1.));
+    REQUIRE(spherical[1] == Approx(0.).margin(1e-12));
+    REQUIRE(spherical[2] == Approx(1.));
+    REQUIRE(spherical[3] == Approx(M_PI/2.));
+  }
+
+  SECTION("fixed vector") {
+    sam::RK4System<GenericHarmonicOscillatorODE, Eigen::Vector4d> fixed(
+        2, 2, 1.);
+    fixed.SetPosition(initial);
+    Eigen::VectorXd mean_field = fixed.CalculateMeanField();
+    REQUIRE(mean_field.size() == 2);
+    REQUIRE(mean_field[0] == Approx(0.5));
+    REQUIRE(mean_field[1] == Approx(0.5));
+  }
+}
+
+TEST_CASE("network with Eigen vector") {
+  std::vector<unsigned int> node_sizes({1, 2});
+  sam::RK4Network<GenericHarmonicOscillatorODE, double, Eigen::VectorXd>
+      network(node_sizes, 2, 1.);
+  Eigen::VectorXd initial(6);
+  initial << 1., 0., 0., 1., 0., -1.;
+  network.SetPosition(initial);
+
+  SECTION("nodes") {
+    std::vector<Eigen::VectorXd> nodes = network.GetNodes();
+    REQUIRE(nodes.size() == 2);
+    REQUIRE(nodes[0].size() == 2);
+    REQUIRE(nodes[1].size() == 4);
+    REQUIRE(nodes[1][1] == 1.);
+    REQUIRE(nodes[1][3] == -1.);
+  }
+
+  SECTION("node mean fields") {
+    std::vector<Eigen::VectorXd> mean_field =
+        network.CalculateNodesMeanField();
+    REQUIRE(mean_field[0][0] == Approx(1.));
+    REQUIRE(mean_field[1][0] == Approx(0.).margin(1e-12));
+    REQUIRE(mean_field[1][1] == Approx(0.).margin(1e-12));
+  }
+
+  SECTION("integrate") {
+    double t = 1.;
+    network.Integrate(0.01, 100);
+    Eigen::VectorXd x = network.GetPosition();
+    REQUIRE(x[0] == Approx(std::cos(t)).margin(1e-6));
+    REQUIRE(x[5] == Approx(-std::cos(t)).margin(1e-6));
+  }
+}
+
+TEST_CASE("crossing with Eigen vector") {
+  sam::CrossingParameters params;
+  sam::RK4System<GenericHarmonicOscillatorODE, Eigen::VectorXd> system(
+      1, 2, 1.);
+  Eigen::VectorXd initial(2);
+  initial << 1., 0.;
+  system.SetPosition(initial);
+  std::pair<double, Eigen::VectorXd> crossing =
+      sam::IntegrateToCrossing(system, 0.01, params);
+  REQUIRE(crossing.first == Approx(M_PI/2.).margin(0.0001));
+  REQUIRE(crossing.second[0] == Approx(0).margin(0.001));
+  REQUIRE(crossing.second[1] == Approx(-1).margin(0.001));
+}
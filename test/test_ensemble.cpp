@@ -0,0 +1,77 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/system/ensemble.hpp"
+#include "include/sam/system/rk4_system.hpp"
+#include "include/sam/observer/position_observer.hpp"
+
+TEST_CASE("ensemble of harmonic oscillators") {
+  // for x(0)=0 and \dot{x}(0)=1 the solution is
+  // x = 1/omega*sin(omega*t), \dot{x} = cos(omega*t)
+  unsigned int n_threads = GENERATE(1, 3);
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*static_cast<double>(n);
+  sam::RK4System<HarmonicOscillatorODE> prototype(1, 2, 1.);
+  prototype.SetPosition({0., 1.});
+  std::vector<std::tuple<double>> parameters;
+  for (unsigned int i = 0; i < 10; ++i) {
+    parameters.push_back(std::make_tuple(0.5 + 0.25*i));
+  }
+  sam::Ensemble<sam::RK4System<HarmonicOscillatorODE>> ensemble(
+      prototype, parameters, n_threads);
+  REQUIRE(ensemble.GetSize() == parameters.size());
+
+  SECTION("members are integrated with their own parameters") {
+    ensemble.Integrate(dt, n);
+    std::vector<std::vector<double>> positions = ensemble.GetPositions();
+    REQUIRE(positions.size() == parameters.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+      double omega = std::get<0>(parameters[i]);
+      CHECK(positions[i][0] == Approx(1./omega*sin(omega*t)).margin(0.001));
+      CHECK(positions[i][1] == Approx(cos(omega*t)).margin(0.001));
+      CHECK(ensemble.GetMember(i).GetTime() == Approx(t).margin(0.000001));
+    }
+    // the prototype is not changed
+    CHECK(prototype.GetTime() == 0.);
+  }
+
+  SECTION("every member has its own observer") {
+    std::vector<std::vector<std::vector<double>>> x(ensemble.GetSize());
+    std::vector<std::vector<double>> times(ensemble.GetSize());
+    ensemble.Integrate(dt, n, [&](size_t i) {
+      return sam::PositionObserver<std::vector<double>>(x[i], times[i]);
+    });
+    for (size_t i = 0; i < x.size(); ++i) {
+      REQUIRE(x[i].size() == n+1);
+      REQUIRE(times[i].size() == n+1);
+      double omega = std::get<0>(parameters[i]);
+      CHECK(x[i].back()[0] == Approx(1./omega*sin(omega*t)).margin(0.001));
+    }
+  }
+}
+
+TEST_CASE("ensemble with multiple parameters") {
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*static_cast<double>(n);
+  sam::RK4System<CoupledHarmonicOscillatorODE> prototype(2, 2, 1., 1., 0.);
+  prototype.SetPosition({0., 1., 0., 1.});
+  std::vector<std::tuple<double, double, double>> parameters({
+    std::make_tuple(1., 2., 0.), std::make_tuple(2., 3., 0.)});
+  sam::Ensemble<sam::RK4System<CoupledHarmonicOscillatorODE>> ensemble(
+      prototype, parameters, 2);
+  ensemble.Integrate(dt, n);
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    std::vector<double> x = ensemble.GetMember(i).GetPosition();
+    double omega_1 = std::get<0>(parameters[i]);
+    double omega_2 = std::get<1>(parameters[i]);
+    CHECK(x[0] == Approx(1./omega_1*sin(omega_1*t)).margin(0.001));
+    CHECK(x[2] == Approx(1./omega_2*sin(omega_2*t)).margin(0.001));
+  }
+}
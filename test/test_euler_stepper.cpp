@@ -0,0 +1,49 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <vector>
+
+#include <boost/ref.hpp>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/system/euler_stepper.hpp"
+
+TEST_CASE("axpy adds scaled vector") {
+  std::vector<double> x({1., 2., 3.});
+  std::vector<double> y({1., 1., 1.});
+  sam::Axpy(2., x, y);
+  CHECK(y == std::vector<double>({3., 5., 7.}));
+}
+
+TEST_CASE("single steps of the steppers") {
+  double omega = 2.;
+  double dt = 0.1;
+  HarmonicOscillatorODE ode(omega);
+  std::vector<double> x({1., 1.});
+
+  SECTION("euler step") {
+    sam::EulerStepper<std::vector<double>> stepper;
+    stepper.do_step(boost::ref(ode), x, 0., dt);
+    CHECK(x[0] == Approx(1. + dt));
+    CHECK(x[1] == Approx(1. - dt*omega*omega));
+  }
+
+  SECTION("heun step") {
+    sam::HeunStepper<std::vector<double>> stepper;
+    stepper.do_step(boost::ref(ode), x, 0., dt);
+    // predictor (1 + dt, 1 - 4*dt)
+    double x_0 = 1. + 0.5*dt*(1. + (1. - dt*omega*omega));
+    double x_1 = 1. + 0.5*dt*(-omega*omega - omega*omega*(1. + dt));
+    CHECK(x[0] == Approx(x_0));
+    CHECK(x[1] == Approx(x_1));
+  }
+
+  SECTION("stepper adapts to size of the state") {
+    sam::EulerStepper<std::vector<double>> stepper;
+    stepper.do_step(boost::ref(ode), x, 0., dt);
+    std::vector<double> y({1., 1., 1., 1.});
+    stepper.do_step(boost::ref(ode), y, 0., dt);
+    CHECK(y[2] == Approx(1. + dt));
+    CHECK(y[3] == Approx(1. - dt*omega*omega));
+  }
+}
@@ -0,0 +1,80 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/analysis/events.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+typedef std::vector<double> state_type;
+
+TEST_CASE("Brent root finding") {
+  auto cosine = [](double x) { return std::cos(x); };
+  CHECK(sam::BrentRoot(cosine, 0., 3., 1., std::cos(3.), 1e-14, 100)
+        == Approx(M_PI/2.).margin(1e-14));
+  auto cubic = [](double x) { return x*x*x - 2.*x - 5.; };
+  CHECK(sam::BrentRoot(cubic, 2., 3., cubic(2.), cubic(3.), 1e-14, 100)
+        == Approx(2.0945514815423265).margin(1e-13));
+  // a root at the end of the bracket
+  CHECK(sam::BrentRoot(cubic, 0., 1., cubic(0.), 0., 1e-14, 100) == 1.);
+  CHECK_THROWS_AS(sam::BrentRoot(cosine, 0., 1., 1., std::cos(1.), 1e-14,
+                                 100),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(sam::BrentRoot(cosine, 0., 3., 1., std::cos(3.), 1e-14, 2),
+                  std::runtime_error);
+}
+
+TEST_CASE("events of a harmonic oscillator") {
+  // x = sin(t) has zeros at k pi
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({0., 1.});
+  const double dt = 0.01;
+  auto position = [](const state_type& x, double t) { return x[0]; };
+  sam::EventParameters params;
+
+  SECTION("both directions") {
+    std::vector<sam::Event<state_type>> events = sam::IntegrateWithEvents(
+        system, dt, 1000, position, params);
+    REQUIRE(events.size() == 3);
+    for (size_t k = 0; k < 3; ++k) {
+      CHECK(events[k].time == Approx((k + 1)*M_PI).margin(1e-9));
+      CHECK(events[k].state[0] == Approx(0.).margin(1e-12));
+      CHECK(events[k].direction == (k % 2 == 0 ? -1 : 1));
+    }
+    CHECK(system.GetTime() == Approx(10.));
+  }
+
+  SECTION("one direction") {
+    params.direction = sam::EventDirection::kRising;
+    std::vector<sam::Event<state_type>> events = sam::IntegrateWithEvents(
+        system, dt, 1000, position, params);
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].time == Approx(2.*M_PI).margin(1e-9));
+    CHECK(events[0].state[1] == Approx(1.).margin(1e-9));
+  }
+
+  SECTION("event function of the state and the time") {
+    // x = 1/2 at pi/6 and 5 pi/6, t - 1 = 0 at 1
+    auto section = [](const state_type& x, double t) {
+      return (x[0] - 0.5)*(t - 1.);
+    };
+    std::vector<sam::Event<state_type>> events = sam::IntegrateWithEvents(
+        system, dt, 300, section, params);
+    REQUIRE(events.size() == 3);
+    CHECK(events[0].time == Approx(M_PI/6.).margin(1e-9));
+    CHECK(events[1].time == Approx(1.).margin(1e-9));
+    CHECK(events[2].time == Approx(5.*M_PI/6.).margin(1e-9));
+  }
+
+  SECTION("stop after a number of events") {
+    params.max_events = 2;
+    std::vector<sam::Event<state_type>> events = sam::IntegrateWithEvents(
+        system, dt, 1000, position, params);
+    REQUIRE(events.size() == 2);
+    CHECK(system.GetTime() > 2.*M_PI);
+    CHECK(system.GetTime() < 2.*M_PI + dt);
+  }
+}
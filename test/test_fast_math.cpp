@@ -0,0 +1,137 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/coordinate_helper.hpp"
+#include "include/sam/helper/fast_math.hpp"
+
+namespace {
+
+std::vector<double> Range(double start, double end, size_t n) {
+  std::vector<double> x(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = start + (end - start)*i/static_cast<double>(n - 1);
+  }
+  return x;
+}
+
+}  // namespace
+
+TEST_CASE("sincos matches the standard library") {
+  std::vector<double> x = Range(-100., 100., 10001);
+  // exact multiples of pi/2 and the fallback for large values
+  x.push_back(0.);
+  x.push_back(M_PI_2);
+  x.push_back(-M_PI);
+  x.push_back(3.*M_PI_2);
+  x.push_back(1e6 + 0.3);
+  x.push_back(-1e7);
+  std::vector<double> sin(x.size()), cos(x.size());
+
+  SECTION("standard") {
+    sam::SinCos(x.data(), sin.data(), cos.data(), x.size(),
+                sam::MathAccuracy::kStandard);
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(sin[i] == std::sin(x[i]));
+      CHECK(cos[i] == std::cos(x[i]));
+    }
+  }
+
+  SECTION("high accuracy") {
+    sam::SinCos(x.data(), sin.data(), cos.data(), x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(sin[i] == Approx(std::sin(x[i])).margin(1e-14));
+      CHECK(cos[i] == Approx(std::cos(x[i])).margin(1e-14));
+    }
+  }
+
+  SECTION("low accuracy") {
+    sam::SinCos(x.data(), sin.data(), cos.data(), x.size(),
+                sam::MathAccuracy::kLow);
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(sin[i] == Approx(std::sin(x[i])).margin(1e-6));
+      CHECK(cos[i] == Approx(std::cos(x[i])).margin(1e-6));
+    }
+  }
+}
+
+TEST_CASE("atan2 matches the standard library") {
+  std::vector<double> angles = Range(-M_PI, M_PI, 1001);
+  std::vector<double> x, y;
+  for (double radius : {1e-3, 1., 50.}) {
+    for (double angle : angles) {
+      x.push_back(radius*std::cos(angle));
+      y.push_back(radius*std::sin(angle));
+    }
+  }
+  std::vector<double> angle(x.size());
+
+  for (auto accuracy : {sam::MathAccuracy::kHigh, sam::MathAccuracy::kLow}) {
+    double margin = accuracy == sam::MathAccuracy::kHigh ? 1e-14 : 1e-6;
+    sam::Atan2(y.data(), x.data(), angle.data(), x.size(), accuracy);
+    for (size_t i = 0; i < x.size(); ++i) {
+      // -pi and pi are the same angle
+      double difference = std::remainder(angle[i] - std::atan2(y[i], x[i]),
+                                         2.*M_PI);
+      CHECK(difference == Approx(0.).margin(margin));
+    }
+  }
+
+  double zero = 0.;
+  sam::Atan2(&zero, &zero, angle.data(), 1);
+  CHECK(angle[0] == 0.);
+}
+
+TEST_CASE("acos matches the standard library") {
+  std::vector<double> x = Range(-1., 1., 2001);
+  std::vector<double> angle(x.size());
+  sam::Acos(x.data(), angle.data(), x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    CHECK(angle[i] == Approx(std::acos(x[i])).margin(1e-14));
+  }
+}
+
+TEST_CASE("cartesian to polar coordinates") {
+  std::vector<double> angles = Range(0., 2.*M_PI - 1e-3, 301);
+  std::vector<double> cartesian;
+  for (double angle : angles) {
+    cartesian.push_back(2.*std::cos(angle));
+    cartesian.push_back(2.*std::sin(angle));
+  }
+  std::vector<double> polar(cartesian.size());
+
+  SECTION("into a different output") {
+    sam::CartesianToPolar(cartesian.data(), polar.data(), angles.size());
+  }
+
+  SECTION("in place") {
+    polar = cartesian;
+    sam::CartesianToPolar(polar.data(), polar.data(), angles.size());
+  }
+
+  for (size_t i = 0; i < angles.size(); ++i) {
+    CHECK(polar[2*i] == Approx(2.).margin(1e-14));
+    CHECK(polar[2*i + 1] == Approx(angles[i]).margin(1e-12));
+  }
+}
+
+TEST_CASE("cartesian to hyperspherical coordinates") {
+  // 300 points in 4d, more than one block, with all signs
+  const size_t n = 300, d = 4;
+  std::vector<double> cartesian(n*d);
+  for (size_t i = 0; i < cartesian.size(); ++i) {
+    cartesian[i] = std::sin(1.3*i + 0.2);
+  }
+  std::vector<double> spherical(cartesian.size());
+  sam::CartesianToHyperspherical(cartesian.data(), spherical.data(), n, d);
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<double> expected = sam::CartesianToSpherical<
+        std::vector<double>>(cartesian.begin() + i*d,
+                             cartesian.begin() + (i + 1)*d);
+    for (size_t j = 0; j < d; ++j) {
+      CHECK(spherical[i*d + j] == Approx(expected[j]).margin(1e-12));
+    }
+  }
+}
@@ -0,0 +1,189 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/analysis/henon.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/system/fixed_system.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+// Harmonic oscillators that work with any container.
+class TemplateHarmonicOscillatorODE {
+ public:
+  double omega_;
+
+  explicit TemplateHarmonicOscillatorODE(double omega): omega_(omega) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    for (unsigned int i = 0; i < x.size()/2; ++i) {
+      dx[2*i] = x[2*i+1];
+      dx[2*i+1] = -omega_*omega_*x[2*i];
+    }
+  }
+};
+
+// Phase oscillators with individual frequencies 1, 2, ...
+class RotationODE {
+ public:
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    for (unsigned int i = 0; i < x.size(); ++i) {
+      dx[i] = static_cast<double>(i + 1);
+    }
+  }
+};
+
+// Harmonic oscillator that adds to the derivative, like a sum of couplings.
+class AccumulatingODE {
+ public:
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    dx[0] += x[1];
+    dx[1] += -x[0];
+  }
+};
+
+TEST_CASE("integrate fixed system") {
+  double omega = 2.;
+  double dt = 0.01;
+  unsigned int n = 100;
+  double t = dt*static_cast<double>(n);
+  sam::FixedSystem<TemplateHarmonicOscillatorODE, 1, 2> system(omega);
+  system.SetPosition({0., 1.});
+
+  SECTION("integrate without observer") {
+    system.Integrate(dt, n);
+    std::array<double, 2> numerical = system.GetPosition();
+    CHECK(numerical[0] == Approx(1./omega*std::sin(omega*t)).margin(1e-6));
+    CHECK(numerical[1] == Approx(std::cos(omega*t)).margin(1e-6));
+    CHECK(system.GetTime() == Approx(t));
+  }
+
+  SECTION("same result as the dynamic system") {
+    sam::RK4System<TemplateHarmonicOscillatorODE> dynamic(1, 2, omega);
+    dynamic.SetPosition({0., 1.});
+    dynamic.Integrate(dt, n);
+    system.Integrate(dt, n);
+    std::vector<double> expected = dynamic.GetPosition();
+    std::array<double, 2> numerical = system.GetPosition();
+    CHECK(numerical[0] == Approx(expected[0]).margin(1e-12));
+    CHECK(numerical[1] == Approx(expected[1]).margin(1e-12));
+  }
+
+  SECTION("integrate with observer") {
+    std::vector<std::array<double, 2>> position;
+    std::vector<double> times;
+    system.Integrate(dt, 10,
+        sam::PositionObserver<std::array<double, 2>>(position, times));
+    REQUIRE(position.size() == 11);
+    REQUIRE(times.size() == 11);
+    CHECK(times.back() == Approx(10*dt));
+    CHECK(position.back()[1] == Approx(std::cos(omega*10*dt)).margin(1e-6));
+  }
+
+  SECTION("derivative") {
+    std::array<double, 2> derivative = system.GetDerivative();
+    CHECK(derivative[0] == Approx(1.));
+    CHECK(derivative[1] == Approx(0.));
+  }
+
+  SECTION("evaluate the derivative at another position") {
+    std::array<double, 2> dx;
+    system.EvaluateDerivative({0.5, 2.}, dx, 0.);
+    CHECK(dx[0] == Approx(2.));
+    CHECK(dx[1] == Approx(-omega*omega*0.5));
+  }
+
+  SECTION("the derivative starts at zero like for the dynamic system") {
+    sam::FixedSystem<AccumulatingODE, 1, 2> accumulating;
+    sam::RK4System<AccumulatingODE> dynamic(1, 2);
+    accumulating.SetPosition({0.5, 2.});
+    dynamic.SetPosition({0.5, 2.});
+    std::vector<double> expected = dynamic.GetDerivative();
+    std::array<double, 2> dx = {7., 7.};
+    accumulating.GetDerivative(dx);
+    CHECK(dx[0] == expected[0]);
+    CHECK(dx[1] == expected[1]);
+    dx = {7., 7.};
+    accumulating.EvaluateDerivative({0.5, 2.}, dx, 0.);
+    CHECK(dx[0] == expected[0]);
+    CHECK(dx[1] == expected[1]);
+    CHECK(accumulating.GetDerivative() == dx);
+    // the derivative that is passed to the observer
+    unsigned int calls = 0;
+    accumulating.IntegrateWithDerivative(dt, 3,
+        [&](const std::array<double, 2>& x, const std::array<double, 2>& dxdt,
+            double t) {
+      CHECK(dxdt[0] == x[1]);
+      CHECK(dxdt[1] == -x[0]);
+      ++calls;
+    });
+    CHECK(calls == 4);
+  }
+
+  SECTION("parameters") {
+    system.SetParameters(1.);
+    system.SetPosition({1., 0.});
+    std::array<double, 2> derivative = system.GetDerivative();
+    CHECK(derivative[1] == Approx(-1.));
+  }
+
+  SECTION("copy") {
+    sam::FixedSystem<TemplateHarmonicOscillatorODE, 1, 2> copy = system;
+    copy.Integrate(dt, n);
+    CHECK(system.GetTime() == 0.);
+    CHECK(copy.GetTime() == Approx(t));
+  }
+
+  SECTION("dimension") {
+    std::pair<unsigned int, unsigned int> dimension = system.GetDimension();
+    CHECK(dimension.first == 1);
+    CHECK(dimension.second == 2);
+  }
+}
+
+TEST_CASE("mean field of fixed system") {
+  SECTION("two dimensional oscillators") {
+    sam::FixedSystem<TemplateHarmonicOscillatorODE, 2, 2> system(1.);
+    system.SetPosition({1., 0., 0., 1.});
+    std::array<double, 2> mean_field = system.CalculateMeanField();
+    CHECK(mean_field[0] == Approx(0.5));
+    CHECK(mean_field[1] == Approx(0.5));
+    std::array<double, 2> spherical = system.CalculateMeanFieldSpherical();
+    CHECK(spherical[0] == Approx(std::sqrt(0.5)));
+    CHECK(spherical[1] == Approx(M_PI/4.));
+    std::array<double, 4> position = system.GetPositionSpherical();
+    CHECK(position[0] == Approx(1.));
+    CHECK(position[1] == Approx(0.).margin(1e-12));
+    CHECK(position[2] == Approx(1.));
+    CHECK(position[3] == Approx(M_PI/2.));
+  }
+
+  SECTION("phase oscillators") {
+    sam::FixedSystem<RotationODE, 2, 1> system;
+    system.SetPosition({0., M_PI/2.});
+    std::array<double, 2> spherical = system.CalculateMeanFieldSpherical();
+    CHECK(spherical[0] == Approx(std::sqrt(0.5)));
+    CHECK(spherical[1] == Approx(M_PI/4.));
+    system.Integrate(0.1, 10);
+    std::array<double, 2> position = system.GetPosition();
+    CHECK(position[0] == Approx(1.));
+    CHECK(position[1] == Approx(M_PI/2. + 2.));
+  }
+}
+
+TEST_CASE("crossing of fixed system") {
+  sam::CrossingParameters params;
+  sam::FixedSystem<TemplateHarmonicOscillatorODE, 1, 2> system(1.);
+  system.SetPosition({1., 0.});
+  std::pair<double, std::array<double, 2>> crossing =
+      sam::IntegrateToCrossing(system, 0.01, params);
+  CHECK(crossing.first == Approx(M_PI/2.).margin(0.0001));
+  CHECK(crossing.second[0] == Approx(0).margin(0.001));
+  CHECK(crossing.second[1] == Approx(-1).margin(0.001));
+}
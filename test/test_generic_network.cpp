@@ -1,5 +1,7 @@
 // Copyright 2019 Erik Teichmann <kontakt.teichmann@gmail.com>
 
+#include <cmath>
+#include <complex>
 #include <vector>
 #include <utility>
 
@@ -152,6 +154,23 @@ TEST_CASE("Derivative", "[generic_network]") {
     CHECK(nodes[1][2] == Approx(derivative[4]).margin(0.0001));
     CHECK(nodes[1][3] == Approx(derivative[5]).margin(0.0001));
     }
+
+  SECTION("derivative into a buffer") {
+    std::vector<double> buffer(x.size(), 100.);
+    system.GetDerivative(buffer);
+    REQUIRE(buffer.size() == derivative.size());
+    for (size_t i = 0; i < derivative.size(); ++i) {
+      CHECK(buffer[i] == Approx(derivative[i]).margin(0.0001));
+    }
+  }
+
+  SECTION("position view") {
+    auto view = system.GetPositionView();
+    REQUIRE(view.size() == x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(view[i] == x[i]);
+    }
+  }
 }
 
 TEST_CASE("Copying", "[generic_network]") {
@@ -363,4 +382,135 @@ TEST_CASE("nodes mean field in 1d", "[generic_network]") {
     CHECK(mean[2][0] == Approx(analytical[2][0]).margin(0.001));
     CHECK(mean[2][1] == Approx(analytical[2][1]).margin(0.001));
   }
-}
\ No newline at end of file
+}
+TEST_CASE("flat node views and buffers", "[generic_network]") {
+  // ODE will not be used, HarmonicOscillator as dummy
+  double omega = 1.;
+  std::vector<unsigned int> node_sizes({1, 0, 2});
+  sam::GenericNetwork<HarmonicOscillatorODE> system(node_sizes, 2, omega);
+  std::vector<double> x = {0., 2., 1., 0., 3., 0.};
+  system.SetPosition(x);
+
+  SECTION("nodes view") {
+    sam::RaggedView<double> nodes = system.GetNodesView();
+    REQUIRE(nodes.size() == 3);
+    REQUIRE(nodes.RowSize(0) == 2);
+    REQUIRE(nodes.RowSize(1) == 0);
+    REQUIRE(nodes.RowSize(2) == 4);
+    CHECK(nodes[0][1] == 2.);
+    CHECK(nodes[2][2] == 3.);
+    system.SetPosition({0., 1., 1., 0., 3., 0.});
+    CHECK(nodes[0][1] == 1.);
+  }
+
+  SECTION("nodes in spherical coordinates") {
+    sam::RaggedArray<std::vector<double>> nodes;
+    system.GetNodesSpherical(nodes);
+    std::vector<std::vector<double>> nested = system.GetNodesSpherical();
+    REQUIRE(nodes.size() == 3);
+    REQUIRE(nested.size() == 3);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      REQUIRE(nodes.RowSize(i) == nested[i].size());
+      for (size_t j = 0; j < nodes.RowSize(i); ++j) {
+        CHECK(nodes[i][j] == Approx(nested[i][j]).margin(1e-12));
+      }
+    }
+    CHECK(nodes[0][0] == Approx(2.).margin(1e-12));
+    CHECK(nodes[0][1] == Approx(M_PI/2.).margin(1e-12));
+
+    sam::RaggedArray<std::vector<double>> fast;
+    system.GetNodesSpherical(fast, sam::MathAccuracy::kHigh);
+    REQUIRE(fast.size() == nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      for (size_t j = 0; j < nodes.RowSize(i); ++j) {
+        CHECK(fast[i][j] == Approx(nodes[i][j]).margin(1e-14));
+      }
+    }
+  }
+
+  SECTION("derivative of the nodes") {
+    sam::RaggedArray<std::vector<double>> nodes;
+    system.GetDerivativeNodes(nodes);
+    REQUIRE(nodes.size() == 3);
+    REQUIRE(nodes.RowSize(2) == 4);
+    CHECK(nodes[0][0] == Approx(2.).margin(1e-12));
+    CHECK(nodes[2][3] == Approx(-3.).margin(1e-12));
+  }
+
+  SECTION("mean field of the nodes in one pass") {
+    sam::RaggedArray<std::vector<double>> mean_field;
+    system.CalculateNodesMeanField(mean_field);
+    REQUIRE(mean_field.size() == 3);
+    REQUIRE(mean_field.RowSize(2) == 2);
+    CHECK(mean_field[0][1] == Approx(2.).margin(1e-12));
+    CHECK(mean_field[2][0] == Approx(2.).margin(1e-12));
+    CHECK(mean_field[2][1] == Approx(0.).margin(1e-12));
+    system.CalculateNodesMeanFieldSpherical(mean_field);
+    REQUIRE(mean_field.size() == 3);
+    CHECK(mean_field[0][0] == Approx(2.).margin(1e-12));
+    CHECK(mean_field[0][1] == Approx(M_PI/2.).margin(1e-12));
+    CHECK(mean_field[2][0] == Approx(2.).margin(1e-12));
+    CHECK(mean_field[2][1] == Approx(0.).margin(1e-12));
+  }
+}
+
+TEST_CASE("nodes spherical mean field in 1d across blocks",
+          "[generic_network]") {
+  // more phases than one block of SinCos, with an empty node in between
+  double omega = 1.;
+  std::vector<unsigned int> node_sizes({200, 0, 57, 300});
+  sam::GenericNetwork<HarmonicOscillatorODE> system(node_sizes, 1, omega);
+  std::vector<double> x;
+  for (size_t i = 0; i < 557; ++i) x.push_back(0.01*i);
+  system.SetPosition(x);
+  sam::RaggedArray<std::vector<double>> mean_field;
+  system.CalculateNodesMeanFieldSpherical(mean_field);
+  REQUIRE(mean_field.size() == 4);
+  std::vector<unsigned int> indices = system.GetNodeIndices();
+  for (size_t node = 0; node < 4; ++node) {
+    std::complex<double> order = sam::OrderParameter(
+        x.begin() + indices[node], x.begin() + indices[node+1]);
+    CHECK(mean_field[node][0] == Approx(std::abs(order)).margin(1e-12));
+    CHECK(mean_field[node][1] == Approx(std::arg(order)).margin(1e-12));
+  }
+}
+
+TEST_CASE("mean fields of a single precision network", "[generic_network]") {
+  std::vector<unsigned int> node_sizes({3000, 1000});
+  sam::GenericNetwork<HarmonicOscillatorODE, float> system(node_sizes, 2, 1.);
+  std::vector<float> x;
+  std::vector<double> x_double;
+  for (size_t i = 0; i < 4000; ++i) {
+    float phase = static_cast<float>(std::fmod(0.7*i, 2*M_PI));
+    float radius = i < 3000 ? 1.f : 0.5f;
+    x.push_back(radius*std::cos(phase));
+    x.push_back(radius*std::sin(phase) + 0.1f);
+    x_double.push_back(x[x.size() - 2]);
+    x_double.push_back(x.back());
+  }
+  system.SetPosition(x);
+
+  SECTION("nodes mean field is summed in double precision") {
+    sam::RaggedArray<std::vector<float>> mean_field;
+    system.CalculateNodesMeanField(mean_field);
+    REQUIRE(mean_field.size() == 2);
+    double sum_x = 0., sum_y = 0.;
+    for (size_t i = 0; i < 3000; ++i) {
+      sum_x += x_double[2*i];
+      sum_y += x_double[2*i + 1];
+    }
+    CHECK(mean_field[0][0] == Approx(sum_x/3000.).margin(1e-7));
+    CHECK(mean_field[0][1] == Approx(sum_y/3000.).margin(1e-7));
+  }
+
+  SECTION("spherical coordinates") {
+    std::vector<std::vector<float>> nodes = system.GetNodesSpherical();
+    REQUIRE(nodes.size() == 2);
+    REQUIRE(nodes[1].size() == 2000);
+    double radius = std::hypot(x_double[6000], x_double[6001]);
+    CHECK(nodes[1][0] == Approx(radius).margin(1e-6));
+    std::vector<float> mean_field = system.CalculateMeanFieldSpherical();
+    REQUIRE(mean_field.size() == 2);
+    CHECK(mean_field[0] == Approx(0.1).margin(1e-3));
+  }
+}
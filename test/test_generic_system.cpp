@@ -50,6 +50,43 @@ TEST_CASE("simple system", "[generic_system]") {
     CHECK(position[1] == Approx(initial[1]).margin(0.01));
   }
 
+  SECTION("position view shows the current position") {
+    std::vector<double> initial {0.5, 0.1};
+    system.SetPosition(initial);
+    auto view = system.GetPositionView();
+    REQUIRE(view.size() == dimension);
+    CHECK(view[0] == initial[0]);
+    CHECK(view[1] == initial[1]);
+    system.SetPosition({0.2, 0.3});
+    CHECK(view[0] == 0.2);
+    CHECK(view[1] == 0.3);
+  }
+
+  SECTION("evaluate the derivative at another position") {
+    system.SetPosition({0.5, 0.1});
+    std::vector<double> dx({7., 7.});
+    system.EvaluateDerivative({0.2, 0.3}, dx, 1.);
+    CHECK(dx[0] == Approx(0.3));
+    CHECK(dx[1] == Approx(-0.8));
+    CHECK(system.GetPosition() == std::vector<double>({0.5, 0.1}));
+    CHECK(system.GetTime() == 0.);
+  }
+
+  SECTION("write the derivative into a buffer") {
+    system.SetPosition({0.5, 0.1});
+    std::vector<double> derivative;
+    system.GetDerivative(derivative);
+    REQUIRE(derivative.size() == dimension);
+    CHECK(derivative[0] == Approx(0.1).margin(0.01));
+    CHECK(derivative[1] == Approx(-2.).margin(0.01));
+    const double* data = derivative.data();
+    system.SetPosition({0.2, 0.3});
+    system.GetDerivative(derivative);
+    CHECK(derivative.data() == data);
+    CHECK(derivative[0] == Approx(0.3).margin(0.01));
+    CHECK(derivative[1] == Approx(-0.8).margin(0.01));
+  }
+
   SECTION("can resize the system") {
     system.Resize(2);
     // check if state has correct size
@@ -186,6 +223,39 @@ TEST_CASE("position in spherical coordinates 2d", "[generic_system]") {
   CHECK(spherical[5] == Approx(analytical[5]).margin(0.1));
 }
 
+TEST_CASE("accuracy of the spherical coordinates 2d", "[generic_system]") {
+  sam::GenericSystem<HarmonicOscillatorODE> system(3, 2, 1.);
+  std::vector<double> x = {1., 2., -3., 4., 5., -6.};
+  system.SetPosition(x);
+  // the default is the standard library like CartesianToSpherical
+  std::vector<double> standard = system.GetPositionSpherical();
+  for (size_t i = 0; i < x.size(); i += 2) {
+    std::vector<double> element = sam::CartesianToSpherical<
+        std::vector<double>>(x.begin() + i, x.begin() + i + 2);
+    CHECK(standard[i] == element[0]);
+    CHECK(standard[i + 1] == element[1]);
+  }
+  std::vector<double> high = system.GetPositionSpherical(
+      sam::MathAccuracy::kHigh);
+  REQUIRE(high.size() == standard.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    CHECK(high[i] == Approx(standard[i]).margin(1e-14));
+  }
+}
+
+TEST_CASE("accuracy of the spherical coordinates 3d", "[generic_system]") {
+  sam::GenericSystem<HarmonicOscillatorODE> system(2, 3, 1.);
+  std::vector<double> x = {1., 2., -3., 4., -5., 6.};
+  system.SetPosition(x);
+  std::vector<double> standard = system.GetPositionSpherical();
+  std::vector<double> high = system.GetPositionSpherical(
+      sam::MathAccuracy::kHigh);
+  REQUIRE(high.size() == standard.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    CHECK(high[i] == Approx(standard[i]).margin(1e-14));
+  }
+}
+
 TEST_CASE("mean field in 2d with 2 oscillators", "[generic_system]") {
   // use HarmonicOscillatorODE as a dummy ODE with dimensionality 2
   double omega = 1;
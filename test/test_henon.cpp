@@ -1,6 +1,7 @@
 // Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
 
 #include <cmath>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -9,6 +10,50 @@
 #include "include/sam/analysis/henon.hpp"
 #include "include/sam/system/rk4_system.hpp"
 
+// Counts the copies, the Henon trick should evaluate the original ODE.
+class CountingHarmonicOscillatorODE: public HarmonicOscillatorODE {
+ public:
+  static unsigned int copies;
+
+  explicit CountingHarmonicOscillatorODE(double omega)
+    : HarmonicOscillatorODE(omega) {}
+
+  CountingHarmonicOscillatorODE(const CountingHarmonicOscillatorODE& other)
+    : HarmonicOscillatorODE(other) {
+    ++copies;
+  }
+};
+
+unsigned int CountingHarmonicOscillatorODE::copies = 0;
+
+// A user-defined system with only the original interface, without
+// EvaluateDerivative.
+class MinimalSystem {
+ public:
+  explicit MinimalSystem(double omega) : system_(1, 2, omega) {}
+
+  std::vector<double> GetPosition() const { return system_.GetPosition(); }
+
+  void SetPosition(const std::vector<double>& x) { system_.SetPosition(x); }
+
+  double GetTime() const { return system_.GetTime(); }
+
+  void SetTime(double t) { system_.SetTime(t); }
+
+  std::vector<double> GetDerivative() const {
+    return system_.GetDerivative();
+  }
+
+  std::pair<unsigned int, unsigned int> GetDimension() const {
+    return system_.GetDimension();
+  }
+
+  void Integrate(double dt, unsigned int n) { system_.Integrate(dt, n); }
+
+ private:
+  sam::RK4System<HarmonicOscillatorODE> system_;
+};
+
 TEST_CASE("single harmonic oscillator") {
   // omega = 1 -> T = 2*pi and crossing y-axis happens at pi/4
   sam::CrossingParameters params;
@@ -243,3 +288,47 @@ TEST_CASE("two uncoupled harmonic oscillators") {
     REQUIRE(crossing.second[3] == Approx(0).margin(0.001));
   }
 }
+
+TEST_CASE("crossing that is never reached") {
+  sam::CrossingParameters params;
+  params.target = 5.;
+  params.max_iter = 1000;
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  CHECK_THROWS_AS(sam::IntegrateToCrossing(system, 0.01, params),
+                  std::runtime_error);
+  CHECK(system.GetTime() == Approx(10.));
+}
+
+TEST_CASE("Henon trick does not copy the ODE") {
+  sam::RK4System<CountingHarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  system.Integrate(0.01, static_cast<unsigned int>(M_PI/2./0.01));
+  CountingHarmonicOscillatorODE::copies = 0;
+  sam::CrossingParameters params;
+  std::pair<double, std::vector<double>> crossing = HenonTrick(system,
+                                                               params);
+  CHECK(crossing.first == Approx(M_PI/2.).margin(0.0001));
+  CHECK(CountingHarmonicOscillatorODE::copies == 0);
+}
+
+TEST_CASE("Henon trick for a system without EvaluateDerivative") {
+  CHECK_FALSE(sam::HasEvaluateDerivative<MinimalSystem,
+                                         std::vector<double>>::value);
+  CHECK(sam::HasEvaluateDerivative<sam::RK4System<HarmonicOscillatorODE>,
+                                   std::vector<double>>::value);
+  MinimalSystem system(1.);
+  system.SetPosition({1., 0.});
+  system.Integrate(0.01, static_cast<unsigned int>(M_PI/2./0.01));
+  sam::RK4System<HarmonicOscillatorODE> reference(1, 2, 1.);
+  reference.SetPosition(system.GetPosition());
+  reference.SetTime(system.GetTime());
+  sam::CrossingParameters params;
+  std::pair<double, std::vector<double>> crossing = HenonTrick(system,
+                                                               params);
+  std::pair<double, std::vector<double>> expected = HenonTrick(reference,
+                                                               params);
+  CHECK(crossing.first == expected.first);
+  CHECK(crossing.second == expected.second);
+  CHECK(crossing.first == Approx(M_PI/2.).margin(0.0001));
+}
@@ -0,0 +1,138 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <array>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/helper/ring_buffer.hpp"
+#include "include/sam/observer/derivative_observer.hpp"
+#include "include/sam/observer/pos_deriv_observer.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/observer/ring_buffer_observer.hpp"
+#include "include/sam/system/fixed_system.hpp"
+#include "include/sam/system/rk4_network.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+// Harmonic oscillators that count the evaluations.
+class CountingODE {
+ public:
+  double omega_;
+  unsigned int* counter_;
+
+  CountingODE(double omega, unsigned int* counter)
+      : omega_(omega), counter_(counter) {}
+
+  template<typename state_type>
+  void operator()(const state_type& x, state_type& dx, double t) {
+    ++(*counter_);
+    for (unsigned int i = 0; i < x.size()/2; ++i) {
+      dx[2*i] = x[2*i+1];
+      dx[2*i+1] = -omega_*omega_*x[2*i];
+    }
+  }
+};
+
+TEST_CASE("integrate with derivative") {
+  double omega = 2.;
+  double dt = 0.01;
+  unsigned int n = 50;
+  std::vector<double> initial_condition({0.3, 1., -0.5, 0.2});
+  sam::RK4System<HarmonicOscillatorODE> system(2, 2, omega);
+  system.SetPosition(initial_condition);
+  sam::RK4System<HarmonicOscillatorODE> reference = system;
+
+  std::vector<std::vector<double>> x, dx, x_reference;
+  std::vector<double> t, t_reference;
+  system.IntegrateWithDerivative(dt, n,
+      sam::PosDerivObserver<sam::RK4System<HarmonicOscillatorODE>,
+                            std::vector<double>>(system, x, dx, t));
+  reference.Integrate(dt, n, sam::PositionObserver<std::vector<double>>(
+      x_reference, t_reference));
+
+  SECTION("positions and times are the same as without derivative") {
+    REQUIRE(x.size() == n + 1);
+    REQUIRE(x.size() == x_reference.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(x[i] == x_reference[i]);
+      CHECK(t[i] == t_reference[i]);
+    }
+    CHECK(system.GetPosition() == reference.GetPosition());
+    CHECK(system.GetTime() == reference.GetTime());
+  }
+
+  SECTION("passed derivative is the derivative at the position") {
+    REQUIRE(dx.size() == n + 1);
+    for (size_t i = 0; i < dx.size(); ++i) {
+      REQUIRE(dx[i].size() == x[i].size());
+      for (size_t j = 0; j < x[i].size()/2; ++j) {
+        CHECK(dx[i][2*j] == x[i][2*j+1]);
+        CHECK(dx[i][2*j+1] == -omega*omega*x[i][2*j]);
+      }
+    }
+  }
+}
+
+TEST_CASE("integrate with derivative evaluates ode once per stage") {
+  unsigned int counter = 0;
+  unsigned int n = 20;
+  sam::RK4System<CountingODE> system(1, 2, 1., &counter);
+  system.SetPosition({1., 0.});
+  std::vector<std::vector<double>> dx;
+  std::vector<double> t;
+  system.IntegrateWithDerivative(0.1, n,
+      sam::DerivativeObserver<sam::RK4System<CountingODE>,
+                              std::vector<double>>(system, dx, t));
+  CHECK(counter == 4*n + 1);
+  CHECK(dx.size() == n + 1);
+
+  SECTION("derivative ring buffer") {
+    sam::RingBuffer<std::vector<double>> buffer(4, {0., 0.});
+    counter = 0;
+    system.IntegrateWithDerivative(0.1, n,
+        sam::DerivativeRingBufferObserver<sam::RK4System<CountingODE>,
+                                          std::vector<double>>(system,
+                                                               buffer));
+    CHECK(counter == 4*n + 1);
+    REQUIRE(buffer.size() == 4);
+    std::vector<double> derivative = system.GetDerivative();
+    CHECK(buffer.GetState(buffer.size() - 1) == derivative);
+    CHECK(buffer.GetTime(buffer.size() - 1) == Approx(system.GetTime()));
+  }
+}
+
+TEST_CASE("network integrates with derivative") {
+  sam::RK4Network<HarmonicOscillatorODE> network({1, 1}, 2, 1.);
+  network.SetPosition({1., 0., 0., 1.});
+  sam::RK4Network<HarmonicOscillatorODE> reference = network;
+  std::vector<std::vector<double>> x, dx;
+  std::vector<double> t;
+  network.IntegrateWithDerivative(0.01, 10,
+      sam::PosDerivObserver<sam::RK4Network<HarmonicOscillatorODE>,
+                            std::vector<double>>(network, x, dx, t));
+  reference.Integrate(0.01, 10);
+  CHECK(network.GetPosition() == reference.GetPosition());
+  REQUIRE(dx.size() == 11);
+  CHECK(dx.back()[0] == x.back()[1]);
+}
+
+TEST_CASE("fixed system integrates with derivative") {
+  typedef sam::FixedSystem<CountingODE, 1, 2> system_type;
+  typedef system_type::state_type state_type;
+  unsigned int counter = 0;
+  unsigned int n = 10;
+  system_type system(1., &counter);
+  system.SetPosition({1., 0.});
+  system_type reference = system;
+  std::vector<state_type> x, dx;
+  std::vector<double> t;
+  counter = 0;
+  system.IntegrateWithDerivative(0.01, n,
+      sam::PosDerivObserver<system_type, state_type>(system, x, dx, t));
+  CHECK(counter == 4*n + 1);
+  reference.Integrate(0.01, n);
+  CHECK(system.GetPosition() == reference.GetPosition());
+  REQUIRE(dx.size() == n + 1);
+  CHECK(dx.back()[0] == x.back()[1]);
+  CHECK(dx.back()[1] == -x.back()[0]);
+}
@@ -0,0 +1,145 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/analysis/isochrons.hpp"
+#include "include/sam/analysis/phase.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+typedef std::vector<double> state_type;
+
+namespace {
+
+// In polar coordinates dr/dt = kappa r (1 - r^2) and
+// dtheta/dt = omega + alpha kappa (1 - r^2), the limit cycle contracts by
+// exp(-2 kappa T) per period.
+class StuartLandauODE {
+ public:
+  explicit StuartLandauODE(double alpha, double omega, double kappa = 1.)
+      : alpha_(alpha), omega_(omega), kappa_(kappa) {}
+
+  void operator()(const state_type& x, state_type& dx, double t) {
+    double relaxation = kappa_*(1. - x[0]*x[0] - x[1]*x[1]);
+    dx[0] = relaxation*(x[0] - alpha_*x[1]) - omega_*x[1];
+    dx[1] = relaxation*(x[1] + alpha_*x[0]) + omega_*x[0];
+  }
+
+ private:
+  double alpha_;
+  double omega_;
+  double kappa_;
+};
+
+bool UpperHalf(const state_type& x) {
+  return x[1] > 0;
+}
+
+// the isochrons are logarithmic spirals, the phase is 0 at the crossing of
+// the positive y-axis
+double AnalyticPhase(const state_type& x, double alpha) {
+  double phi = std::atan2(x[1], x[0])
+               - alpha*std::log(std::sqrt(x[0]*x[0] + x[1]*x[1])) - M_PI/2.;
+  return phi < 0 ? phi + 2*M_PI : phi;
+}
+
+}  // namespace
+
+TEST_CASE("isochron grid") {
+  sam::IsochronGrid<state_type> grid({0., 0., 5.}, {2, 0}, {-1., 0.},
+                                     {1., 3.}, {3, 4});
+  CHECK(grid.size() == 12);
+  CHECK(grid.GetShape() == std::vector<size_t>({3, 4}));
+  state_type x;
+  grid.GetPoint(0, x);
+  CHECK(x == state_type({0., 0., -1.}));
+  // the last coordinate changes fastest
+  grid.GetPoint(1, x);
+  CHECK(x == state_type({1., 0., -1.}));
+  grid.GetPoint(11, x);
+  CHECK(x == state_type({3., 0., 1.}));
+
+  CHECK_THROWS_AS(sam::IsochronGrid<state_type>({0., 0.}, {0}, {0.}, {1.},
+                                                {2}),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(sam::IsochronGrid<state_type>({0., 0.}, {0, 2}, {0., 0.},
+                                                {1., 1.}, {2, 2}),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(sam::IsochronGrid<state_type>({0., 0.}, {0, 1}, {0., 0.},
+                                                {1., 1.}, {2, 0}),
+                  std::invalid_argument);
+}
+
+TEST_CASE("isochrons of the Stuart-Landau oscillator") {
+  const double alpha = 0.1;
+  const double omega = 0.9;
+  const double T = 2*M_PI/omega;
+  sam::PhaseParameters params;
+  sam::RK4System<StuartLandauODE> system(1, 2, alpha, omega);
+
+  SECTION("early exit agrees with FindPhase") {
+    state_type x({0.3, -1.4});
+    sam::RK4System<StuartLandauODE> copy = system;
+    double phase = sam::IsochronPhase(copy, x, T, UpperHalf, params);
+    CHECK(phase == Approx(AnalyticPhase(x, alpha)).margin(1e-4));
+    CHECK(phase == Approx(sam::FindPhase(x, T, system, UpperHalf, params))
+                   .margin(1e-4));
+    // close to the cycle only a few periods are integrated
+    CHECK(copy.GetTime() < 5*T);
+  }
+
+  SECTION("weakly attracting limit cycle") {
+    // the multiplier is exp(-2 kappa T) = 0.87, stopping as soon as two
+    // estimates differ by less than the tolerance would leave an error of
+    // about 7 times the tolerance
+    const double kappa = 0.01;
+    params.phase_tolerance = 1e-6;
+    params.phase_max_iter = 1000;
+    sam::RK4System<StuartLandauODE> weak(1, 2, alpha, omega, kappa);
+    for (const state_type& x : {state_type({0.3, -1.4}),
+                                state_type({-0.2, 0.5})}) {
+      double phase = sam::IsochronPhase(weak, x, T, UpperHalf, params);
+      double difference = std::remainder(phase - AnalyticPhase(x, alpha),
+                                         2*M_PI);
+      CHECK(difference == Approx(0.).margin(params.phase_tolerance));
+    }
+  }
+
+  SECTION("unstable fixed point does not converge") {
+    params.phase_max_iter = 5;
+    sam::RK4System<StuartLandauODE> copy = system;
+    CHECK(sam::IsochronPhase(copy, state_type({0., 0.}), T, UpperHalf,
+                             params) == -1);
+  }
+
+  SECTION("grid in parallel") {
+    // the grid contains the origin
+    sam::IsochronGrid<state_type> grid({0., 0.}, {0, 1}, {-1.5, -1.5},
+                                       {1.5, 1.5}, {7, 5});
+    std::vector<double> phases = sam::CalculateIsochrons(grid, T, system,
+                                                         UpperHalf, params, 4);
+    REQUIRE(phases.size() == grid.size());
+    state_type x;
+    for (size_t i = 0; i < grid.size(); ++i) {
+      grid.GetPoint(i, x);
+      if (x[0] == 0. && x[1] == 0.) {
+        CHECK(phases[i] == -1);
+      } else {
+        double difference = std::remainder(
+            phases[i] - AnalyticPhase(x, alpha), 2*M_PI);
+        CHECK(difference == Approx(0.).margin(1e-4));
+      }
+    }
+
+    std::string filename = "test_isochrons.npy";
+    sam::SaveIsochrons(filename, grid, phases);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    CHECK(static_cast<size_t>(file.tellg()) == 128 + 35*sizeof(double));
+    std::remove(filename.c_str());
+  }
+}
@@ -0,0 +1,146 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/system/kuramoto_ode.hpp"
+#include "include/sam/system/rk4_network.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+std::vector<double> Phases(size_t N) {
+  std::vector<double> phases(N);
+  for (size_t i = 0; i < N; ++i) {
+    phases[i] = std::fmod(2.3*static_cast<double>(i), 2*M_PI);
+  }
+  return phases;
+}
+
+TEST_CASE("global Kuramoto ODE") {
+  size_t N = 20;
+  double coupling = 1.3;
+  double phase_lag = 0.4;
+  std::vector<double> frequencies(N);
+  for (size_t i = 0; i < N; ++i) {
+    frequencies[i] = 1. + 0.1*static_cast<double>(i);
+  }
+  std::vector<double> phases = Phases(N);
+
+  SECTION("agrees with the pairwise sum") {
+    sam::KuramotoODE ode(frequencies, coupling, phase_lag);
+    std::vector<double> dx(N);
+    ode(phases, dx, 0.);
+    for (size_t i = 0; i < N; ++i) {
+      double pairwise = 0.;
+      for (size_t j = 0; j < N; ++j) {
+        pairwise += std::sin(phases[j] - phases[i] - phase_lag);
+      }
+      double expected = frequencies[i] + coupling/N*pairwise;
+      CHECK(dx[i] == Approx(expected).margin(1e-12));
+    }
+  }
+
+  SECTION("strong coupling synchronizes") {
+    std::vector<double> identical(N, 1.);
+    sam::RK4System<sam::KuramotoODE> system(N, 1, identical, 2.);
+    system.SetPosition(phases);
+    system.Integrate(0.05, 1000);
+    std::vector<double> order = system.CalculateMeanFieldSpherical();
+    CHECK(order[0] == Approx(1.).margin(1e-6));
+  }
+
+  SECTION("wrong number of phases") {
+    sam::KuramotoODE ode(frequencies, coupling);
+    std::vector<double> x(N+1), dx(N+1);
+    CHECK_THROWS_AS(ode(x, dx, 0.), std::length_error);
+  }
+}
+
+TEST_CASE("population Kuramoto ODE") {
+  std::vector<unsigned int> node_sizes({5, 0, 8});
+  size_t N = 13;
+  std::vector<double> frequencies(N);
+  for (size_t i = 0; i < N; ++i) {
+    frequencies[i] = 0.5 + 0.05*static_cast<double>(i);
+  }
+  std::vector<std::vector<double>> coupling({{1., 0.3, 0.2},
+                                             {0.1, 0., 0.4},
+                                             {-0.5, 0.7, 2.}});
+  std::vector<std::vector<double>> phase_lag({{0., 0.1, 0.2},
+                                              {0.3, 0.4, 0.5},
+                                              {0.6, 0.7, 1.}});
+  std::vector<double> phases = Phases(N);
+
+  SECTION("agrees with the pairwise sum") {
+    sam::PopulationKuramotoODE ode(node_sizes, frequencies, coupling,
+                                   phase_lag);
+    std::vector<double> dx(N);
+    ode(phases, dx, 0.);
+    std::vector<size_t> indices({0, 5, 5, 13});
+    for (size_t a = 0; a < 3; ++a) {
+      for (size_t i = indices[a]; i < indices[a+1]; ++i) {
+        double expected = frequencies[i];
+        for (size_t b = 0; b < 3; ++b) {
+          size_t size = indices[b+1] - indices[b];
+          for (size_t j = indices[b]; j < indices[b+1]; ++j) {
+            expected += coupling[a][b]/size
+                        *std::sin(phases[j] - phases[i] - phase_lag[a][b]);
+          }
+        }
+        CHECK(dx[i] == Approx(expected).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("populations synchronize separately") {
+    std::vector<double> identical(N, 1.);
+    std::vector<std::vector<double>> separate({{2., 0., 0.},
+                                               {0., 0., 0.},
+                                               {0., 0., 2.}});
+    sam::RK4Network<sam::PopulationKuramotoODE> network(
+        node_sizes, 1, node_sizes, identical, separate);
+    network.SetPosition(phases);
+    network.Integrate(0.05, 1000);
+    std::vector<std::vector<double>> order =
+        network.CalculateNodesMeanFieldSpherical();
+    CHECK(order[0][0] == Approx(1.).margin(1e-6));
+    CHECK(order[2][0] == Approx(1.).margin(1e-6));
+  }
+
+  SECTION("sizes have to match") {
+    CHECK_THROWS_AS(sam::PopulationKuramotoODE(node_sizes,
+                                               std::vector<double>(N+1),
+                                               coupling),
+                    std::length_error);
+    coupling[1].pop_back();
+    CHECK_THROWS_AS(sam::PopulationKuramotoODE(node_sizes, frequencies,
+                                               coupling),
+                    std::length_error);
+  }
+}
+
+TEST_CASE("Kuramoto ODE in single precision") {
+  size_t N = 1000;
+  std::vector<double> frequencies(N);
+  for (size_t i = 0; i < N; ++i) {
+    frequencies[i] = 1. + 0.001*static_cast<double>(i);
+  }
+  std::vector<double> phases = Phases(N);
+  std::vector<float> phases_float(phases.begin(), phases.end());
+  sam::RK4System<sam::KuramotoODE> system(N, 1, frequencies, 1.5);
+  sam::RK4System<sam::KuramotoODE, std::vector<float>> system_float(
+      N, 1, frequencies, 1.5);
+  system.SetPosition(phases);
+  system_float.SetPosition(phases_float);
+  system.Integrate(0.01, 500);
+  system_float.Integrate(0.01, 500);
+  // the time is kept in double precision
+  CHECK(system_float.GetTime() == system.GetTime());
+  std::vector<double> order = system.CalculateMeanFieldSpherical();
+  std::vector<float> order_float = system_float.CalculateMeanFieldSpherical();
+  REQUIRE(order_float.size() == 2);
+  CHECK(order_float[0] == Approx(order[0]).margin(1e-4));
+  CHECK(order_float[1] == Approx(order[1]).margin(1e-4));
+}
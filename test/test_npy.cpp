@@ -0,0 +1,38 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/npy.hpp"
+
+TEST_CASE("write npy file") {
+  std::string filename = "test_npy.npy";
+  std::vector<double> data({1., 2., 3., 4., 5., 6.});
+  sam::WriteNpy(filename, data, {2, 3});
+  std::ifstream file(filename, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  REQUIRE(content.size() == 128 + 6*sizeof(double));
+  CHECK(content.substr(0, 8) == std::string("\x93NUMPY\x01\x00", 8));
+  const size_t header_size = static_cast<unsigned char>(content[8])
+      + 256*static_cast<unsigned char>(content[9]);
+  CHECK(header_size == 118);
+  std::string header = content.substr(10, header_size);
+  CHECK(header.find("'shape': (2, 3)") != std::string::npos);
+  CHECK(header.find("'fortran_order': False") != std::string::npos);
+  CHECK(header.back() == '\n');
+  double last;
+  std::copy(content.end() - sizeof(double), content.end(),
+            reinterpret_cast<char*>(&last));
+  CHECK(last == 6.);
+  std::remove(filename.c_str());
+
+  CHECK_THROWS_AS(sam::WriteNpy(filename, data, {4, 2}), std::length_error);
+  CHECK_THROWS_AS(sam::WriteNpy("/nonexistent/file.npy", data, {6}),
+                  std::runtime_error);
+}
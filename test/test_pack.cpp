@@ -0,0 +1,66 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/pack.hpp"
+
+TEST_CASE("arithmetic is done lane by lane") {
+  sam::Pack<double, 4> a, b;
+  for (unsigned int i = 0; i < 4; ++i) {
+    a[i] = 1. + i;
+    b[i] = 2.*i - 1.;
+  }
+  sam::Pack<double, 4> sum = a + b;
+  sam::Pack<double, 4> difference = a - b;
+  sam::Pack<double, 4> product = a*b;
+  sam::Pack<double, 4> quotient = a/b;
+  sam::Pack<double, 4> negative = -a;
+  for (unsigned int i = 0; i < 4; ++i) {
+    CHECK(sum[i] == Approx(a[i] + b[i]));
+    CHECK(difference[i] == Approx(a[i] - b[i]));
+    CHECK(product[i] == Approx(a[i]*b[i]));
+    CHECK(quotient[i] == Approx(a[i]/b[i]));
+    CHECK(negative[i] == Approx(-a[i]));
+  }
+}
+
+TEST_CASE("scalars are broadcast") {
+  sam::Pack<double, 2> a;
+  a[0] = 1.;
+  a[1] = 2.;
+  sam::Pack<double, 2> scaled = 2.*a + 1.;
+  CHECK(scaled[0] == Approx(3.));
+  CHECK(scaled[1] == Approx(5.));
+  sam::Pack<double, 2> broadcast(3.);
+  CHECK(broadcast[0] == 3.);
+  CHECK(broadcast[1] == 3.);
+}
+
+TEST_CASE("math functions are applied to every lane") {
+  sam::Pack<double, 2> a;
+  a[0] = 0.5;
+  a[1] = 1.5;
+  sam::Pack<double, 2> s = sin(a);
+  sam::Pack<double, 2> c = cos(a);
+  sam::Pack<double, 2> r = sqrt(a);
+  for (unsigned int i = 0; i < 2; ++i) {
+    CHECK(s[i] == Approx(std::sin(a[i])));
+    CHECK(c[i] == Approx(std::cos(a[i])));
+    CHECK(r[i] == Approx(std::sqrt(a[i])));
+  }
+}
+
+TEST_CASE("packs are aligned") {
+  typedef sam::Pack<double, 4> pack_type;
+  CHECK(alignof(pack_type) == sam::PackAlignment<double, 4>());
+  CHECK(alignof(sam::Pack<double, 3>) == alignof(double));
+  std::vector<pack_type, sam::AlignedAllocator<pack_type>> packs(7, 1.);
+  for (const pack_type& pack : packs) {
+    CHECK(reinterpret_cast<std::uintptr_t>(&pack)%alignof(pack_type) == 0);
+    CHECK(pack[3] == 1.);
+  }
+  CHECK(sam::NativePack<double>::size()*sizeof(double) >= 8);
+}
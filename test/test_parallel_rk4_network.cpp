@@ -0,0 +1,144 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/system/parallel_rk4_network.hpp"
+#include "include/sam/system/rk4_network.hpp"
+
+// Harmonic oscillators with a global coupling of the positions
+// \ddot{x}_i = -omega_i^2 x_i + coupling*(X - x_i), where X is the mean
+// position and omega_i = 1 + 0.01*i.
+class MeanFieldOscillatorODE {
+ public:
+  double coupling_;
+
+  explicit MeanFieldOscillatorODE(double coupling): coupling_(coupling) {}
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t, size_t begin, size_t end) {
+    double mean = 0.;
+    for (size_t i = 0; i < x.size(); i += 2) {
+      mean += x[i];
+    }
+    mean /= static_cast<double>(x.size()/2);
+    for (size_t i = begin; i < end; i += 2) {
+      double omega = 1. + 0.01*static_cast<double>(i/2);
+      dx[i] = x[i+1];
+      dx[i+1] = -omega*omega*x[i] + coupling_*(mean - x[i]);
+    }
+  }
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t) {
+    operator()(x, dx, t, 0, x.size());
+  }
+};
+
+TEST_CASE("partitions of the parallel network") {
+  unsigned int n_threads = GENERATE(1, 2, 5);
+  std::vector<unsigned int> node_sizes({3, 0, 50, 1});
+  unsigned int dimension = 2;
+  sam::ParallelRK4Network<MeanFieldOscillatorODE> network(
+      node_sizes, dimension, n_threads, 0.1);
+  REQUIRE(network.GetNumberThreads() == n_threads);
+
+  SECTION("partitions are aligned to nodes and oscillators") {
+    std::vector<size_t> partitions = network.GetPartitionIndices();
+    std::vector<unsigned int> nodes = network.GetNodeIndices();
+    REQUIRE(partitions.front() == 0);
+    REQUIRE(partitions.back() == nodes.back());
+    for (size_t p = 0; p + 1 < partitions.size(); ++p) {
+      CHECK(partitions[p] < partitions[p+1]);
+      CHECK(partitions[p] % dimension == 0);
+    }
+    for (size_t k = 0; k < nodes.size(); ++k) {
+      bool found = false;
+      for (size_t p = 0; p < partitions.size(); ++p) {
+        found = found || partitions[p] == nodes[k];
+      }
+      CHECK(found);
+    }
+  }
+
+  SECTION("partitions follow a resize") {
+    network.Resize({2, 2});
+    std::vector<size_t> partitions = network.GetPartitionIndices();
+    REQUIRE(partitions.back() == 8);
+  }
+}
+
+TEST_CASE("parallel network integrates like the sequential one") {
+  unsigned int n_threads = GENERATE(1, 2, 3, 8);
+  std::vector<unsigned int> node_sizes({7, 13, 20});
+  unsigned int dimension = 2;
+  double coupling = 0.3;
+  double dt = 0.01;
+  unsigned int n = 200;
+  sam::ParallelRK4Network<MeanFieldOscillatorODE> parallel(
+      node_sizes, dimension, n_threads, coupling);
+  sam::RK4Network<MeanFieldOscillatorODE> sequential(node_sizes, dimension,
+                                                    coupling);
+  std::vector<double> initial(80);
+  for (size_t i = 0; i < initial.size(); ++i) {
+    initial[i] = std::sin(static_cast<double>(i));
+  }
+  parallel.SetPosition(initial);
+  sequential.SetPosition(initial);
+
+  SECTION("evaluate the derivative at another position") {
+    std::vector<double> x(initial.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+      x[i] = std::cos(static_cast<double>(i));
+    }
+    std::vector<double> expected(x.size()), dx(x.size(), 1.);
+    sequential.EvaluateDerivative(x, expected, 0.);
+    parallel.EvaluateDerivative(x, dx, 0.);
+    for (size_t i = 0; i < x.size(); ++i) {
+      CHECK(dx[i] == Approx(expected[i]).margin(1e-12));
+    }
+  }
+
+  SECTION("derivative") {
+    std::vector<double> expected = sequential.GetDerivative();
+    std::vector<double> derivative = parallel.GetDerivative();
+    REQUIRE(derivative.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      CHECK(derivative[i] == Approx(expected[i]).margin(1e-12));
+    }
+  }
+
+  SECTION("integrate") {
+    parallel.Integrate(dt, n);
+    sequential.Integrate(dt, n);
+    CHECK(parallel.GetTime() == Approx(sequential.GetTime()));
+    std::vector<double> expected = sequential.GetPosition();
+    std::vector<double> position = parallel.GetPosition();
+    for (size_t i = 0; i < expected.size(); ++i) {
+      CHECK(position[i] == Approx(expected[i]).margin(1e-10));
+    }
+  }
+
+  SECTION("integrate with observer") {
+    std::vector<std::vector<double>> positions;
+    std::vector<double> times;
+    parallel.Integrate(dt, 10,
+        sam::PositionObserver<std::vector<double>>(positions, times));
+    REQUIRE(positions.size() == 11);
+    CHECK(times.back() == Approx(10*dt));
+    CHECK(positions.back() == parallel.GetPosition());
+  }
+
+  SECTION("copy") {
+    sam::ParallelRK4Network<MeanFieldOscillatorODE> copy(parallel);
+    REQUIRE(copy.GetNumberThreads() == n_threads);
+    copy.Integrate(dt, n);
+    sequential.Integrate(dt, n);
+    CHECK(copy.GetPosition()[0]
+          == Approx(sequential.GetPosition()[0]).margin(1e-10));
+    CHECK(parallel.GetTime() == 0.);
+  }
+}
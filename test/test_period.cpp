@@ -1,5 +1,7 @@
 // Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
 
+#include <cmath>
+#include <stdexcept>
 #include <vector>
 
 #include "test/catch.hpp"
@@ -7,6 +9,56 @@
 #include "include/sam/analysis/period.hpp"
 #include "include/sam/system/rk4_system.hpp"
 
+namespace {
+
+// Two harmonic oscillators with the frequencies 1 and omega and the sum of
+// their positions z = sin(t) + sin(omega t) as fifth coordinate, if the
+// oscillators start at (0, 1) and (0, omega). For omega = 2 z crosses 0.2
+// twice per period with different intervals, for an irrational omega the
+// motion is quasi-periodic.
+class TorusODE {
+ public:
+  explicit TorusODE(double omega): omega_(omega) {}
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t) {
+    dx[0] = x[1];
+    dx[1] = -x[0];
+    dx[2] = x[3];
+    dx[3] = -omega_*omega_*x[2];
+    dx[4] = x[1] + x[3];
+  }
+
+ private:
+  double omega_;
+};
+
+// Stuart-Landau oscillator with shear, in polar coordinates
+// dr/dt = kappa r (1 - r^2) and dtheta/dt = 1 + alpha kappa (1 - r^2). The
+// return times relax to 2 pi by exp(-2 kappa 2 pi) per period.
+class ShearStuartLandauODE {
+ public:
+  ShearStuartLandauODE(double alpha, double kappa)
+      : alpha_(alpha), kappa_(kappa) {}
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t) {
+    double relaxation = kappa_*(1. - x[0]*x[0] - x[1]*x[1]);
+    dx[0] = relaxation*(x[0] - alpha_*x[1]) - x[1];
+    dx[1] = relaxation*(x[1] + alpha_*x[0]) + x[0];
+  }
+
+ private:
+  double alpha_;
+  double kappa_;
+};
+
+bool Rising(const std::vector<double>& x) {
+  return x[1] + x[3] > 0;
+}
+
+}  // namespace
+
 TEST_CASE("single harmonic oscillator") {
   // omega = 1 -> T = 2*pi
   sam::PeriodParameters params;
@@ -48,3 +100,115 @@ TEST_CASE("two uncoupled harmonic oscillators") {
     REQUIRE(T == Approx(M_PI).margin(1e-5));
   }
 }
+
+TEST_CASE("period does not converge") {
+  sam::PeriodParameters params;
+  params.dimension = 4;
+  params.target = 0.2;
+  params.period_max_iter = 10;
+  sam::RK4System<TorusODE> system(1, 5, std::sqrt(2.));
+  system.SetPosition({0., 1., 0., std::sqrt(2.), 0.});
+  CHECK(sam::CalculatePeriod(system, 0.01, Rising, params) == -1);
+}
+
+TEST_CASE("fit the period to crossing times") {
+  std::vector<double> times;
+  for (unsigned int k = 0; k < 10; ++k) {
+    times.push_back(1. + 2.*k);
+    times.push_back(1.5 + 2.*k);
+  }
+
+  SECTION("one crossing per period") {
+    sam::PeriodFit fit = sam::FitPeriod(times.data(), times.size(), 1);
+    CHECK(fit.period == Approx(1.).margin(0.01));
+    CHECK(fit.uncertainty > 0.01);
+  }
+
+  SECTION("two crossings per period") {
+    sam::PeriodFit fit = sam::FitPeriod(times.data(), times.size(), 2);
+    CHECK(fit.period == Approx(2.));
+    CHECK(fit.uncertainty == Approx(0.).margin(1e-12));
+    CHECK(fit.drift == Approx(0.).margin(1e-12));
+  }
+
+  SECTION("drift") {
+    // the period grows by 0.1 per period
+    std::vector<double> drifting({0.});
+    for (unsigned int k = 1; k < 20; ++k) {
+      drifting.push_back(drifting.back() + 1. + 0.1*k);
+    }
+    sam::PeriodFit fit = sam::FitPeriod(drifting.data(), drifting.size(), 1);
+    CHECK(fit.drift == Approx(0.1));
+  }
+}
+
+TEST_CASE("estimate the period") {
+  sam::PeriodEstimateParameters params;
+  const double dt = 0.01;
+
+  SECTION("harmonic oscillator") {
+    sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+    system.SetPosition({1., 0.});
+    sam::PeriodEstimate estimate = sam::EstimatePeriod(
+        system, dt, [](const std::vector<double>& x) { return x[1] > 0; },
+        params);
+    CHECK(estimate.type == sam::PeriodType::kPeriodic);
+    CHECK(estimate.multiplicity == 1);
+    CHECK(estimate.period == Approx(2.*M_PI).margin(1e-8));
+    CHECK(estimate.uncertainty < params.tolerance);
+    CHECK(estimate.drift == Approx(0.).margin(1e-8));
+    // on the limit cycle the shortest fit is enough
+    CHECK(estimate.crossing_times.size() == 3*params.max_multiplicity);
+  }
+
+  SECTION("slowly relaxing") {
+    // the return times relax by 0.9 per period, so the error drops by more
+    // than an order of magnitude between the windows, but not below the
+    // tolerance
+    params.max_crossings = 60;
+    sam::RK4System<ShearStuartLandauODE> system(1, 2, 1., 0.008);
+    system.SetPosition({1.5, 0.});
+    sam::PeriodEstimate estimate = sam::EstimatePeriod(
+        system, dt, [](const std::vector<double>& x) { return x[0] > 0; },
+        params);
+    CHECK(estimate.type == sam::PeriodType::kNotConverged);
+    CHECK(estimate.period == -1.);
+    CHECK(estimate.crossing_times.size() == 60);
+    CHECK(estimate.uncertainty > params.tolerance);
+  }
+
+  params.dimension = 4;
+  params.target = 0.2;
+
+  SECTION("two crossings per period") {
+    sam::RK4System<TorusODE> system(1, 5, 2.);
+    system.SetPosition({0., 1., 0., 2., 0.});
+    sam::PeriodEstimate estimate = sam::EstimatePeriod(system, dt, Rising,
+                                                       params);
+    CHECK(estimate.type == sam::PeriodType::kPeriodic);
+    CHECK(estimate.multiplicity == 2);
+    CHECK(estimate.period == Approx(2.*M_PI).margin(1e-8));
+    const std::vector<double>& times = estimate.crossing_times;
+    CHECK(std::fabs(times[2] - 2*times[1] + times[0]) > 0.1);
+  }
+
+  SECTION("quasi-periodic") {
+    params.max_crossings = 200;
+    sam::RK4System<TorusODE> system(1, 5, std::sqrt(2.));
+    system.SetPosition({0., 1., 0., std::sqrt(2.), 0.});
+    sam::PeriodEstimate estimate = sam::EstimatePeriod(system, dt, Rising,
+                                                       params);
+    CHECK(estimate.type == sam::PeriodType::kQuasiPeriodic);
+    CHECK(estimate.period > 0.);
+    CHECK(estimate.crossing_times.size() == 200);
+    CHECK(estimate.uncertainty > params.tolerance);
+  }
+
+  SECTION("invalid parameters") {
+    sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+    params.window = 10;
+    auto always = [](const std::vector<double>& x) { return true; };
+    CHECK_THROWS_AS(sam::EstimatePeriod(system, dt, always, params),
+                    std::invalid_argument);
+  }
+}
@@ -152,3 +152,48 @@ TEST_CASE("phase for perturbed Stuart-Landau oscillator") {
     }
   }
 }
+
+TEST_CASE("phases of many perturbed states in parallel") {
+  sam::PhaseParameters phase_params;
+  const double omega = 0.9;
+  const double alpha = 0.1;
+  const double T = 2*M_PI/omega;
+  sam::RK4System<StuartLandauODE> system(1, 2, alpha, omega);
+  std::vector<state_type> positions;
+  for (unsigned int i = 0; i < 13; ++i) {
+    double radius = 0.6 + 0.05*i;
+    double angle = 0.5*i;
+    positions.push_back({radius*std::cos(angle), radius*std::sin(angle)});
+  }
+
+  SECTION("same as sequential in input order") {
+    sam::ThreadPool pool(4);
+    std::vector<double> phases = sam::FindPhases(positions, T, system,
+                                                 CrossingCondition,
+                                                 phase_params, pool);
+    REQUIRE(phases.size() == positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+      double phase = sam::FindPhase(positions[i], T, system,
+                                    CrossingCondition, phase_params);
+      CHECK(phases[i] == phase);
+      CHECK(phases[i] == Approx(AnalyticPhase(positions[i], alpha))
+                         .margin(0.001));
+    }
+  }
+
+  SECTION("with a new pool and fewer positions than threads") {
+    std::vector<state_type> few(positions.begin(), positions.begin() + 2);
+    std::vector<double> phases = sam::FindPhases(few, T, system,
+                                                 CrossingCondition,
+                                                 phase_params, 8);
+    REQUIRE(phases.size() == 2);
+    CHECK(phases[1] == Approx(AnalyticPhase(few[1], alpha)).margin(0.001));
+  }
+
+  SECTION("no positions") {
+    std::vector<double> phases = sam::FindPhases(std::vector<state_type>(), T,
+                                                 system, CrossingCondition,
+                                                 phase_params, 2);
+    CHECK(phases.empty());
+  }
+}
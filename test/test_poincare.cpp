@@ -0,0 +1,107 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/analysis/henon.hpp"
+#include "include/sam/analysis/poincare.hpp"
+#include "include/sam/observer/poincare_observer.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+typedef sam::RK4System<HarmonicOscillatorODE> system_type;
+typedef std::vector<double> state_type;
+
+TEST_CASE("Poincare section of a harmonic oscillator") {
+  // x = sin(t) crosses 0 at k pi
+  system_type system(1, 2, 1.);
+  system.SetPosition({0., 1.});
+  const double dt = 0.01;
+  sam::CrossingParameters params;
+
+  SECTION("all crossings in one integration") {
+    sam::PoincareSection<system_type> section(system, params,
+                                              sam::EventDirection::kBoth, 2);
+    system.Integrate(dt, 1000, sam::PoincareObserver<system_type>(section));
+    // more crossings than the preallocated capacity
+    REQUIRE(section.size() == 3);
+    system_type restarted(1, 2, 1.);
+    restarted.SetPosition({0., 1.});
+    restarted.Integrate(dt, 1);
+    for (size_t k = 0; k < 3; ++k) {
+      CHECK(section.GetTime(k) == Approx((k + 1)*M_PI).margin(1e-9));
+      CHECK(section.GetState(k)[0] == Approx(0.).margin(1e-12));
+      std::pair<double, state_type> crossing = sam::IntegrateToCrossing(
+          restarted, dt, params);
+      CHECK(section.GetTime(k) == Approx(crossing.first).margin(1e-12));
+      CHECK(section.GetState(k)[1] == Approx(crossing.second[1])
+                                      .margin(1e-12));
+    }
+  }
+
+  SECTION("one direction") {
+    sam::PoincareSection<system_type> section(system, params,
+                                              sam::EventDirection::kRising);
+    system.Integrate(dt, 1000, sam::PoincareObserver<system_type>(section));
+    REQUIRE(section.size() == 1);
+    CHECK(section.GetTime(0) == Approx(2.*M_PI).margin(1e-9));
+    CHECK(section.GetState(0)[1] == Approx(1.).margin(1e-9));
+  }
+
+  SECTION("clear") {
+    sam::PoincareSection<system_type> section(system, params);
+    system.Integrate(dt, 400, sam::PoincareObserver<system_type>(section));
+    REQUIRE(section.size() == 1);
+    section.Clear();
+    CHECK(section.size() == 0);
+    CHECK_THROWS_AS(section.GetTime(0), std::out_of_range);
+    CHECK_THROWS_AS(section.GetState(0), std::out_of_range);
+    // the jump back to the start is not a crossing
+    system.SetPosition({0.5, 1.});
+    system.SetTime(0.);
+    system.Integrate(dt, 100, sam::PoincareObserver<system_type>(section));
+    CHECK(section.size() == 0);
+  }
+
+  SECTION("write to a file") {
+    const std::string filename = "test_poincare.bin";
+    auto writer = std::make_shared<sam::BinaryTrajectoryWriter>(
+        filename, std::vector<unsigned int>({1}), 2, dt, 4, 2);
+    sam::PoincareSection<system_type> section(system, params, writer);
+    system.Integrate(dt, 1000, sam::PoincareObserver<system_type>(section));
+    writer->Close();
+    CHECK(section.size() == 0);
+    CHECK_THROWS_AS(section.GetState(0), std::out_of_range);
+
+    sam::BinaryTrajectoryReader reader(filename);
+    REQUIRE(reader.GetNumberRecords() == 3);
+    for (size_t k = 0; k < 3; ++k) {
+      CHECK(reader.GetTime(k) == Approx((k + 1)*M_PI).margin(1e-9));
+      CHECK(reader.GetState(k)[0] == Approx(0.).margin(1e-12));
+    }
+    std::remove(filename.c_str());
+  }
+
+  SECTION("switch from the buffers to a file") {
+    const std::string filename = "test_poincare_switch.bin";
+    sam::PoincareSection<system_type> section(system, params);
+    system.Integrate(dt, 400, sam::PoincareObserver<system_type>(section));
+    REQUIRE(section.size() == 1);
+    auto writer = std::make_shared<sam::BinaryTrajectoryWriter>(
+        filename, std::vector<unsigned int>({1}), 2, dt, 4, 2);
+    section.SetWriter(writer);
+    CHECK(section.size() == 0);
+    CHECK_THROWS_AS(section.GetTime(0), std::out_of_range);
+    system.Integrate(dt, 600, sam::PoincareObserver<system_type>(section));
+    writer->Close();
+    sam::BinaryTrajectoryReader reader(filename);
+    REQUIRE(reader.GetNumberRecords() == 2);
+    CHECK(reader.GetTime(0) == Approx(2.*M_PI).margin(1e-9));
+    std::remove(filename.c_str());
+  }
+}
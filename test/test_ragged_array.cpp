@@ -0,0 +1,67 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/eigen_state.hpp"
+#include "include/sam/helper/ragged_array.hpp"
+
+TEST_CASE("ragged array with offsets") {
+  sam::RaggedArray<std::vector<double>> ragged({0, 2, 2, 5});
+  REQUIRE(ragged.size() == 3);
+  CHECK(ragged.RowSize(0) == 2);
+  CHECK(ragged.RowSize(1) == 0);
+  CHECK(ragged.RowSize(2) == 3);
+  REQUIRE(ragged.Flat().size() == 5);
+  for (double value : ragged.Flat()) CHECK(value == 0.);
+
+  ragged.Row(2)[1] = 4.;
+  CHECK(ragged[2][1] == 4.);
+  CHECK(ragged.Flat()[3] == 4.);
+
+  sam::RaggedView<double> view = ragged.View();
+  REQUIRE(view.size() == 3);
+  CHECK(view.RowSize(2) == 3);
+  CHECK(view[2][1] == 4.);
+
+  std::vector<std::vector<double>> nested = sam::ToNested(ragged);
+  REQUIRE(nested.size() == 3);
+  CHECK(nested[1].empty());
+  REQUIRE(nested[2].size() == 3);
+  CHECK(nested[2][1] == 4.);
+}
+
+TEST_CASE("reshaping to the same size keeps the buffer") {
+  sam::RaggedArray<std::vector<double>> ragged;
+  CHECK(ragged.size() == 0);
+  ragged.Reshape(3, 2);
+  REQUIRE(ragged.size() == 3);
+  CHECK(ragged.RowSize(1) == 2);
+  const double* data = ragged.Flat().data();
+  ragged.Reshape({0, 1, 6});
+  CHECK(ragged.size() == 2);
+  CHECK(ragged.RowSize(1) == 5);
+  CHECK(ragged.Flat().data() == data);
+}
+
+TEST_CASE("ragged array of an Eigen vector") {
+  sam::RaggedArray<Eigen::VectorXd> ragged({0, 1, 3});
+  ragged.Row(1)[1] = 2.;
+  REQUIRE(ragged.Flat().size() == 3);
+  CHECK(ragged.Flat()(2) == 2.);
+  std::vector<Eigen::VectorXd> nested = sam::ToNested(ragged);
+  REQUIRE(nested[1].size() == 2);
+  CHECK(nested[1](1) == 2.);
+}
+
+TEST_CASE("view of rows with an offset") {
+  std::vector<double> data = {1., 2., 3., 4.};
+  std::vector<unsigned int> offsets = {1, 2, 4};
+  sam::RaggedView<double> view(data.data(), offsets.data(), 2);
+  REQUIRE(view.size() == 2);
+  CHECK(view[0].size() == 1);
+  CHECK(view[0][0] == 2.);
+  CHECK(view[1][1] == 4.);
+}
@@ -0,0 +1,46 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/ring_buffer.hpp"
+
+TEST_CASE("ring buffer keeps the latest states") {
+  sam::RingBuffer<std::vector<double>> buffer(3, std::vector<double>(2));
+  CHECK(buffer.capacity() == 3);
+  CHECK(buffer.size() == 0);
+  CHECK_FALSE(buffer.full());
+
+  buffer.Push({1., 2.}, 0.1);
+  buffer.Push({3., 4.}, 0.2);
+  REQUIRE(buffer.size() == 2);
+  CHECK(buffer.GetState(0) == std::vector<double>({1., 2.}));
+  CHECK(buffer.GetTime(1) == 0.2);
+
+  const double* oldest = buffer.GetState(0).data();
+  buffer.Push({5., 6.}, 0.3);
+  buffer.Push({7., 8.}, 0.4);
+  CHECK(buffer.full());
+  REQUIRE(buffer.size() == 3);
+  CHECK(buffer.GetState(0) == std::vector<double>({3., 4.}));
+  CHECK(buffer.GetState(2) == std::vector<double>({7., 8.}));
+  CHECK(buffer.GetTime(0) == 0.2);
+  CHECK(buffer.GetTime(2) == 0.4);
+  // the oldest slot was reused
+  CHECK(buffer.GetState(2).data() == oldest);
+  CHECK_THROWS_AS(buffer.GetState(3), std::out_of_range);
+
+  buffer.Clear();
+  CHECK(buffer.size() == 0);
+  buffer.Next(1.)[0] = 9.;
+  CHECK(buffer.GetState(0)[0] == 9.);
+  CHECK(buffer.GetTime(0) == 1.);
+}
+
+TEST_CASE("ring buffer checks sizes") {
+  CHECK_THROWS_AS(sam::RingBuffer<std::vector<double>>(0, {1.}),
+                  std::invalid_argument);
+  sam::RingBuffer<std::vector<double>> buffer(2, {1.});
+  CHECK_THROWS_AS(buffer.Push({1., 2.}, 0.), std::length_error);
+}
@@ -0,0 +1,37 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/observer/ring_buffer_observer.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+TEST_CASE("ring buffer observer keeps the last positions") {
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  sam::RingBuffer<std::vector<double>> buffer(10, system.GetPosition());
+  system.Integrate(0.01, 1000,
+                   sam::RingBufferObserver<std::vector<double>>(buffer));
+  REQUIRE(buffer.size() == 10);
+  CHECK(buffer.GetTime(9) == Approx(10.));
+  CHECK(buffer.GetTime(0) == Approx(9.91));
+  CHECK(buffer.GetState(9)[0] == Approx(std::cos(10.)).margin(1e-6));
+  CHECK(buffer.GetState(0)[0] == Approx(std::cos(9.91)).margin(1e-6));
+}
+
+TEST_CASE("ring buffer observer for the derivative") {
+  typedef sam::RK4System<HarmonicOscillatorODE> system_type;
+  system_type system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  sam::RingBuffer<std::vector<double>> buffer(5, system.GetPosition());
+  system.Integrate(0.01, 100,
+                   sam::DerivativeRingBufferObserver<system_type,
+                                                     std::vector<double>>(
+                       system, buffer));
+  REQUIRE(buffer.size() == 5);
+  // the derivative of the position at the last step
+  CHECK(buffer.GetState(4)[0] == Approx(-std::sin(1.)).margin(1e-6));
+  CHECK(buffer.GetState(4)[1] == Approx(-std::cos(1.)).margin(1e-6));
+}
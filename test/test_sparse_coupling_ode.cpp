@@ -0,0 +1,147 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/helper/edge_list.hpp"
+#include "include/sam/system/parallel_rk4_network.hpp"
+#include "include/sam/system/rk4_network.hpp"
+#include "include/sam/system/sparse_coupling_ode.hpp"
+
+// Harmonic oscillators on a ring with diffusive coupling in all coordinates,
+// written with a dense loop as reference.
+class RingOscillatorODE {
+ public:
+  double omega_;
+  double coupling_;
+
+  RingOscillatorODE(double omega, double coupling)
+      : omega_(omega), coupling_(coupling) {}
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t) {
+    size_t N = x.size()/2;
+    for (size_t i = 0; i < N; ++i) {
+      size_t left = (i + N - 1) % N;
+      size_t right = (i + 1) % N;
+      for (size_t k = 0; k < 2; ++k) {
+        double coupling = coupling_*(x[2*left + k] + x[2*right + k]
+                                     - 2.*x[2*i + k]);
+        dx[2*i + k] = (k == 0 ? x[2*i + 1] : -omega_*omega_*x[2*i])
+                      + coupling;
+      }
+    }
+  }
+};
+
+// Uncoupled harmonic oscillators that can be evaluated for a range.
+class RangeHarmonicOscillatorODE {
+ public:
+  double omega_;
+
+  explicit RangeHarmonicOscillatorODE(double omega): omega_(omega) {}
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i += 2) {
+      dx[i] = x[i+1];
+      dx[i+1] = -omega_*omega_*x[i];
+    }
+  }
+
+  void operator()(const std::vector<double>& x, std::vector<double>& dx,
+                  double t) {
+    operator()(x, dx, t, 0, x.size());
+  }
+};
+
+sam::AdjacencyMatrix RingAdjacency(size_t N) {
+  std::vector<sam::Edge> edges;
+  for (size_t i = 0; i < N; ++i) {
+    edges.push_back(sam::Edge(i, (i + 1) % N, 1.));
+  }
+  return sam::BuildAdjacencyMatrix(N, edges, true);
+}
+
+std::vector<double> InitialCondition(size_t size) {
+  std::vector<double> x(size);
+  for (size_t i = 0; i < size; ++i) {
+    x[i] = std::cos(0.7*static_cast<double>(i));
+  }
+  return x;
+}
+
+TEST_CASE("sparse coupling of harmonic oscillators") {
+  size_t N = 10;
+  double omega = 1.5;
+  double coupling = 0.2;
+  sam::AdjacencyMatrix adjacency = RingAdjacency(N);
+  std::vector<double> x = InitialCondition(2*N);
+
+  SECTION("derivative") {
+    sam::SparseCouplingODE<HarmonicOscillatorODE> ode(adjacency, coupling,
+                                                      omega);
+    RingOscillatorODE reference(omega, coupling);
+    std::vector<double> dx(2*N), expected(2*N);
+    ode(x, dx, 0.);
+    reference(x, expected, 0.);
+    for (size_t i = 0; i < dx.size(); ++i) {
+      CHECK(dx[i] == Approx(expected[i]).margin(1e-12));
+    }
+  }
+
+  SECTION("coupling can be changed") {
+    sam::SparseCouplingODE<HarmonicOscillatorODE> ode(adjacency, coupling,
+                                                      omega);
+    ode.SetCoupling(0.);
+    CHECK(ode.GetCoupling() == 0.);
+    std::vector<double> dx(2*N);
+    ode(x, dx, 0.);
+    CHECK(dx[0] == Approx(x[1]));
+    CHECK(dx[1] == Approx(-omega*omega*x[0]));
+  }
+
+  SECTION("state of wrong size") {
+    sam::SparseCouplingODE<HarmonicOscillatorODE> ode(adjacency, coupling,
+                                                      omega);
+    std::vector<double> y(2*N + 1), dy(2*N + 1);
+    CHECK_THROWS_AS(ode(y, dy, 0.), std::length_error);
+  }
+
+  SECTION("integrate in network") {
+    sam::RK4Network<sam::SparseCouplingODE<HarmonicOscillatorODE>> network(
+        {static_cast<unsigned int>(N)}, 2, adjacency, coupling, omega);
+    sam::RK4Network<RingOscillatorODE> reference(
+        {static_cast<unsigned int>(N)}, 2, omega, coupling);
+    network.SetPosition(x);
+    reference.SetPosition(x);
+    network.Integrate(0.01, 100);
+    reference.Integrate(0.01, 100);
+    std::vector<double> position = network.GetPosition();
+    std::vector<double> expected = reference.GetPosition();
+    for (size_t i = 0; i < position.size(); ++i) {
+      CHECK(position[i] == Approx(expected[i]).margin(1e-10));
+    }
+  }
+
+  SECTION("integrate in parallel network") {
+    sam::ParallelRK4Network<
+        sam::SparseCouplingODE<RangeHarmonicOscillatorODE>> network(
+            {static_cast<unsigned int>(N)}, 2, 3, adjacency, coupling, omega);
+    sam::RK4Network<RingOscillatorODE> reference(
+        {static_cast<unsigned int>(N)}, 2, omega, coupling);
+    network.SetPosition(x);
+    reference.SetPosition(x);
+    network.Integrate(0.01, 100);
+    reference.Integrate(0.01, 100);
+    std::vector<double> position = network.GetPosition();
+    std::vector<double> expected = reference.GetPosition();
+    for (size_t i = 0; i < position.size(); ++i) {
+      CHECK(position[i] == Approx(expected[i]).margin(1e-10));
+    }
+  }
+}
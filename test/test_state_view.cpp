@@ -0,0 +1,75 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/analysis/henon.hpp"
+#include "include/sam/helper/state_view.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+// count the allocations to check that the loops do not allocate
+static size_t number_allocations = 0;
+
+void* operator new(size_t size) {
+  ++number_allocations;
+  void* pointer = std::malloc(size);
+  if (!pointer) throw std::bad_alloc();
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+TEST_CASE("view of a vector") {
+  std::vector<double> x = {1., 2., 3.};
+  sam::StateView<double> view = sam::MakeStateView(x);
+  REQUIRE(view.size() == 3);
+  CHECK_FALSE(view.empty());
+  CHECK(view.data() == x.data());
+  CHECK(view[1] == 2.);
+  double sum = 0.;
+  for (double value : view) sum += value;
+  CHECK(sum == 6.);
+  x[1] = 5.;
+  CHECK(view[1] == 5.);
+}
+
+TEST_CASE("integration and derivative do not allocate") {
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  std::vector<double> derivative(2);
+  // the stepper allocates its buffers in the first step
+  system.Integrate(0.01, 1);
+  size_t allocations = number_allocations;
+  auto view = system.GetPositionView();
+  double sum = 0.;
+  for (unsigned int i = 0; i < 100; ++i) {
+    system.Integrate(0.01, 1);
+    system.GetDerivative(derivative);
+    sum += view[0] + derivative[0];
+  }
+  CHECK(number_allocations == allocations);
+  CHECK(view[0] == Approx(std::cos(1.01)).margin(1e-6));
+  CHECK(sum != 0.);
+}
+
+TEST_CASE("crossing loop only allocates for the Henon trick") {
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  system.Integrate(0.01, 1);
+  sam::CrossingParameters params;
+  params.dimension = 1;
+  // the allocations of one crossing do not depend on the number of steps
+  size_t allocations = number_allocations;
+  sam::IntegrateToCrossing(system, 0.001, params);
+  size_t short_crossing = number_allocations - allocations;
+  allocations = number_allocations;
+  sam::IntegrateToCrossing(system, 0.0001, params);
+  size_t long_crossing = number_allocations - allocations;
+  CHECK(long_crossing == short_crossing);
+}
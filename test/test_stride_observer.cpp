@@ -0,0 +1,45 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/observer/stride_observer.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+TEST_CASE("stride observer passes every k-th observation") {
+  std::vector<std::vector<double>> x;
+  std::vector<double> t;
+  auto observer = sam::MakeStrideObserver(
+      sam::PositionObserver<std::vector<double>>(x, t), 3);
+  for (unsigned int i = 0; i < 10; ++i) {
+    observer(std::vector<double>({1.*i}), 0.1*i);
+  }
+  REQUIRE(t.size() == 4);
+  CHECK(x[1][0] == 3.);
+  CHECK(t[3] == Approx(0.9));
+}
+
+TEST_CASE("stride observer continues over several integrations") {
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  std::vector<std::vector<double>> x;
+  std::vector<double> t;
+  auto observer = sam::MakeStrideObserver(
+      sam::PositionObserver<std::vector<double>>(x, t), 5);
+  // every integration calls the observer for the start and the step
+  for (unsigned int i = 0; i < 10; ++i) {
+    system.Integrate(0.1, 1, observer);
+  }
+  CHECK(t.size() == 4);
+}
+
+TEST_CASE("stride observer needs a positive stride") {
+  std::vector<std::vector<double>> x;
+  std::vector<double> t;
+  CHECK_THROWS_AS(sam::MakeStrideObserver(
+      sam::PositionObserver<std::vector<double>>(x, t), 0),
+      std::invalid_argument);
+}
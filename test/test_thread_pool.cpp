@@ -0,0 +1,40 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "include/sam/helper/thread_pool.hpp"
+
+TEST_CASE("thread pool runs all tasks") {
+  unsigned int n_threads = GENERATE(1, 2, 4);
+  sam::ThreadPool pool(n_threads);
+  REQUIRE(pool.GetNumberThreads() == n_threads);
+
+  SECTION("every task is called exactly once") {
+    std::vector<int> calls(1000, 0);
+    pool.ParallelFor(calls.size(), [&](size_t i) { calls[i] += 1; });
+    for (size_t i = 0; i < calls.size(); ++i) {
+      CHECK(calls[i] == 1);
+    }
+  }
+
+  SECTION("pool can be reused") {
+    std::atomic<int> sum(0);
+    for (int repeat = 0; repeat < 100; ++repeat) {
+      pool.ParallelFor(10, [&](size_t i) { sum += static_cast<int>(i); });
+    }
+    CHECK(sum == 100*45);
+  }
+
+  SECTION("exceptions are passed to the caller") {
+    CHECK_THROWS_AS(pool.ParallelFor(100, [](size_t i) {
+      if (i == 50) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    // the pool is still usable after an exception
+    std::atomic<int> count(0);
+    pool.ParallelFor(10, [&](size_t i) { ++count; });
+    CHECK(count == 10);
+  }
+}
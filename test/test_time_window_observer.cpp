@@ -0,0 +1,32 @@
+// Copyright 2020 Erik Teichmann <kontakt.teichmann@gmail.com>
+
+#include <vector>
+
+#include "test/catch.hpp"
+#include "test/harmonic_oscillator_ode.hpp"
+#include "include/sam/observer/position_observer.hpp"
+#include "include/sam/observer/time_window_observer.hpp"
+#include "include/sam/system/rk4_system.hpp"
+
+TEST_CASE("time window observer passes observations in the window") {
+  sam::RK4System<HarmonicOscillatorODE> system(1, 2, 1.);
+  system.SetPosition({1., 0.});
+  std::vector<std::vector<double>> x;
+  std::vector<double> t;
+  system.Integrate(0.01, 1000, sam::MakeTimeWindowObserver(
+      sam::PositionObserver<std::vector<double>>(x, t), 2.005, 3.005));
+  REQUIRE(t.size() == 100);
+  CHECK(t.front() == Approx(2.01));
+  CHECK(t.back() == Approx(3.));
+}
+
+TEST_CASE("time window observer is open to the end by default") {
+  std::vector<std::vector<double>> x;
+  std::vector<double> t;
+  auto observer = sam::MakeTimeWindowObserver(
+      sam::PositionObserver<std::vector<double>>(x, t), 1.);
+  observer(std::vector<double>({1.}), 0.5);
+  observer(std::vector<double>({1.}), 1.);
+  observer(std::vector<double>({1.}), 1e10);
+  CHECK(t == std::vector<double>({1., 1e10}));
+}